@@ -362,7 +362,9 @@ def main():
     """主函数"""
     parser = argparse.ArgumentParser(description='PillarScatter特征图可视化工具')
     parser.add_argument('--output', default='./output/OpTest_scatter_output_x.bin',
-                       help='算子输出文件 (NHWC格式)')
+                       help='算子输出文件')
+    parser.add_argument('--output-layout', default='NHWC', choices=['NHWC', 'NCHW'],
+                       help='算子输出布局 (--layout nchw/transpose 时为NCHW)')
     parser.add_argument('--reference', default='./output/OpTest_scatter_output_x_correct.bin',
                        help='参考输出文件 (NCHW格式)')
     parser.add_argument('--coords', default='./input/OpTest_scatter_input_coords.bin',
@@ -395,8 +397,9 @@ def main():
     
     try:
         # 加载特征图
-        print(f"\n加载算子输出 (NHWC): {args.output}")
-        features_output = visualizer.load_feature_map(args.output, 'NHWC')
+        print(f"\n加载算子输出 ({args.output_layout}): {args.output}")
+        features_output = visualizer.load_feature_map(args.output, args.output_layout)
+        output_title = f"算子输出 ({args.output_layout})"
         
         print(f"加载参考输出 (NCHW): {args.reference}")
         features_reference = visualizer.load_feature_map(args.reference, 'NCHW')
@@ -407,7 +410,7 @@ def main():
             # 交互式模式
             visualizer.interactive_channel_explorer(
                 features_output, features_reference,
-                "算子输出 (NHWC)", "参考输出 (NCHW)"
+                output_title, "参考输出 (NCHW)"
             )
         else:
             # 单次比较模式
@@ -415,7 +418,7 @@ def main():
                 save_path = os.path.join(args.save_dir, f'channel_{args.channel}_comparison.png')
                 visualizer.plot_feature_comparison(
                     features_output, features_reference,
-                    "算子输出 (NHWC)", "参考输出 (NCHW)",
+                    output_title, "参考输出 (NCHW)",
                     method='single', channel_idx=args.channel,
                     save_path=save_path
                 )
@@ -423,7 +426,7 @@ def main():
                 save_path = os.path.join(args.save_dir, f'{args.method}_comparison.png')
                 visualizer.plot_feature_comparison(
                     features_output, features_reference,
-                    "算子输出 (NHWC)", "参考输出 (NCHW)",
+                    output_title, "参考输出 (NCHW)",
                     method=args.method,
                     save_path=save_path
                 )
@@ -6,4 +6,7 @@ find_package(tikicpulib REQUIRED)
 add_library(ascendc_kernels_${RUN_MODE} SHARED ${KERNEL_FILES})
 target_link_libraries(ascendc_kernels_${RUN_MODE} PUBLIC tikicpulib::${SOC_VERSION})
 target_compile_options(ascendc_kernels_${RUN_MODE} PRIVATE -g -O0 -std=c++17)
+if(PILLAR_SCATTER_PROFILE)
+    target_compile_definitions(ascendc_kernels_${RUN_MODE} PRIVATE PILLAR_SCATTER_PROFILE)
+endif()
 install(TARGETS ascendc_kernels_${RUN_MODE} DESTINATION ${CMAKE_INSTALL_LIBDIR})
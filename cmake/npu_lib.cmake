@@ -8,3 +8,6 @@ endif()
 include(${ASCENDC_CMAKE_DIR}/ascendc.cmake)
 
 ascendc_library(ascendc_kernels_${RUN_MODE} SHARED ${KERNEL_FILES})
+if(PILLAR_SCATTER_PROFILE)
+    ascendc_compile_definitions(ascendc_kernels_${RUN_MODE} PRIVATE PILLAR_SCATTER_PROFILE)
+endif()
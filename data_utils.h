@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "acl/acl.h"
+#include "pillar_scatter_io.h"
 
 typedef enum {
     DT_UNDEFINED = -1,
@@ -73,29 +74,20 @@ bool ReadFile(const std::string &filePath, size_t &fileSize, void *buffer, size_
         return false;
     }
 
-    std::ifstream file;
-    file.open(filePath, std::ios::binary);
-    if (!file.is_open()) {
-        ERROR_LOG("Open file failed. path = %s", filePath.c_str());
-        return false;
-    }
-
-    std::filebuf *buf = file.rdbuf();
-    size_t size = buf->pubseekoff(0, std::ios::end, std::ios::in);
+    size_t size = static_cast<size_t>(sBuf.st_size);
     if (size == 0) {
         ERROR_LOG("file size is 0");
-        file.close();
         return false;
     }
     if (size > bufferSize) {
         ERROR_LOG("file size is larger than buffer size");
-        file.close();
         return false;
     }
-    buf->pubseekpos(0, std::ios::in);
-    buf->sgetn(static_cast<char *>(buffer), size);
+    // 分块pread直接读入调用方缓冲区
+    if (!ReadFileRange(filePath, buffer, size)) {
+        return false;
+    }
     fileSize = size;
-    file.close();
     return true;
 }
 
@@ -119,7 +111,7 @@ bool WriteFile(const std::string &filePath, const void *buffer, size_t size)
         return false;
     }
 
-    size_t writeSize = write(fd, buffer, size);
+    size_t writeSize = TransferFully<true>(fd, static_cast<uint8_t *>(const_cast<void *>(buffer)), size, 0);
     (void)close(fd);
     if (writeSize != size) {
         ERROR_LOG("Write file Failed.");
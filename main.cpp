@@ -8,21 +8,26 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
  */
 #include "data_utils.h"
+#include "pillar_scatter_profile.h"
+#include "pillar_scatter_runner.h"
+#include "pillar_scatter_stats.h"
 #include <sys/stat.h>
+#include <dirent.h>
 #include <algorithm>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <cstdio>
 #include <chrono>
 #include <ctime>
-#ifndef ASCENDC_CPU_DEBUG
-#include "acl/acl.h"
-#include "aclrtlaunch_pillar_scatter_custom.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef ASCENDC_CPU_DEBUG
+constexpr const char *RUN_MODE_NAME = "CPU";
 #else
-#include "tikicpulib.h"
-extern "C" __global__ __aicore__ void pillar_scatter_custom(GM_ADDR pillar_features, 
-                                                            GM_ADDR coords, 
-                                                            GM_ADDR params, 
-                                                            GM_ADDR spatial_features);
+constexpr const char *RUN_MODE_NAME = "NPU";
 #endif
 
 // 获取文件大小的辅助函数
@@ -34,292 +39,1005 @@ size_t getFileSize(const char* filename) {
     return 0;
 }
 
-int32_t main(int32_t argc, char *argv[])
+// 单帧输入：特征文件、坐标文件及从文件大小推算出的pillar数
+// PFN融合输入时特征文件为逐点特征 [P, maxPoints, C]，另附每个pillar的有效点数文件 [P] uint32
+struct FrameInput {
+    std::string featuresFile;
+    std::string coordsFile;
+    uint32_t numPillars;
+    std::string countsFile;
+};
+
+/**
+ * @brief 根据文件大小推算每帧的pillar数量
+ * 
+ * featureSize为每个pillar的特征元素数，PFN融合输入时为 maxPoints*C；
+ * 指定了有效点数文件时pillar数同时受其长度限制。
+ * @return 所有帧的pillar数均有效时返回true
+ */
+bool ProbeFrames(std::vector<FrameInput> &frames, uint32_t featureSize, size_t elemSize)
 {
-    // 设置并行块数，与算子实现保持一致
-    uint32_t blockDim = 8;
-    
-    // PillarScatter参数配置
-    constexpr int32_t PILLAR_FEATURE_SIZE = 64;
-    constexpr int32_t FEATURE_X = 1024;
-    constexpr int32_t FEATURE_Y = 1024;
-    
-    // 根据输入文件大小自动计算pillar数量
-    const char* pillarFeaturesFile = "./input/OpTest_scatter_input_x.bin";
-    const char* coordsFile = "./input/OpTest_scatter_input_coords.bin";
-    
-    size_t pillarFeaturesFileSize = getFileSize(pillarFeaturesFile);
-    size_t coordsFileSize = getFileSize(coordsFile);
-    
-    if (pillarFeaturesFileSize == 0 || coordsFileSize == 0) {
-        printf("错误：无法读取输入文件大小\n");
-        return -1;
+    for (size_t b = 0; b < frames.size(); b++) {
+        size_t pillarFeaturesFileSize = getFileSize(frames[b].featuresFile.c_str());
+        size_t coordsFileSize = getFileSize(frames[b].coordsFile.c_str());
+        if (pillarFeaturesFileSize == 0 || coordsFileSize == 0) {
+            printf("错误：无法读取第%zu帧输入文件大小\n", b);
+            return false;
+        }
+        
+        // 计算pillar数量
+        // pillar_features: [num_pillars, C]，每个元素elemSize字节
+        uint32_t num_pillars_from_features = pillarFeaturesFileSize / (featureSize * elemSize);
+        // coords: [num_pillars, 4] int32, 每个元素4字节
+        uint32_t num_pillars_from_coords = coordsFileSize / (4 * sizeof(uint32_t));
+        
+        if (num_pillars_from_features != num_pillars_from_coords) {
+            printf("警告：第%zu帧从特征文件和坐标文件计算出的pillar数量不一致！\n", b);
+            printf("  特征文件推算：%u pillars\n", num_pillars_from_features);
+            printf("  坐标文件推算：%u pillars\n", num_pillars_from_coords);
+            printf("  使用较小值以避免越界\n");
+        }
+        frames[b].numPillars = std::min(num_pillars_from_features, num_pillars_from_coords);
+        if (!frames[b].countsFile.empty()) {
+            uint32_t num_pillars_from_counts = getFileSize(frames[b].countsFile.c_str()) / sizeof(uint32_t);
+            if (num_pillars_from_counts < frames[b].numPillars) {
+                printf("警告：第%zu帧有效点数文件只有 %u 个pillar，截断到该数量\n", b, num_pillars_from_counts);
+                frames[b].numPillars = num_pillars_from_counts;
+            }
+        }
     }
-    
-    // 计算pillar数量
-    // pillar_features: [num_pillars, 64] float16, 每个元素2字节
-    uint32_t num_pillars_from_features = pillarFeaturesFileSize / (PILLAR_FEATURE_SIZE * sizeof(uint16_t));
-    // coords: [num_pillars, 4] int32, 每个元素4字节
-    uint32_t num_pillars_from_coords = coordsFileSize / (4 * sizeof(uint32_t));
-    
-    if (num_pillars_from_features != num_pillars_from_coords) {
-        printf("警告：从特征文件和坐标文件计算出的pillar数量不一致！\n");
-        printf("  特征文件推算：%u pillars\n", num_pillars_from_features);
-        printf("  坐标文件推算：%u pillars\n", num_pillars_from_coords);
-        printf("  使用较小值以避免越界\n");
+    return true;
+}
+
+/**
+ * @brief 将多帧输入首尾拼接读入同一组缓冲区
+ * 
+ * 第b帧的coords[:, 0]统一改写为b，kernel据此写入输出的第b个batch。
+ * 各帧pillar在拼接后的列表中连续排列，按pillar下标分核即可跨帧均衡负载。
+ */
+bool LoadFrames(const std::vector<FrameInput> &frames, uint32_t featureSize, size_t elemSize,
+                uint8_t *pillarFeatures, uint8_t *coords)
+{
+    size_t pillarOffset = 0;
+    for (size_t b = 0; b < frames.size(); b++) {
+        size_t featureBytes = (size_t)frames[b].numPillars * featureSize * elemSize;
+        size_t coordsBytes = (size_t)frames[b].numPillars * 4 * sizeof(uint32_t);
+        uint8_t *featureDst = pillarFeatures + pillarOffset * featureSize * elemSize;
+        uint32_t *coordsDst = (uint32_t *)coords + pillarOffset * 4;
+        // 只读取numPillars行，直接写入拼接后的位置
+        if (!ReadFileRange(frames[b].featuresFile, featureDst, featureBytes) ||
+            !ReadFileRange(frames[b].coordsFile, coordsDst, coordsBytes)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < frames[b].numPillars; i++) {
+            coordsDst[i * 4] = (uint32_t)b;
+        }
+        pillarOffset += frames[b].numPillars;
     }
-    
-    uint32_t num_pillars = std::min(num_pillars_from_features, num_pillars_from_coords);
-    printf("检测到输入数据包含 %u 个pillars\n", num_pillars);
-    
-    // 计算输入输出数据大小
-    size_t pillarFeaturesSize = num_pillars * PILLAR_FEATURE_SIZE * sizeof(uint16_t);  // [N, 64] float16
-    size_t coordsSize = num_pillars * 4 * sizeof(uint32_t) + 8 * sizeof(uint32_t);                           // [N, 4] int32 +8防止越界
-    size_t paramsSize = 1 * sizeof(uint32_t);                                         // 存储pillar数量
-    size_t spatialFeaturesSize = 1 * FEATURE_Y * FEATURE_X * PILLAR_FEATURE_SIZE * sizeof(uint16_t); // [1, 720, 720, 64] float16 (NHWC)
+    return true;
+}
 
-#ifdef ASCENDC_CPU_DEBUG
-    // 在CPU调试模式下，分配主机内存用于输入输出
-    uint8_t *pillarFeatures = (uint8_t *)AscendC::GmAlloc(pillarFeaturesSize);
-    uint8_t *coords = (uint8_t *)AscendC::GmAlloc(coordsSize);
-    uint8_t *params = (uint8_t *)AscendC::GmAlloc(paramsSize);
-    uint8_t *spatialFeatures = (uint8_t *)AscendC::GmAlloc(spatialFeaturesSize);
-    
-    // 设置params参数（pillar数量）
-    *((uint32_t*)params) = num_pillars;
+/**
+ * @brief 将多帧的每pillar有效点数首尾拼接读入同一缓冲区（PFN融合输入）
+ */
+bool LoadPointCounts(const std::vector<FrameInput> &frames, uint8_t *pointCounts)
+{
+    size_t pillarOffset = 0;
+    for (size_t b = 0; b < frames.size(); b++) {
+        if (!ReadFileRange(frames[b].countsFile, (uint32_t *)pointCounts + pillarOffset,
+                           (size_t)frames[b].numPillars * sizeof(uint32_t))) {
+            return false;
+        }
+        pillarOffset += frames[b].numPillars;
+    }
+    return true;
+}
 
-    // 从文件读取输入数据到主机内存
-    ReadFile(pillarFeaturesFile, pillarFeaturesSize, pillarFeatures, pillarFeaturesSize);
-    ReadFile(coordsFile, coordsSize, coords, coordsSize);
-    
-    // 初始化输出内存为0
-    memset(spatialFeatures, 0, spatialFeaturesSize);
+// 一次launch的host侧输入，各次launch间复用（vector只增不减）
+struct LaunchInput {
+    std::vector<uint8_t> features;
+    std::vector<uint32_t> coords;
+    std::vector<uint32_t> pointCounts;
+    std::vector<uint32_t> packedCoords;  // --coord-format非byxr时交给Runner的紧凑坐标
+    uint32_t numPillars;
+};
 
-    // 设置内核模式为AIV_MODE，适配昇腾C算子
-    AscendC::SetKernelMode(KernelMode::AIV_MODE);
-    
-    // 开始计时
-    printf("\n========== 算子执行时间统计 ==========\n");
-    printf("开始执行PillarScatter算子 (CPU模式)...\n");
+/**
+ * @brief 读入一次launch的所有帧，rowSize为每个pillar的输入特征元素数
+ * @return 任一文件读取失败时返回false
+ */
+bool ReadLaunchInput(const std::vector<FrameInput> &frames, uint32_t rowSize, size_t elemSize, bool usePfn,
+                     LaunchInput &input)
+{
+    input.numPillars = 0;
+    for (const FrameInput &frame : frames) {
+        input.numPillars += frame.numPillars;
+    }
+    input.features.resize((size_t)input.numPillars * rowSize * elemSize);
+    input.coords.resize((size_t)input.numPillars * PILLAR_SCATTER_COORD_DIM);
+    if (!LoadFrames(frames, rowSize, elemSize, input.features.data(), (uint8_t *)input.coords.data())) {
+        return false;
+    }
+    if (usePfn) {
+        input.pointCounts.resize(input.numPillars);
+        return LoadPointCounts(frames, (uint8_t *)input.pointCounts.data());
+    }
+    return true;
+}
+
+/**
+ * @brief 返回交给Runner的坐标：按coordFormat把读入的 [N, 4] 坐标编码为紧凑格式，模拟直接输出紧凑坐标的体素化
+ *
+ * 输出统计仍使用input.coords。
+ */
+const uint32_t *RunnerCoords(const PillarScatterConfig &config, LaunchInput &input)
+{
+    if (config.options.coordFormat == SCATTER_COORD_BYXR) {
+        return input.coords.data();
+    }
+    input.packedCoords.resize(input.numPillars);
+    PackCoords(input.coords.data(), input.numPillars, config.options.coordFormat, config.nx, config.ny,
+               config.batchSize, input.packedCoords.data());
+    return input.packedCoords.data();
+}
+
+/**
+ * @brief 读取int8反量化的逐通道scale（[C] float16文件），未指定文件时scale全为1
+ * @return 文件大小与通道数不符时返回false
+ */
+bool LoadDequantScale(const std::string &scaleFile, uint32_t featureSize, std::vector<uint16_t> &scale)
+{
+    scale.assign(featureSize, 0x3C00);  // half(1.0)
+    if (scaleFile.empty()) {
+        return true;
+    }
+    size_t scaleBytes = featureSize * sizeof(uint16_t);
+    if (getFileSize(scaleFile.c_str()) != scaleBytes) {
+        printf("错误：scale文件 %s 应为 %u 个float16\n", scaleFile.c_str(), featureSize);
+        return false;
+    }
+    size_t fileSize = scaleBytes;
+    return ReadFile(scaleFile, fileSize, scale.data(), scaleBytes);
+}
+
+/**
+ * @brief 解析 --pool-strides 的逗号分隔步长列表（如 2,4），每个步长为2到2^PILLAR_SCATTER_MAX_POOL_SHIFT的2的幂
+ */
+bool ParsePoolStrides(const char *text, uint32_t &strideMask)
+{
+    strideMask = 0;
+    const char *cursor = text;
+    while (*cursor != '\0') {
+        char *end = nullptr;
+        uint32_t stride = static_cast<uint32_t>(strtoul(cursor, &end, 10));
+        uint32_t shift = 1;
+        while (shift <= PILLAR_SCATTER_MAX_POOL_SHIFT && (1u << shift) != stride) {
+            shift++;
+        }
+        if (end == cursor || shift > PILLAR_SCATTER_MAX_POOL_SHIFT || (*end != ',' && *end != '\0')) {
+            printf("错误：非法池化步长列表 %s（步长为2到%u的2的幂，逗号分隔）\n", text,
+                   1u << PILLAR_SCATTER_MAX_POOL_SHIFT);
+            return false;
+        }
+        strideMask |= 1u << shift;
+        cursor = (*end == ',') ? end + 1 : end;
+    }
+    return strideMask != 0;
+}
+
+/**
+ * @brief 按statsMode统计并打印一次launch的输出
+ *
+ * dense模式多线程扫描下载回host的输出；coords模式只根据本次launch的坐标和特征推出统计，不读取稠密输出。
+ */
+void ReportOutputStats(uint32_t statsMode, const PillarScatterConfig &config, const PillarScatterRunner &runner,
+                       const LaunchInput &input)
+{
+    if (statsMode == OUTPUT_STATS_OFF) {
+        return;
+    }
+    StatsShape shape = {config.nx, config.ny, config.featureSize, config.batchSize, config.options.inputDtype};
+    OutputStats stats;
     auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // 获取高精度时间戳
-    auto start_time_sys = std::chrono::system_clock::now();
-    auto start_time_t = std::chrono::system_clock::to_time_t(start_time_sys);
-    auto start_time_us = std::chrono::duration_cast<std::chrono::microseconds>(start_time_sys.time_since_epoch()) % 1000000;
-    
-    // 格式化输出时间戳（精确到微秒）
-    struct tm* start_tm = localtime(&start_time_t);
-    printf("开始时间: %04d-%02d-%02d %02d:%02d:%02d.%06ld\n",
-           start_tm->tm_year + 1900, start_tm->tm_mon + 1, start_tm->tm_mday,
-           start_tm->tm_hour, start_tm->tm_min, start_tm->tm_sec, start_time_us.count());
-    
-    // 在CPU上直接调用pillar_scatter_custom算子，blockDim为并行块数
-    ICPU_RUN_KF(pillar_scatter_custom, blockDim, pillarFeatures, coords, params, spatialFeatures);
-    
-    // 结束计时
+    if (statsMode == OUTPUT_STATS_COORDS) {
+        ComputeCoordStats(input.coords.data(), input.features.data(), input.numPillars, shape, config.dequantScale,
+                          stats);
+    } else {
+        ComputeOutputStats(runner.HostOutput(), shape, 0, stats);
+    }
     auto end_time = std::chrono::high_resolution_clock::now();
-    auto end_time_sys = std::chrono::system_clock::now();
-    auto end_time_t = std::chrono::system_clock::to_time_t(end_time_sys);
-    auto end_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end_time_sys.time_since_epoch()) % 1000000;
+    PrintOutputStats(stats, shape);
+    printf("  统计耗时: %.3f ms\n", std::chrono::duration<double, std::milli>(end_time - start_time).count());
+}
+
+// 输出的统计和写出方式
+struct OutputOptions {
+    uint32_t statsMode;    // OutputStatsMode
+    uint32_t fileFormat;   // OutputFileFormat
+    std::string frameDir;  // 非空时把每帧的输出单独写入该目录
+    std::string profileJson;  // 非空时把各次launch的剖析结果写入该JSON文件
+};
+
+/**
+ * @brief 按fileFormat写出最近一次launch中从第batchBegin个batch开始的batchNum个batch
+ *
+ * CSR模式没有稠密输出，总是由行偏移表、列下标和紧凑特征直接写成紧凑容器。
+ */
+bool WriteOutputBatches(const std::string &path, uint32_t fileFormat, const PillarScatterConfig &config,
+                        const PillarScatterRunner &runner, uint32_t batchBegin, uint32_t batchNum)
+{
+    CompactOutputHeader shape = {0, 0, batchNum, config.ny, config.nx, config.featureSize,
+                                 (uint32_t)OutputElemSize(config.options.inputDtype), 0};
+    if (config.options.scatterMode == SCATTER_MODE_CSR) {
+        return WriteCsrOutput(path, runner.CsrRowOffsets() + batchBegin * config.ny, runner.CsrColumns(),
+                              runner.CsrFeatures(), shape);
+    }
+    size_t batchBytes = (size_t)config.ny * config.nx * config.featureSize * shape.elemSize;
+    return WriteOutputFile(path, runner.HostOutput() + batchBegin * batchBytes, shape, fileFormat);
+}
+
+/**
+ * @brief multires模式：把各步长s的池化输出 [B, ny/s, nx/s, C] 写入 ./output/OpTest_scatter_output_x_s<s>.bin
+ */
+bool WritePooledOutputs(uint32_t fileFormat, const PillarScatterConfig &config, const PillarScatterRunner &runner)
+{
+    for (uint32_t k = 1; k <= PILLAR_SCATTER_MAX_POOL_SHIFT; k++) {
+        if (((config.options.poolStrideMask >> k) & 1) == 0) {
+            continue;
+        }
+        CompactOutputHeader shape = {0, 0, config.batchSize, config.ny >> k, config.nx >> k, config.featureSize,
+                                     (uint32_t)OutputElemSize(config.options.inputDtype), 0};
+        std::string path = "./output/OpTest_scatter_output_x_s" + std::to_string(1u << k) + ".bin";
+        if (!WriteOutputFile(path, runner.HostOutput() + runner.PoolOutputOffset(k), shape, fileFormat)) {
+            return false;
+        }
+        printf("步长%u的池化输出已写入 %s\n", 1u << k, path.c_str());
+    }
+    return true;
+}
+
+/**
+ * @brief 逐帧输出的文件名：<目录>/<特征文件名去掉_x.bin>_output.bin
+ */
+std::string FrameOutputPath(const std::string &dir, const FrameInput &frame)
+{
+    std::string name = frame.featuresFile.substr(frame.featuresFile.find_last_of('/') + 1);
+    const std::string suffixes[] = {"_x.bin", ".bin"};
+    for (const std::string &suffix : suffixes) {
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            name.resize(name.size() - suffix.size());
+            break;
+        }
+    }
+    return dir + "/" + name + "_output.bin";
+}
+
+/**
+ * @brief 指定了frameDir时，把一次launch中第b帧的输出（第b个batch）分别写出
+ */
+bool WriteFrameOutputs(const std::vector<FrameInput> &frames, const OutputOptions &outputOptions,
+                       const PillarScatterConfig &config, const PillarScatterRunner &runner)
+{
+    if (outputOptions.frameDir.empty()) {
+        return true;
+    }
+    for (size_t b = 0; b < frames.size(); b++) {
+        if (!WriteOutputBatches(FrameOutputPath(outputOptions.frameDir, frames[b]), outputOptions.fileFormat, config,
+                                runner, (uint32_t)b, 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 打印一次launch的起止时间、耗时和吞吐量
+ */
+void PrintTiming(const char *runMode, std::chrono::high_resolution_clock::time_point start_time,
+                 std::chrono::high_resolution_clock::time_point end_time, uint32_t num_pillars)
+{
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    
-    // 格式化输出结束时间戳（精确到微秒）
-    struct tm* end_tm = localtime(&end_time_t);
-    printf("结束时间: %04d-%02d-%02d %02d:%02d:%02d.%06ld\n",
-           end_tm->tm_year + 1900, end_tm->tm_mon + 1, end_tm->tm_mday,
-           end_tm->tm_hour, end_tm->tm_min, end_tm->tm_sec, end_time_us.count());
-    
-    // 显示精确的执行时间差（使用high_resolution_clock测量）
     printf("执行时间差: %ld μs (%.3f ms)\n", duration.count(), duration.count() / 1000.0);
     
-    printf("✓ 算子执行完成!\n");
+    printf("✓ 算子执行完成! (%s模式)\n", runMode);
     printf("执行时间: %.3f ms (%.6f 秒)\n", 
            duration.count() / 1000.0, duration.count() / 1000000.0);
     printf("处理pillar数量: %u\n", num_pillars);
     printf("平均每个pillar处理时间: %.3f μs\n", (double)duration.count() / num_pillars);
     printf("吞吐量: %.2f K pillars/秒\n", num_pillars / (duration.count() / 1000000.0) / 1000.0);
     printf("=====================================\n\n");
+}
 
-    // 验证输出数据
-    uint16_t* outputPtr = (uint16_t*)spatialFeatures;
-    size_t totalElements = 1 * FEATURE_Y * FEATURE_X * PILLAR_FEATURE_SIZE;
-    size_t nonZeroCount = 0;
-    uint16_t firstNonZeroHalf = 0;
-    size_t firstNonZeroIdx = 0;
-    
-    for (size_t i = 0; i < totalElements; i++) {
-        if (outputPtr[i] != 0) {
-            if (nonZeroCount == 0) {
-                firstNonZeroHalf = outputPtr[i];
-                firstNonZeroIdx = i;
-            }
-            nonZeroCount++;
-        }
+/**
+ * @brief 打印坐标校验结果：非法条目被跳过，不影响输出
+ */
+void PrintDiagnostics(const ScatterDiagnostics &diag)
+{
+    printf("坐标校验: 有效 %u，越界 %u，填充 %u%s\n", diag.validPillars, diag.outOfRange, diag.padding,
+           (diag.status & SCATTER_STATUS_OUT_OF_RANGE) ? "（越界条目已跳过，请检查输入）" : "");
+}
+
+/**
+ * @brief 写出剖析JSON；kernel未以PILLAR_SCATTER_PROFILE编译或入口不做剖析时没有剖析结果，只给出提示
+ */
+bool FinishProfile(const std::string &path, const std::vector<ProfileRecord> &records)
+{
+    if (path.empty()) {
+        return true;
     }
-    
-    printf("\n输出数据验证 (NHWC格式):\n");
-    printf("  总元素数: %zu\n", totalElements);
-    printf("  非零元素数: %zu (%.2f%%)\n", nonZeroCount, (float)nonZeroCount / totalElements * 100);
-    if (nonZeroCount > 0) {
-        printf("  第一个非零值: 0x%04X (位置: %zu)\n", firstNonZeroHalf, firstNonZeroIdx);
-        // 将位置转换为NHWC坐标
-        size_t h = firstNonZeroIdx / (FEATURE_X * PILLAR_FEATURE_SIZE);
-        size_t w = (firstNonZeroIdx % (FEATURE_X * PILLAR_FEATURE_SIZE)) / PILLAR_FEATURE_SIZE;
-        size_t c = firstNonZeroIdx % PILLAR_FEATURE_SIZE;
-        printf("  对应坐标: H=%zu, W=%zu, C=%zu\n", h, w, c);
-    } else {
-        printf("  警告：输出全是0！\n");
+    if (records.empty()) {
+        printf("提示：没有剖析结果（kernel需以 run.sh --profile 编译，PFN融合入口不做剖析），未写出 %s\n",
+               path.c_str());
+        return true;
     }
+    if (!WriteProfileJson(path, records)) {
+        return false;
+    }
+    printf("剖析结果已写入 %s（%zu 次launch）\n", path.c_str(), records.size());
+    return true;
+}
 
-    // 将输出结果写入文件
-    WriteFile("./output/OpTest_scatter_output_x.bin", spatialFeatures, spatialFeaturesSize);
-
-    // 释放主机内存
-    AscendC::GmFree((void *)pillarFeatures);
-    AscendC::GmFree((void *)coords);
-    AscendC::GmFree((void *)params);
-    AscendC::GmFree((void *)spatialFeatures);
-#else
-    // 初始化ACL环境
-    CHECK_ACL(aclInit(nullptr));
-    int32_t deviceId = 0;
-    // 设置当前设备
-    CHECK_ACL(aclrtSetDevice(deviceId));
-    aclrtStream stream = nullptr;
-    // 创建ACL流，用于异步任务
-    CHECK_ACL(aclrtCreateStream(&stream));
-
-    // 分别为主机和设备分配输入输出内存
-    uint8_t *pillarFeaturesHost, *coordsHost, *paramsHost, *spatialFeaturesHost;
-    uint8_t *pillarFeaturesDevice, *coordsDevice, *paramsDevice, *spatialFeaturesDevice;
-
-    // 分配主机内存
-    CHECK_ACL(aclrtMallocHost((void **)(&pillarFeaturesHost), pillarFeaturesSize));
-    CHECK_ACL(aclrtMallocHost((void **)(&coordsHost), coordsSize));
-    CHECK_ACL(aclrtMallocHost((void **)(&paramsHost), paramsSize));
-    CHECK_ACL(aclrtMallocHost((void **)(&spatialFeaturesHost), spatialFeaturesSize));
-    
-    // 分配设备内存
-    CHECK_ACL(aclrtMalloc((void **)&pillarFeaturesDevice, pillarFeaturesSize, ACL_MEM_MALLOC_HUGE_FIRST));
-    CHECK_ACL(aclrtMalloc((void **)&coordsDevice, coordsSize, ACL_MEM_MALLOC_HUGE_FIRST));
-    CHECK_ACL(aclrtMalloc((void **)&paramsDevice, paramsSize, ACL_MEM_MALLOC_HUGE_FIRST));
-    CHECK_ACL(aclrtMalloc((void **)&spatialFeaturesDevice, spatialFeaturesSize, ACL_MEM_MALLOC_HUGE_FIRST));
-    
-    // 设置params参数（pillar数量）
-    *((uint32_t*)paramsHost) = num_pillars;
+/**
+ * @brief 反向：读入[B, ny, nx, C]输出梯度，对最近一次launch的坐标执行PillarGather并写出pillar梯度
+ *
+ * 反向复用输出缓冲区上传梯度，需在前向输出写出之后调用。
+ */
+bool RunBackwardPass(const std::string &gradFile, const PillarScatterConfig &config, PillarScatterRunner &runner,
+                     LaunchInput &input)
+{
+    size_t gradBytes = runner.OutputSize();
+    if (!runner.BackwardSupported()) {
+        return false;
+    }
+    if (getFileSize(gradFile.c_str()) != gradBytes) {
+        printf("错误：输出梯度文件 %s 应为 %zu 字节（与前向输出相同）\n", gradFile.c_str(), gradBytes);
+        return false;
+    }
+    std::vector<uint8_t> grad(gradBytes);
+    size_t fileSize = gradBytes;
+    if (!ReadFile(gradFile, fileSize, grad.data(), gradBytes)) {
+        return false;
+    }
+    printf("\n========== 反向执行时间统计 ==========\n");
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (!runner.RunBackward(grad.data(), RunnerCoords(config, input), input.numPillars)) {
+        return false;
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    PrintTiming(RUN_MODE_NAME, start_time, end_time, runner.LastPillars());
+    PrintDiagnostics(runner.LastDiagnostics());
+    if (!runner.LastProfile().empty()) {
+        PrintProfileReport({0, runner.LastKernelMs(), runner.LastProfile()});
+    }
+    size_t pillarGradBytes = (size_t)input.numPillars * config.featureSize * OutputElemSize(config.options.inputDtype);
+    return WriteFile("./output/OpTest_gather_output_x.bin", runner.HostFeatureGrad(), pillarGradBytes);
+}
 
-    // 从文件读取输入数据到主机内存
-    ReadFile(pillarFeaturesFile, pillarFeaturesSize, pillarFeaturesHost, pillarFeaturesSize);
-    ReadFile(coordsFile, coordsSize, coordsHost, coordsSize);
-    
-    // 初始化输出内存为0
-    memset(spatialFeaturesHost, 0, spatialFeaturesSize);
+/**
+ * @brief 打印当前系统时间（精确到微秒）
+ */
+void PrintTimestamp(const char *label)
+{
+    auto time_sys = std::chrono::system_clock::now();
+    auto time_t_sys = std::chrono::system_clock::to_time_t(time_sys);
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(time_sys.time_since_epoch()) % 1000000;
+    struct tm* time_tm = localtime(&time_t_sys);
+    printf("%s: %04d-%02d-%02d %02d:%02d:%02d.%06ld\n", label,
+           time_tm->tm_year + 1900, time_tm->tm_mon + 1, time_tm->tm_mday,
+           time_tm->tm_hour, time_tm->tm_min, time_tm->tm_sec, time_us.count());
+}
 
-    // 将主机内存数据拷贝到设备内存
-    CHECK_ACL(aclrtMemcpy(pillarFeaturesDevice, pillarFeaturesSize, pillarFeaturesHost, pillarFeaturesSize, ACL_MEMCPY_HOST_TO_DEVICE));
-    CHECK_ACL(aclrtMemcpy(coordsDevice, coordsSize, coordsHost, coordsSize, ACL_MEMCPY_HOST_TO_DEVICE));
-    CHECK_ACL(aclrtMemcpy(paramsDevice, paramsSize, paramsHost, paramsSize, ACL_MEMCPY_HOST_TO_DEVICE));
-    CHECK_ACL(aclrtMemcpy(spatialFeaturesDevice, spatialFeaturesSize, spatialFeaturesHost, spatialFeaturesSize, ACL_MEMCPY_HOST_TO_DEVICE));
+/**
+ * @brief 收集目录中的帧文件：每个 <名称>_x.bin 与同名的 <名称>_coords.bin 组成一帧，按文件名排序
+ * @return 目录不可读或没有成对的帧文件时返回false
+ */
+bool CollectFrameDir(const std::string &frameDir, std::vector<FrameInput> &frames)
+{
+    DIR *dir = opendir(frameDir.c_str());
+    if (dir == nullptr) {
+        printf("错误：无法打开帧目录 %s\n", frameDir.c_str());
+        return false;
+    }
+    const std::string featureSuffix = "_x.bin";
+    std::vector<std::string> prefixes;
+    for (struct dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > featureSuffix.size() &&
+            name.compare(name.size() - featureSuffix.size(), featureSuffix.size(), featureSuffix) == 0) {
+            prefixes.push_back(frameDir + "/" + name.substr(0, name.size() - featureSuffix.size()));
+        }
+    }
+    closedir(dir);
+    std::sort(prefixes.begin(), prefixes.end());
+    size_t found = 0;
+    for (const std::string &prefix : prefixes) {
+        if (getFileSize((prefix + "_coords.bin").c_str()) == 0) {
+            printf("警告：%s_x.bin 缺少对应的坐标文件，已跳过\n", prefix.c_str());
+            continue;
+        }
+        frames.push_back({prefix + "_x.bin", prefix + "_coords.bin", 0});
+        found++;
+    }
+    if (found == 0) {
+        printf("错误：帧目录 %s 中没有成对的 *_x.bin / *_coords.bin 文件\n", frameDir.c_str());
+        return false;
+    }
+    return true;
+}
 
-    // 开始计时
-    printf("\n========== 算子执行时间统计 ==========\n");
-    printf("开始执行PillarScatter算子 (NPU模式)...\n");
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // 获取高精度时间戳
-    auto start_time_sys = std::chrono::system_clock::now();
-    auto start_time_t = std::chrono::system_clock::to_time_t(start_time_sys);
-    auto start_time_us = std::chrono::duration_cast<std::chrono::microseconds>(start_time_sys.time_since_epoch()) % 1000000;
-    
-    // 格式化输出时间戳（精确到微秒）
-    struct tm* start_tm = localtime(&start_time_t);
-    printf("开始时间: %04d-%02d-%02d %02d:%02d:%02d.%06ld\n",
-           start_tm->tm_year + 1900, start_tm->tm_mon + 1, start_tm->tm_mday,
-           start_tm->tm_hour, start_tm->tm_min, start_tm->tm_sec, start_time_us.count());
+/**
+ * @brief 打印流水线的持续帧率
+ * 
+ * @param busyMs 各帧从开始上传到输出下载完成的时间之和；CPU模式下各帧串行执行，与总时间相同
+ */
+void PrintPipelineStats(const char *runMode, size_t frameNum, uint32_t streamNum, uint64_t totalPillars,
+                        double wallMs, double busyMs, const ScatterDiagnostics &diag)
+{
+    printf("\n========== 帧流水线统计 (%s模式) ==========\n", runMode);
+    printf("帧数: %zu，流数: %u\n", frameNum, streamNum);
+    printf("总时间: %.3f ms\n", wallMs);
+    printf("持续帧率: %.2f FPS\n", frameNum / (wallMs / 1000.0));
+    printf("平均每帧: %.3f ms（上传+计算+下载 %.3f ms）\n", wallMs / frameNum, busyMs / frameNum);
+    printf("重叠倍数: %.2f\n", busyMs / wallMs);
+    printf("吞吐量: %.2f K pillars/秒\n", totalPillars / (wallMs / 1000.0) / 1000.0);
+    PrintDiagnostics(diag);
+    printf("=====================================\n\n");
+}
 
-    // 启动自定义算子内核，blockDim为并行块数，stream为ACL流
-    ACLRT_LAUNCH_KERNEL(pillar_scatter_custom)(blockDim, stream, pillarFeaturesDevice, coordsDevice, paramsDevice, spatialFeaturesDevice);
+/**
+ * @brief 连续帧流水线：每帧单独launch（batch为1），输出为各帧独立的BEV特征图
+ * 
+ * 使用streamNum个PillarScatterRunner轮转，每个Runner拥有独立的流、锁页内存和设备缓冲区。
+ * 第k帧提交到第k%streamNum个Runner，在其流上依次异步执行 H2D拷贝 -> 清零输出 -> kernel -> D2H拷贝，
+ * host只在复用某个Runner之前等待其上一帧完成，随后在host侧读入、排序下一帧，
+ * 因此第k+1帧的上传、第k帧的scatter和第k-1帧的下载可以同时进行（streamNum >= 3时三者完全重叠）。
+ * CPU模式下Submit同步执行，各帧串行，仅用于校验流水线逻辑。
+ * 
+ * @param config batch为1、容量为最大单帧pillar数的Runner配置
+ * @param outputOptions 逐帧输出在Wait之后、Runner被复用之前写出；只对最后一帧统计，input循环结束后恰为最后一帧
+ * @return 成功返回0
+ */
+int32_t RunFramePipeline(const std::vector<FrameInput> &frames, const PillarScatterConfig &config,
+                         uint32_t streamNum, const OutputOptions &outputOptions)
+{
+    std::vector<std::unique_ptr<PillarScatterRunner>> runners;
+    for (uint32_t s = 0; s < streamNum; s++) {
+        runners.emplace_back(new PillarScatterRunner(config));
+        if (!runners.back()->Init()) {
+            return -1;
+        }
+    }
     
-    // 等待流中所有任务完成，确保计算结束
-    CHECK_ACL(aclrtSynchronizeStream(stream));
+    LaunchInput input;
+    uint32_t inputRowSize = config.featureSize * std::max<uint32_t>(1, config.options.maxPoints);
+    size_t inElemSize = InputElemSize(config.options.inputDtype);
+    std::vector<bool> busy(streamNum, false);
+    std::vector<size_t> frameOf(streamNum, 0);
+    uint64_t totalPillars = 0;
+    double busyMs = 0;
+    ScatterDiagnostics totalDiag = {};
+    std::vector<ProfileRecord> profiles;
+    // 等待某个Runner上的帧完成，累计其耗时
+    auto finish = [&](uint32_t s) {
+        if (!busy[s]) {
+            return true;
+        }
+        busy[s] = false;
+        if (!runners[s]->Wait()) {
+            return false;
+        }
+        busyMs += runners[s]->LastLaunchMs();
+        totalPillars += runners[s]->LastPillars();
+        const ScatterDiagnostics &diag = runners[s]->LastDiagnostics();
+        totalDiag.status |= diag.status;
+        totalDiag.validPillars += diag.validPillars;
+        totalDiag.outOfRange += diag.outOfRange;
+        totalDiag.padding += diag.padding;
+        if (!runners[s]->LastProfile().empty()) {
+            profiles.push_back({(uint32_t)frameOf[s], runners[s]->LastKernelMs(), runners[s]->LastProfile()});
+        }
+        return WriteFrameOutputs({frames[frameOf[s]]}, outputOptions, config, *runners[s]);
+    };
     
-    // 结束计时
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (size_t k = 0; k < frames.size(); k++) {
+        uint32_t s = (uint32_t)(k % streamNum);
+        if (!finish(s)) {
+            return -1;
+        }
+        // host侧读入本帧，与其他流上仍在执行的帧重叠
+        if (!ReadLaunchInput({frames[k]}, inputRowSize, inElemSize, config.options.maxPoints > 0, input)) {
+            return -1;
+        }
+        if (!runners[s]->Submit(input.features.data(), RunnerCoords(config, input), input.numPillars,
+                                input.pointCounts.empty() ? nullptr : input.pointCounts.data())) {
+            return -1;
+        }
+        busy[s] = true;
+        frameOf[s] = k;
+    }
+    for (uint32_t s = 0; s < streamNum; s++) {
+        if (!finish(s)) {
+            return -1;
+        }
+    }
     auto end_time = std::chrono::high_resolution_clock::now();
-    auto end_time_sys = std::chrono::system_clock::now();
-    auto end_time_t = std::chrono::system_clock::to_time_t(end_time_sys);
-    auto end_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end_time_sys.time_since_epoch()) % 1000000;
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    
-    // 格式化输出结束时间戳（精确到微秒）
-    struct tm* end_tm = localtime(&end_time_t);
-    printf("结束时间: %04d-%02d-%02d %02d:%02d:%02d.%06ld\n",
-           end_tm->tm_year + 1900, end_tm->tm_mon + 1, end_tm->tm_mday,
-           end_tm->tm_hour, end_tm->tm_min, end_tm->tm_sec, end_time_us.count());
-    
-    // 显示精确的执行时间差（使用high_resolution_clock测量）
-    printf("执行时间差: %ld μs (%.3f ms)\n", duration.count(), duration.count() / 1000.0);
-    
-    printf("✓ 算子执行完成!\n");
-    printf("执行时间: %.3f ms (%.6f 秒)\n", 
-           duration.count() / 1000.0, duration.count() / 1000000.0);
-    printf("处理pillar数量: %u\n", num_pillars);
-    printf("平均每个pillar处理时间: %.3f μs\n", (double)duration.count() / num_pillars);
-    printf("吞吐量: %.2f K pillars/秒\n", num_pillars / (duration.count() / 1000000.0) / 1000.0);
-    printf("=====================================\n\n");
+    double wallMs = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    PrintPipelineStats(RUN_MODE_NAME, frames.size(), streamNum, totalPillars, wallMs, busyMs, totalDiag);
+    if (!profiles.empty()) {
+        PrintProfileReport(profiles.back());
+    }
+    if (!FinishProfile(outputOptions.profileJson, profiles)) {
+        return -1;
+    }
 
-    // 将设备内存的输出数据拷贝回主机内存
-    CHECK_ACL(aclrtMemcpy(spatialFeaturesHost, spatialFeaturesSize, spatialFeaturesDevice, spatialFeaturesSize, ACL_MEMCPY_DEVICE_TO_HOST));
+    // 输出文件为最后一帧的结果
+    const PillarScatterRunner &last = *runners[(frames.size() - 1) % streamNum];
+    ReportOutputStats(outputOptions.statsMode, config, last, input);
+    if (!WriteOutputBatches("./output/OpTest_scatter_output_x.bin", outputOptions.fileFormat, config, last, 0, 1)) {
+        return -1;
+    }
+    return 0;
+}
 
-    // 验证输出数据
-    uint16_t* outputPtr = (uint16_t*)spatialFeaturesHost;
-    size_t totalElements = 1 * FEATURE_Y * FEATURE_X * PILLAR_FEATURE_SIZE;
-    size_t nonZeroCount = 0;
-    uint16_t firstNonZeroHalf = 0;
-    size_t firstNonZeroIdx = 0;
-    
-    for (size_t i = 0; i < totalElements; i++) {
-        if (outputPtr[i] != 0) {
-            if (nonZeroCount == 0) {
-                firstNonZeroHalf = outputPtr[i];
-                firstNonZeroIdx = i;
+int32_t main(int32_t argc, char *argv[])
+{
+    // 默认配置：1024x1024网格，64通道，8核并行
+    // 可通过 --nx/--ny/--c/--block-dim 覆盖，适配不同模型而无需重新编译
+    // 可重复指定 --frame <特征文件> <坐标文件>，多帧拼接后一次launch输出[B, ny, nx, C]
+    // --mode band 使用输出驻留模式，kernel自行清零输出，省去host侧清零和拷贝
+    // --mode incremental 把各--frame当作连续帧逐帧launch，输出跨帧复用，只清零上一帧写过的cell
+    // --mode sorted 由host按cell排序pillar，kernel把cell连续的pillar合并为一次DataCopy
+    // --mode csr 为稀疏骨干网络输出去重、按行排序的cell：CSR行偏移表、列下标和紧凑特征，写出为紧凑容器
+    // --mode multires 一次launch同时写出全分辨率输出和 --pool-strides 各步长的池化输出（--pool max|mean）
+    // --reduce sum|max|mean 对重复坐标做确定性归约（在band或csr模式下完成）
+    // --schedule dynamic 各核运行时领取pillar块；--schedule region 按整行输出区域分核（需sorted模式）
+    // --channel-split auto|off|G pillar/sorted模式static调度下把通道也切给不同的核：按pillar数和C自动选择 / 关闭 / 指定G份
+    // --coord-format byxr|linear|yx16 交给算子的坐标格式：[N,4]原样 / 线性cell下标 / 打包int16 (y,x)，由输入坐标编码得到
+    // --dtype bf16|fp32|int8 指定特征类型，int8输入按 --scale 给出的逐通道scale反量化为half输出
+    // --pfn-frame <逐点特征文件> <有效点数文件> <坐标文件> 配合 --max-points N 使用PFN最大池化融合入口
+    // --streams K 把各帧（--frame 或 --frame-dir 目录中的帧）作为连续帧流，用K个流重叠上传、计算和下载并统计帧率
+    // --stats dense|coords|off 输出统计方式：多线程扫描稠密输出 / 只由坐标和特征推出 / 不统计
+    // --out-format dense|sparse|compact 输出文件格式：完整写出 / 跳过全零4KB页的稀疏文件 / 只含非零cell的紧凑容器
+    // --output-dir DIR 另外把每帧的输出写入 DIR/<帧名>_output.bin，用于批量回放
+    // --layout nchw 输出[B, C, ny, nx]，由band模式在UB内转置后写出；--layout transpose 为scatter后单独转置的对比基线
+    // --profile-json FILE 把各核分阶段耗时写入FILE（kernel需以PILLAR_SCATTER_PROFILE编译，否则只打印提示）
+    // --backward GRAD 前向之后读入与输出同形状的梯度，执行PillarGather反向并写出[P, C]的pillar梯度
+    uint32_t blockDim = 8;
+    ScatterOptions options = {SCATTER_MODE_PILLAR, SCATTER_REDUCE_OVERWRITE, SCATTER_SCHEDULE_STATIC,
+                              SCATTER_DTYPE_FP16, 0, SCATTER_LAYOUT_NHWC, SCATTER_REDUCE_MAX, (1u << 1) | (1u << 2), 0,
+                              SCATTER_COORD_BYXR};
+    std::string scaleFile;
+    std::string gradFile;
+    uint32_t streamNum = 0;
+    OutputOptions outputOptions = {OUTPUT_STATS_DENSE, OUTPUT_FORMAT_DENSE, "", ""};
+    uint32_t nx = 1024;
+    uint32_t ny = 1024;
+    uint32_t featureSize = 64;
+    std::vector<FrameInput> frames;
+    for (int32_t i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "--frame") == 0) {
+            if (i + 2 >= argc) {
+                printf("错误：--frame 需要特征文件和坐标文件两个取值\n");
+                return -1;
+            }
+            frames.push_back({argv[i + 1], argv[i + 2], 0});
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--pfn-frame") == 0) {
+            if (i + 3 >= argc) {
+                printf("错误：--pfn-frame 需要逐点特征文件、有效点数文件和坐标文件三个取值\n");
+                return -1;
+            }
+            frames.push_back({argv[i + 1], argv[i + 3], 0, argv[i + 2]});
+            i += 2;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printf("错误：参数 %s 缺少取值\n", argv[i]);
+            return -1;
+        }
+        if (strcmp(argv[i], "--mode") == 0) {
+            if (strcmp(argv[i + 1], "pillar") == 0) {
+                options.scatterMode = SCATTER_MODE_PILLAR;
+            } else if (strcmp(argv[i + 1], "band") == 0) {
+                options.scatterMode = SCATTER_MODE_BAND;
+            } else if (strcmp(argv[i + 1], "incremental") == 0) {
+                options.scatterMode = SCATTER_MODE_INCREMENTAL;
+            } else if (strcmp(argv[i + 1], "sorted") == 0) {
+                options.scatterMode = SCATTER_MODE_SORTED;
+            } else if (strcmp(argv[i + 1], "csr") == 0) {
+                options.scatterMode = SCATTER_MODE_CSR;
+            } else if (strcmp(argv[i + 1], "multires") == 0) {
+                options.scatterMode = SCATTER_MODE_MULTIRES;
+            } else {
+                printf("错误：未知模式 %s（可选 pillar/band/incremental/sorted/csr/multires）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--reduce") == 0) {
+            if (strcmp(argv[i + 1], "overwrite") == 0) {
+                options.reduceMode = SCATTER_REDUCE_OVERWRITE;
+            } else if (strcmp(argv[i + 1], "sum") == 0) {
+                options.reduceMode = SCATTER_REDUCE_SUM;
+            } else if (strcmp(argv[i + 1], "max") == 0) {
+                options.reduceMode = SCATTER_REDUCE_MAX;
+            } else if (strcmp(argv[i + 1], "mean") == 0) {
+                options.reduceMode = SCATTER_REDUCE_MEAN;
+            } else {
+                printf("错误：未知归约方式 %s（可选 overwrite/sum/max/mean）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--pool") == 0) {
+            if (strcmp(argv[i + 1], "max") == 0) {
+                options.poolMode = SCATTER_REDUCE_MAX;
+            } else if (strcmp(argv[i + 1], "mean") == 0) {
+                options.poolMode = SCATTER_REDUCE_MEAN;
+            } else {
+                printf("错误：未知池化方式 %s（可选 max/mean）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--pool-strides") == 0) {
+            if (!ParsePoolStrides(argv[i + 1], options.poolStrideMask)) {
+                return -1;
             }
-            nonZeroCount++;
+            continue;
+        }
+        if (strcmp(argv[i], "--dtype") == 0) {
+            if (strcmp(argv[i + 1], "fp16") == 0) {
+                options.inputDtype = SCATTER_DTYPE_FP16;
+            } else if (strcmp(argv[i + 1], "bf16") == 0) {
+                options.inputDtype = SCATTER_DTYPE_BF16;
+            } else if (strcmp(argv[i + 1], "fp32") == 0) {
+                options.inputDtype = SCATTER_DTYPE_FP32;
+            } else if (strcmp(argv[i + 1], "int8") == 0) {
+                options.inputDtype = SCATTER_DTYPE_INT8;
+            } else {
+                printf("错误：未知特征类型 %s（可选 fp16/bf16/fp32/int8）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--scale") == 0) {
+            scaleFile = argv[i + 1];
+            continue;
+        }
+        if (strcmp(argv[i], "--stats") == 0) {
+            if (strcmp(argv[i + 1], "dense") == 0) {
+                outputOptions.statsMode = OUTPUT_STATS_DENSE;
+            } else if (strcmp(argv[i + 1], "coords") == 0) {
+                outputOptions.statsMode = OUTPUT_STATS_COORDS;
+            } else if (strcmp(argv[i + 1], "off") == 0) {
+                outputOptions.statsMode = OUTPUT_STATS_OFF;
+            } else {
+                printf("错误：未知统计方式 %s（可选 dense/coords/off）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--out-format") == 0) {
+            if (strcmp(argv[i + 1], "dense") == 0) {
+                outputOptions.fileFormat = OUTPUT_FORMAT_DENSE;
+            } else if (strcmp(argv[i + 1], "sparse") == 0) {
+                outputOptions.fileFormat = OUTPUT_FORMAT_SPARSE;
+            } else if (strcmp(argv[i + 1], "compact") == 0) {
+                outputOptions.fileFormat = OUTPUT_FORMAT_COMPACT;
+            } else {
+                printf("错误：未知输出格式 %s（可选 dense/sparse/compact）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--output-dir") == 0) {
+            outputOptions.frameDir = argv[i + 1];
+            if (mkdir(argv[i + 1], 0755) != 0 && errno != EEXIST) {
+                printf("错误：无法创建输出目录 %s\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--profile-json") == 0) {
+            outputOptions.profileJson = argv[i + 1];
+            continue;
+        }
+        if (strcmp(argv[i], "--backward") == 0) {
+            gradFile = argv[i + 1];
+            continue;
+        }
+        if (strcmp(argv[i], "--frame-dir") == 0) {
+            if (!CollectFrameDir(argv[i + 1], frames)) {
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--layout") == 0) {
+            if (strcmp(argv[i + 1], "nhwc") == 0) {
+                options.outputLayout = SCATTER_LAYOUT_NHWC;
+            } else if (strcmp(argv[i + 1], "nchw") == 0) {
+                options.outputLayout = SCATTER_LAYOUT_NCHW;
+            } else if (strcmp(argv[i + 1], "transpose") == 0) {
+                options.outputLayout = SCATTER_LAYOUT_NCHW_TRANSPOSE;
+            } else {
+                printf("错误：未知输出布局 %s（可选 nhwc/nchw/transpose）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--channel-split") == 0) {
+            if (strcmp(argv[i + 1], "auto") == 0) {
+                options.channelSplit = 0;
+            } else if (strcmp(argv[i + 1], "off") == 0) {
+                options.channelSplit = 1;
+            } else {
+                options.channelSplit = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+                if (options.channelSplit < 2 || (options.channelSplit & (options.channelSplit - 1)) != 0) {
+                    printf("错误：非法通道切分 %s（可选 auto/off 或2的幂）\n", argv[i + 1]);
+                    return -1;
+                }
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--coord-format") == 0) {
+            const char *names[] = {"byxr", "linear", "yx16"};
+            options.coordFormat = UINT32_MAX;
+            for (uint32_t f = 0; f < 3; f++) {
+                options.coordFormat = strcmp(argv[i + 1], names[f]) == 0 ? f : options.coordFormat;
+            }
+            if (options.coordFormat == UINT32_MAX) {
+                printf("错误：未知坐标格式 %s（可选 byxr/linear/yx16）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(argv[i], "--schedule") == 0) {
+            if (strcmp(argv[i + 1], "static") == 0) {
+                options.scheduleMode = SCATTER_SCHEDULE_STATIC;
+            } else if (strcmp(argv[i + 1], "dynamic") == 0) {
+                options.scheduleMode = SCATTER_SCHEDULE_DYNAMIC;
+            } else if (strcmp(argv[i + 1], "region") == 0) {
+                options.scheduleMode = SCATTER_SCHEDULE_REGION;
+            } else {
+                printf("错误：未知调度方式 %s（可选 static/dynamic/region）\n", argv[i + 1]);
+                return -1;
+            }
+            continue;
+        }
+        uint32_t value = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        if (strcmp(argv[i], "--nx") == 0) {
+            nx = value;
+        } else if (strcmp(argv[i], "--ny") == 0) {
+            ny = value;
+        } else if (strcmp(argv[i], "--c") == 0) {
+            featureSize = value;
+        } else if (strcmp(argv[i], "--block-dim") == 0) {
+            blockDim = value;
+        } else if (strcmp(argv[i], "--max-points") == 0) {
+            options.maxPoints = value;
+        } else if (strcmp(argv[i], "--streams") == 0) {
+            streamNum = value;
+        } else {
+            printf("错误：未知参数 %s\n", argv[i]);
+            printf("用法：%s [--nx W] [--ny H] [--c C] [--block-dim N] "
+                   "[--mode pillar|band|incremental|sorted|csr|multires] [--pool max|mean] [--pool-strides 2,4] "
+                   "[--reduce overwrite|sum|max|mean] [--schedule static|dynamic|region] [--channel-split auto|off|G] "
+                   "[--coord-format byxr|linear|yx16] [--dtype fp16|bf16|fp32|int8] "
+                   "[--scale SCALE] [--frame X COORDS]... [--max-points N --pfn-frame POINTS COUNTS COORDS]... "
+                   "[--frame-dir DIR] [--streams K] [--stats dense|coords|off] "
+                   "[--out-format dense|sparse|compact] [--output-dir DIR] [--layout nhwc|nchw|transpose] "
+                   "[--profile-json FILE] [--backward GRAD]\n",
+                   argv[0]);
+            return -1;
+        }
+    }
+    if (nx == 0 || ny == 0 || blockDim == 0 || featureSize == 0 ||
+        featureSize % PILLAR_SCATTER_CHANNEL_ALIGN != 0) {
+        printf("错误：非法配置 nx=%u ny=%u C=%u blockDim=%u (C需为%u的倍数)\n",
+               nx, ny, featureSize, blockDim, PILLAR_SCATTER_CHANNEL_ALIGN);
+        return -1;
+    }
+    // 以下为命令行的便利切换，规则本身由ValidateConfig检查（库调用者直接得到错误）：
+    // 非覆盖归约要求同一cell的pillar由同一个核按原始顺序处理，只有band和csr模式满足
+    // （multires模式不切换，由ValidateConfig报错）
+    if (options.reduceMode != SCATTER_REDUCE_OVERWRITE && options.scatterMode != SCATTER_MODE_BAND &&
+        options.scatterMode != SCATTER_MODE_CSR && options.scatterMode != SCATTER_MODE_MULTIRES) {
+        printf("提示：--reduce 非overwrite时切换到band模式\n");
+        options.scatterMode = SCATTER_MODE_BAND;
+    }
+    // REGION调度依赖按cell排序后的pillar顺序
+    if (options.scheduleMode == SCATTER_SCHEDULE_REGION && options.scatterMode == SCATTER_MODE_PILLAR) {
+        printf("提示：--schedule region 需要按cell排序，切换到sorted模式\n");
+        options.scatterMode = SCATTER_MODE_SORTED;
+    }
+    // NCHW输出由band模式在UB内转置完成
+    if (options.outputLayout == SCATTER_LAYOUT_NCHW && options.scatterMode != SCATTER_MODE_BAND &&
+        options.scatterMode != SCATTER_MODE_MULTIRES) {
+        printf("提示：--layout nchw 在band模式下完成，切换到band模式\n");
+        options.scatterMode = SCATTER_MODE_BAND;
+    }
+    // 各kernel支持的类型、布局、通道切分、坐标格式和multires组合由PillarScatterRunner::Init（ValidateConfig）检查
+    // PFN融合入口：所有帧都需为--pfn-frame
+    size_t pfnFrames = std::count_if(frames.begin(), frames.end(),
+                                     [](const FrameInput &frame) { return !frame.countsFile.empty(); });
+    bool usePfn = pfnFrames > 0;
+    if (usePfn || options.maxPoints > 0) {
+        if (pfnFrames != frames.size() || options.maxPoints == 0) {
+            printf("错误：PFN融合输入需同时指定 --max-points 且所有帧均使用 --pfn-frame\n");
+            return -1;
+        }
+    }
+    // 坐标模式的统计按覆盖语义由pillar特征推出，PFN逐点特征和非覆盖归约只能扫描稠密输出
+    if (outputOptions.statsMode == OUTPUT_STATS_COORDS &&
+        (usePfn || options.reduceMode != SCATTER_REDUCE_OVERWRITE)) {
+        printf("提示：--stats coords 只支持覆盖写的pillar特征输入，切换到dense统计\n");
+        outputOptions.statsMode = OUTPUT_STATS_DENSE;
+    }
+    // csr模式没有稠密输出：覆盖写可由坐标推出统计，非覆盖归约不统计；输出文件总是紧凑容器
+    if (options.scatterMode == SCATTER_MODE_CSR) {
+        uint32_t csrStats = options.reduceMode == SCATTER_REDUCE_OVERWRITE ? OUTPUT_STATS_COORDS : OUTPUT_STATS_OFF;
+        if (outputOptions.statsMode == OUTPUT_STATS_DENSE) {
+            printf("提示：csr模式没有稠密输出，--stats 切换为%s\n", csrStats == OUTPUT_STATS_COORDS ? "coords" : "off");
+            outputOptions.statsMode = csrStats;
+        }
+        if (outputOptions.fileFormat != OUTPUT_FORMAT_COMPACT) {
+            printf("提示：csr模式的输出文件总是紧凑容器\n");
+            outputOptions.fileFormat = OUTPUT_FORMAT_COMPACT;
+        }
+    }
+    // NCHW输出：稠密统计和紧凑容器都按NHWC解释输出，覆盖写可由坐标推出统计，非覆盖归约不统计
+    if (options.outputLayout != SCATTER_LAYOUT_NHWC) {
+        if (outputOptions.statsMode == OUTPUT_STATS_DENSE) {
+            uint32_t nchwStats = options.reduceMode == SCATTER_REDUCE_OVERWRITE ? OUTPUT_STATS_COORDS : OUTPUT_STATS_OFF;
+            printf("提示：NCHW输出不能按NHWC扫描，--stats 切换为%s\n", nchwStats == OUTPUT_STATS_COORDS ? "coords" : "off");
+            outputOptions.statsMode = nchwStats;
+        }
+        if (outputOptions.fileFormat == OUTPUT_FORMAT_COMPACT) {
+            printf("提示：紧凑容器按NHWC的cell组织，NCHW输出改为写出稀疏文件\n");
+            outputOptions.fileFormat = OUTPUT_FORMAT_SPARSE;
         }
     }
+    // 每个pillar在输入文件中的特征元素数
+    uint32_t inputRowSize = featureSize * std::max<uint32_t>(1, options.maxPoints);
+    size_t inElemSize = InputElemSize(options.inputDtype);
+    // 未指定--frame时使用默认的单帧输入
+    if (frames.empty()) {
+        frames.push_back({"./input/OpTest_scatter_input_x.bin", "./input/OpTest_scatter_input_coords.bin", 0});
+    }
+    
+    // 根据输入文件大小自动计算pillar数量
+    if (!ProbeFrames(frames, inputRowSize, inElemSize)) {
+        return -1;
+    }
+    std::vector<uint16_t> dequantScale;
+    if (options.inputDtype == SCATTER_DTYPE_INT8 && !LoadDequantScale(scaleFile, featureSize, dequantScale)) {
+        return -1;
+    }
     
-    printf("\n输出数据验证 (NHWC格式):\n");
-    printf("  总元素数: %zu\n", totalElements);
-    printf("  非零元素数: %zu (%.2f%%)\n", nonZeroCount, (float)nonZeroCount / totalElements * 100);
-    if (nonZeroCount > 0) {
-        printf("  第一个非零值: 0x%04X (位置: %zu)\n", firstNonZeroHalf, firstNonZeroIdx);
-        // 将位置转换为NHWC坐标
-        size_t h = firstNonZeroIdx / (FEATURE_X * PILLAR_FEATURE_SIZE);
-        size_t w = (firstNonZeroIdx % (FEATURE_X * PILLAR_FEATURE_SIZE)) / PILLAR_FEATURE_SIZE;
-        size_t c = firstNonZeroIdx % PILLAR_FEATURE_SIZE;
-        printf("  对应坐标: H=%zu, W=%zu, C=%zu\n", h, w, c);
+    // 帧流水线：各帧独立launch（batch为1），缓冲区按pillar最多的一帧分配
+    if (streamNum > 0) {
+        if (options.scatterMode == SCATTER_MODE_INCREMENTAL) {
+            printf("错误：incremental模式依赖上一帧的输出，不能与 --streams 同时使用\n");
+            return -1;
+        }
+        if (!gradFile.empty()) {
+            printf("错误：--backward 不能与 --streams 同时使用\n");
+            return -1;
+        }
+        if (options.scatterMode == SCATTER_MODE_MULTIRES) {
+            printf("错误：帧流水线只写出全分辨率输出，multires模式不能与 --streams 同时使用\n");
+            return -1;
+        }
+        uint32_t maxFramePillars = 0;
+        for (const FrameInput &frame : frames) {
+            maxFramePillars = std::max(maxFramePillars, frame.numPillars);
+        }
+        printf("帧流水线：%zu 帧，%u 个流，单帧最多 %u 个pillars\n", frames.size(), streamNum, maxFramePillars);
+        PillarScatterConfig config = {nx, ny, featureSize, 1, blockDim, options, maxFramePillars, true, 0,
+                                      dequantScale};
+        return RunFramePipeline(frames, config, streamNum, outputOptions);
+    }
+    
+    // INCREMENTAL模式逐帧launch（batch为1）；其余模式所有帧拼成一个batch一次launch
+    std::vector<std::vector<FrameInput>> launches;
+    if (options.scatterMode == SCATTER_MODE_INCREMENTAL) {
+        for (size_t b = 0; b < frames.size(); b++) {
+            launches.push_back({frames[b]});
+        }
     } else {
-        printf("  警告：输出全是0！\n");
+        launches.push_back(frames);
+    }
+    uint32_t batchSize = (uint32_t)launches[0].size();
+    const char *modeNames[] = {"pillar", "band", "incremental", "sorted", "csr", "multires"};
+    const char *reduceNames[] = {"overwrite", "sum", "max", "mean"};
+    const char *scheduleNames[] = {"static", "dynamic", "region"};
+    const char *dtypeNames[] = {"fp16", "bf16", "fp32", "int8"};
+    const char *layoutNames[] = {"NHWC", "NCHW", "NCHW(转置)"};
+    printf("配置：BEV网格 %ux%u，通道数 %u，batch %u，blockDim %u，模式 %s，归约 %s，调度 %s，类型 %s，布局 %s\n",
+           nx, ny, featureSize, batchSize, blockDim, modeNames[options.scatterMode], reduceNames[options.reduceMode],
+           scheduleNames[options.scheduleMode], dtypeNames[options.inputDtype], layoutNames[options.outputLayout]);
+    
+    std::vector<uint32_t> launchPillars(launches.size(), 0);
+    uint32_t max_pillars = 0;
+    for (size_t l = 0; l < launches.size(); l++) {
+        for (size_t b = 0; b < launches[l].size(); b++) {
+            printf("第%zu帧包含 %u 个pillars\n", l + b, launches[l][b].numPillars);
+            launchPillars[l] += launches[l][b].numPillars;
+        }
+        max_pillars = std::max(max_pillars, launchPillars[l]);
+    }
+    printf("检测到输入数据包含 %u 个pillars\n", max_pillars);
+    if (usePfn) {
+        printf("PFN融合输入：每个pillar最多 %u 个点\n", options.maxPoints);
+    }
+    
+    // 缓冲区按pillar最多的一次launch分配，各次launch间复用
+    PillarScatterConfig config = {nx, ny, featureSize, batchSize, blockDim, options, max_pillars, true, 0,
+                                  dequantScale};
+    PillarScatterRunner runner(config);
+    if (!runner.Init()) {
+        return -1;
+    }
+    
+    LaunchInput input;
+    std::vector<ProfileRecord> profiles;
+    for (size_t l = 0; l < launches.size(); l++) {
+        // 从文件读取输入数据到主机内存
+        if (!ReadLaunchInput(launches[l], inputRowSize, inElemSize, usePfn, input)) {
+            return -1;
+        }
+        
+        // 开始计时（含host侧预处理、H2D拷贝、kernel和D2H拷贝）
+        printf("\n========== 算子执行时间统计 ==========\n");
+        printf("开始执行PillarScatter算子 (%s模式，第%zu次launch)...\n", RUN_MODE_NAME, l);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        PrintTimestamp("开始时间");
+        
+        if (!runner.Run(input.features.data(), RunnerCoords(config, input), input.numPillars,
+                        usePfn ? input.pointCounts.data() : nullptr)) {
+            return -1;
+        }
+        
+        // 结束计时
+        auto end_time = std::chrono::high_resolution_clock::now();
+        PrintTimestamp("结束时间");
+        PrintTiming(RUN_MODE_NAME, start_time, end_time, runner.LastPillars());
+        PrintDiagnostics(runner.LastDiagnostics());
+        if (runner.LastChannelSplit() > 1) {
+            printf("通道切分：%u 个pillar组 x %u 片，每核 %u 个通道\n", blockDim / runner.LastChannelSplit(),
+                   runner.LastChannelSplit(), featureSize / runner.LastChannelSplit());
+        }
+        if (!runner.LastProfile().empty()) {
+            profiles.push_back({(uint32_t)l, runner.LastKernelMs(), runner.LastProfile()});
+            PrintProfileReport(profiles.back());
+        }
+        if (!WriteFrameOutputs(launches[l], outputOptions, config, runner)) {
+            return -1;
+        }
     }
 
-    // 将输出结果写入文件
-    WriteFile("./output/OpTest_scatter_output_x.bin", spatialFeaturesHost, spatialFeaturesSize);
+    if (!FinishProfile(outputOptions.profileJson, profiles)) {
+        return -1;
+    }
 
-    // 释放设备和主机内存
-    CHECK_ACL(aclrtFree(pillarFeaturesDevice));
-    CHECK_ACL(aclrtFree(coordsDevice));
-    CHECK_ACL(aclrtFree(paramsDevice));
-    CHECK_ACL(aclrtFree(spatialFeaturesDevice));
-    CHECK_ACL(aclrtFreeHost(pillarFeaturesHost));
-    CHECK_ACL(aclrtFreeHost(coordsHost));
-    CHECK_ACL(aclrtFreeHost(paramsHost));
-    CHECK_ACL(aclrtFreeHost(spatialFeaturesHost));
+    // 统计输出数据（INCREMENTAL模式下input为最后一帧）
+    ReportOutputStats(outputOptions.statsMode, config, runner, input);
 
-    // 销毁流，重置设备，反初始化ACL环境
-    CHECK_ACL(aclrtDestroyStream(stream));
-    CHECK_ACL(aclrtResetDevice(deviceId));
-    CHECK_ACL(aclFinalize());
-#endif
+    // 将输出结果写入文件（INCREMENTAL模式下为最后一帧的输出）
+    if (!WriteOutputBatches("./output/OpTest_scatter_output_x.bin", outputOptions.fileFormat, config, runner, 0,
+                            batchSize)) {
+        return -1;
+    }
+    if (options.scatterMode == SCATTER_MODE_MULTIRES && !WritePooledOutputs(outputOptions.fileFormat, config, runner)) {
+        return -1;
+    }
+    if (!gradFile.empty() && !RunBackwardPass(gradFile, config, runner, input)) {
+        return -1;
+    }
     // 程序正常结束
     return 0;
 }
@@ -0,0 +1,447 @@
+/**
+ * @file pillar_scatter_bench.cpp
+ *
+ * PillarScatter算子的基准测试程序。
+ * 对pillar数、网格大小、通道数、blockDim、重复坐标比例（以及scatter模式、输出布局）做笛卡尔积扫描，
+ * 每个配置先预热若干次，再重复launch N次：NPU模式下kernel耗时由紧贴kernel的aclrtEvent计时，
+ * CPU模式下为墙钟时间。输出min/median/p99和有效带宽，并可写出JSON供不同kernel版本之间对比回归。
+ * --op gather 改为测量反向PillarGather：同样的坐标下从输出梯度读出各pillar的梯度。
+ * 覆盖归约的反向要求确定的前向（--mode band、--mode sorted --schedule region或单核），其余扫描点跳过。
+ */
+#include "pillar_scatter_runner.h"
+#include "pillar_scatter_workload.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef ASCENDC_CPU_DEBUG
+constexpr const char *RUN_MODE_NAME = "CPU";
+#else
+constexpr const char *RUN_MODE_NAME = "NPU";
+#endif
+
+// 一个扫描点的配置
+struct BenchCase {
+    uint32_t numPillars;
+    uint32_t nx;
+    uint32_t ny;
+    uint32_t featureSize;
+    uint32_t blockDim;
+    double dupRatio;
+    uint32_t scatterMode;
+    uint32_t outputLayout;
+    bool gather;           // 测量反向PillarGather
+};
+
+// 一组耗时样本的统计（ms）
+struct TimingStats {
+    double min;
+    double median;
+    double p99;
+    double mean;
+};
+
+// 一个扫描点的测试结果
+struct BenchResult {
+    BenchCase benchCase;
+    TimingStats kernel;   // kernel本身
+    TimingStats launch;   // 上传+清零+kernel
+    double bytes;         // kernel读写的有效字节数
+    double gbps;          // 按kernel中位数计算的有效带宽
+};
+
+/**
+ * @brief 解析逗号分隔的取值列表，如 "5000,12000,30000"
+ */
+template <typename T>
+bool ParseList(const char *text, std::vector<T> &values, T (*convert)(const char *))
+{
+    values.clear();
+    std::string item;
+    for (const char *p = text;; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (item.empty()) {
+                return false;
+            }
+            values.push_back(convert(item.c_str()));
+            item.clear();
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            item.push_back(*p);
+        }
+    }
+    return true;
+}
+
+uint32_t ToUint(const char *text)
+{
+    return static_cast<uint32_t>(strtoul(text, nullptr, 10));
+}
+
+double ToDouble(const char *text)
+{
+    return strtod(text, nullptr);
+}
+
+uint32_t ToMode(const char *text)
+{
+    const char *names[] = {"pillar", "band", "incremental", "sorted", "csr"};
+    for (uint32_t m = 0; m < sizeof(names) / sizeof(names[0]); m++) {
+        if (strcmp(text, names[m]) == 0) {
+            return m;
+        }
+    }
+    return UINT32_MAX;
+}
+
+uint32_t ToLayout(const char *text)
+{
+    const char *names[] = {"nhwc", "nchw", "transpose"};
+    for (uint32_t l = 0; l < sizeof(names) / sizeof(names[0]); l++) {
+        if (strcmp(text, names[l]) == 0) {
+            return l;
+        }
+    }
+    return UINT32_MAX;
+}
+
+/**
+ * @brief 计算min/median/p99/mean，p99取第ceil(0.99*n)小的样本
+ */
+TimingStats ComputeStats(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    TimingStats stats;
+    stats.min = samples[0];
+    stats.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats.p99 = samples[static_cast<size_t>(std::ceil(0.99 * n)) - 1];
+    double sum = 0;
+    for (double v : samples) {
+        sum += v;
+    }
+    stats.mean = sum / n;
+    return stats;
+}
+
+/**
+ * @brief kernel读写的有效字节数
+ *
+ * 读：特征和坐标（PILLAR/SORTED模式按kernel读取的坐标格式计）；写：BAND模式写满整个输出，其余模式只写pillar所在的行（输出清零不计入kernel），
+ * CSR模式按pillar数估计紧凑特征的写出量（有重复坐标时略偏大）。
+ * NCHW_TRANSPOSE布局另计单独转置kernel对整张特征图的一次读入和写出。
+ * 反向读坐标和每个pillar所在的梯度行，写出 [P, C] 的pillar梯度。
+ */
+double KernelBytes(const BenchCase &benchCase, const ScatterOptions &options)
+{
+    uint32_t dtype = options.inputDtype;
+    double pillars = benchCase.numPillars;
+    if (benchCase.gather) {
+        return pillars * PILLAR_SCATTER_COORD_DIM * sizeof(uint32_t) +
+               2.0 * pillars * benchCase.featureSize * OutputElemSize(dtype);
+    }
+    bool compactCoords = benchCase.scatterMode == SCATTER_MODE_PILLAR || benchCase.scatterMode == SCATTER_MODE_SORTED;
+    uint32_t coordWords = compactCoords ? CoordWords(options.coordFormat) : PILLAR_SCATTER_COORD_DIM;
+    double readBytes = pillars * benchCase.featureSize * InputElemSize(dtype) + pillars * coordWords * sizeof(uint32_t);
+    double rowBytes = (double)benchCase.featureSize * OutputElemSize(dtype);
+    double writeBytes = benchCase.scatterMode == SCATTER_MODE_BAND ?
+                        (double)benchCase.nx * benchCase.ny * rowBytes : pillars * rowBytes;
+    if (benchCase.outputLayout == SCATTER_LAYOUT_NCHW_TRANSPOSE) {
+        writeBytes += 2.0 * benchCase.nx * benchCase.ny * rowBytes;
+    }
+    return readBytes + writeBytes;
+}
+
+/**
+ * @brief 一个扫描点的Runner配置（batch为1，不下载输出）
+ */
+PillarScatterConfig CaseConfig(const BenchCase &benchCase, const ScatterOptions &baseOptions)
+{
+    ScatterOptions options = baseOptions;
+    options.scatterMode = benchCase.scatterMode;
+    options.outputLayout = benchCase.outputLayout;
+    return {benchCase.nx, benchCase.ny, benchCase.featureSize, 1, benchCase.blockDim, options, benchCase.numPillars,
+            false, 0, {}};
+}
+
+/**
+ * @brief 运行一个扫描点：预热后重复launch，统计kernel和launch耗时
+ */
+bool RunCase(const BenchCase &benchCase, const ScatterOptions &baseOptions, uint32_t distribution, uint32_t warmup,
+             uint32_t iterations, BenchResult &result)
+{
+    PillarScatterConfig config = CaseConfig(benchCase, baseOptions);
+    const ScatterOptions &options = config.options;
+    PillarScatterRunner runner(config);
+    if (!runner.Init()) {
+        return false;
+    }
+    std::vector<uint8_t> features;
+    std::vector<uint32_t> coords;
+    // 种子只取决于规模，同一场景在不同C/blockDim/模式之间保持一致
+    WorkloadConfig workload = {benchCase.numPillars, benchCase.nx, benchCase.ny, benchCase.featureSize,
+                               options.inputDtype, distribution, benchCase.numPillars ^ benchCase.nx,
+                               benchCase.dupRatio, 0.0, 0.0};
+    if (!GenerateWorkload(workload, features, coords)) {
+        return false;
+    }
+    // 紧凑坐标原地编码，Runner按options.coordFormat解释
+    PackCoords(coords.data(), benchCase.numPillars, options.coordFormat, benchCase.nx, benchCase.ny, 1, coords.data());
+
+    // 反向的输出梯度取全1，数值不影响耗时
+    std::vector<uint8_t> grad;
+    if (benchCase.gather) {
+        size_t elemSize = OutputElemSize(options.inputDtype);
+        uint32_t one = elemSize == sizeof(float) ? 0x3F800000u : (options.inputDtype == SCATTER_DTYPE_BF16 ?
+                                                                  0x3F80u : 0x3C00u);
+        grad.resize(runner.OutputSize());
+        for (size_t offset = 0; offset < grad.size(); offset += elemSize) {
+            memcpy(grad.data() + offset, &one, elemSize);
+        }
+    }
+    auto launch = [&]() {
+        return benchCase.gather ? runner.RunBackward(grad.data(), coords.data(), benchCase.numPillars) :
+                                  runner.Run(features.data(), coords.data(), benchCase.numPillars);
+    };
+
+    for (uint32_t i = 0; i < warmup; i++) {
+        if (!launch()) {
+            return false;
+        }
+    }
+    std::vector<double> kernelMs;
+    std::vector<double> launchMs;
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (!launch()) {
+            return false;
+        }
+        kernelMs.push_back(runner.LastKernelMs());
+        launchMs.push_back(runner.LastLaunchMs());
+    }
+    result.benchCase = benchCase;
+    result.kernel = ComputeStats(kernelMs);
+    result.launch = ComputeStats(launchMs);
+    result.bytes = KernelBytes(benchCase, options);
+    result.gbps = result.bytes / (result.kernel.median / 1000.0) / 1e9;
+    return true;
+}
+
+void WriteStatsJson(FILE *fp, const char *name, const TimingStats &stats)
+{
+    fprintf(fp, "\"%s\": {\"min\": %.6f, \"median\": %.6f, \"p99\": %.6f, \"mean\": %.6f}", name, stats.min,
+            stats.median, stats.p99, stats.mean);
+}
+
+/**
+ * @brief 写出JSON：顶层记录标签和公共参数，results数组每项为一个扫描点（耗时单位ms）
+ */
+bool WriteJson(const std::string &path, const std::string &label, const ScatterOptions &options,
+               uint32_t distribution, uint32_t warmup, uint32_t iterations, const std::vector<BenchResult> &results)
+{
+    FILE *fp = fopen(path.c_str(), "w");
+    if (fp == nullptr) {
+        printf("错误：无法写入 %s\n", path.c_str());
+        return false;
+    }
+    const char *modeNames[] = {"pillar", "band", "incremental", "sorted", "csr"};
+    const char *layoutNames[] = {"nhwc", "nchw", "transpose"};
+    const char *reduceNames[] = {"overwrite", "sum", "max", "mean"};
+    const char *scheduleNames[] = {"static", "dynamic", "region"};
+    const char *dtypeNames[] = {"fp16", "bf16", "fp32", "int8"};
+    const char *coordNames[] = {"byxr", "linear", "yx16"};
+    fprintf(fp, "{\n  \"label\": \"%s\",\n  \"run_mode\": \"%s\",\n", label.c_str(), RUN_MODE_NAME);
+    fprintf(fp, "  \"op\": \"%s\",\n", !results.empty() && results[0].benchCase.gather ? "gather" : "scatter");
+    fprintf(fp, "  \"reduce\": \"%s\",\n  \"schedule\": \"%s\",\n  \"dtype\": \"%s\",\n",
+            reduceNames[options.reduceMode], scheduleNames[options.scheduleMode], dtypeNames[options.inputDtype]);
+    fprintf(fp, "  \"dist\": \"%s\",\n  \"coord_format\": \"%s\",\n", DistributionName(distribution),
+            coordNames[options.coordFormat]);
+    fprintf(fp, "  \"warmup\": %u,\n  \"iterations\": %u,\n  \"results\": [\n", warmup, iterations);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        fprintf(fp, "    {\"mode\": \"%s\", \"layout\": \"%s\", \"pillars\": %u, \"nx\": %u, \"ny\": %u, "
+                    "\"c\": %u, \"block_dim\": %u, \"dup_ratio\": %.4f, ",
+                r.benchCase.gather ? "gather" : modeNames[r.benchCase.scatterMode],
+                layoutNames[r.benchCase.outputLayout], r.benchCase.numPillars, r.benchCase.nx, r.benchCase.ny,
+                r.benchCase.featureSize, r.benchCase.blockDim, r.benchCase.dupRatio);
+        WriteStatsJson(fp, "kernel_ms", r.kernel);
+        fprintf(fp, ", ");
+        WriteStatsJson(fp, "launch_ms", r.launch);
+        fprintf(fp, ", \"bytes\": %.0f, \"gbps\": %.3f}%s\n", r.bytes, r.gbps, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+void PrintUsage(const char *program)
+{
+    printf("用法：%s [--pillars N,...] [--grid WxH,...] [--c C,...] [--block-dim N,...] [--dup R,...]\n"
+           "          [--mode pillar|band|sorted|csr,...] [--layout nhwc|nchw|transpose,...] "
+           "[--reduce overwrite|sum|max|mean] [--schedule static|dynamic|region]\n"
+           "          [--dtype fp16|bf16|fp32|int8] [--dist uniform|ring|urban] [--warmup N] [--iters N] [--label STR] [--json FILE]\n"
+           "          [--op scatter|gather] [--channel-split auto|off|G] [--coord-format byxr|linear|yx16]\n",
+           program);
+}
+
+int32_t main(int32_t argc, char *argv[])
+{
+    // 默认扫描点覆盖PointPillars常见规模（KITTI 432x496、nuScenes 512x512）
+    std::vector<uint32_t> pillarList = {5000, 12000, 30000};
+    std::vector<uint32_t> gridList = {432, 496, 512, 512};
+    std::vector<uint32_t> channelList = {64};
+    std::vector<uint32_t> blockDimList = {8};
+    std::vector<double> dupList = {0.0};
+    std::vector<uint32_t> modeList = {SCATTER_MODE_PILLAR};
+    std::vector<uint32_t> layoutList = {SCATTER_LAYOUT_NHWC};
+    ScatterOptions options = {SCATTER_MODE_PILLAR, SCATTER_REDUCE_OVERWRITE, SCATTER_SCHEDULE_STATIC,
+                              SCATTER_DTYPE_FP16, 0, SCATTER_LAYOUT_NHWC};
+    uint32_t warmup = 5;
+    uint32_t iterations = 50;
+    uint32_t distribution = PILLAR_DIST_UNIFORM;
+    std::string label = "default";
+    std::string jsonFile;
+    bool gather = false;
+    for (int32_t i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            printf("错误：参数 %s 缺少取值\n", argv[i]);
+            PrintUsage(argv[0]);
+            return -1;
+        }
+        const char *value = argv[i + 1];
+        bool ok = true;
+        if (strcmp(argv[i], "--pillars") == 0) {
+            ok = ParseList(value, pillarList, ToUint);
+        } else if (strcmp(argv[i], "--grid") == 0) {
+            // WxH列表，展开为 [W0, H0, W1, H1, ...]
+            std::string grids = value;
+            std::replace(grids.begin(), grids.end(), 'x', ',');
+            ok = ParseList(grids.c_str(), gridList, ToUint) && gridList.size() % 2 == 0;
+        } else if (strcmp(argv[i], "--c") == 0) {
+            ok = ParseList(value, channelList, ToUint);
+        } else if (strcmp(argv[i], "--block-dim") == 0) {
+            ok = ParseList(value, blockDimList, ToUint);
+        } else if (strcmp(argv[i], "--dup") == 0) {
+            ok = ParseList(value, dupList, ToDouble);
+        } else if (strcmp(argv[i], "--mode") == 0) {
+            ok = ParseList(value, modeList, ToMode);
+        } else if (strcmp(argv[i], "--layout") == 0) {
+            ok = ParseList(value, layoutList, ToLayout) &&
+                 std::find(layoutList.begin(), layoutList.end(), UINT32_MAX) == layoutList.end();
+        } else if (strcmp(argv[i], "--reduce") == 0) {
+            const char *names[] = {"overwrite", "sum", "max", "mean"};
+            options.reduceMode = UINT32_MAX;
+            for (uint32_t r = 0; r < 4; r++) {
+                options.reduceMode = strcmp(value, names[r]) == 0 ? r : options.reduceMode;
+            }
+            ok = options.reduceMode != UINT32_MAX;
+        } else if (strcmp(argv[i], "--schedule") == 0) {
+            const char *names[] = {"static", "dynamic", "region"};
+            options.scheduleMode = UINT32_MAX;
+            for (uint32_t s = 0; s < 3; s++) {
+                options.scheduleMode = strcmp(value, names[s]) == 0 ? s : options.scheduleMode;
+            }
+            ok = options.scheduleMode != UINT32_MAX;
+        } else if (strcmp(argv[i], "--dtype") == 0) {
+            const char *names[] = {"fp16", "bf16", "fp32", "int8"};
+            options.inputDtype = UINT32_MAX;
+            for (uint32_t d = 0; d < 4; d++) {
+                options.inputDtype = strcmp(value, names[d]) == 0 ? d : options.inputDtype;
+            }
+            ok = options.inputDtype != UINT32_MAX;
+        } else if (strcmp(argv[i], "--warmup") == 0) {
+            warmup = ToUint(value);
+        } else if (strcmp(argv[i], "--iters") == 0) {
+            iterations = ToUint(value);
+        } else if (strcmp(argv[i], "--dist") == 0) {
+            ok = ParseDistribution(value, distribution);
+        } else if (strcmp(argv[i], "--label") == 0) {
+            label = value;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            jsonFile = value;
+        } else if (strcmp(argv[i], "--op") == 0) {
+            ok = strcmp(value, "scatter") == 0 || strcmp(value, "gather") == 0;
+            gather = strcmp(value, "gather") == 0;
+        } else if (strcmp(argv[i], "--channel-split") == 0) {
+            // 与ascendc_kernels_bbit相同：auto=0，off=1，其余为2的幂；不满足约束的扫描点由runner自动关闭
+            options.channelSplit = strcmp(value, "auto") == 0 ? 0 : (strcmp(value, "off") == 0 ? 1 : ToUint(value));
+            ok = options.channelSplit <= 1 || (options.channelSplit & (options.channelSplit - 1)) == 0;
+        } else if (strcmp(argv[i], "--coord-format") == 0) {
+            const char *names[] = {"byxr", "linear", "yx16"};
+            options.coordFormat = UINT32_MAX;
+            for (uint32_t f = 0; f < 3; f++) {
+                options.coordFormat = strcmp(value, names[f]) == 0 ? f : options.coordFormat;
+            }
+            ok = options.coordFormat != UINT32_MAX;
+        } else {
+            printf("错误：未知参数 %s\n", argv[i]);
+            PrintUsage(argv[0]);
+            return -1;
+        }
+        if (!ok) {
+            printf("错误：参数 %s 的取值 %s 非法\n", argv[i], value);
+            return -1;
+        }
+    }
+    if (iterations == 0) {
+        printf("错误：--iters 需大于0\n");
+        return -1;
+    }
+    for (uint32_t mode : modeList) {
+        // incremental模式的输出依赖上一帧，重复launch同一帧测不出实际开销
+        if (mode == UINT32_MAX || mode == SCATTER_MODE_INCREMENTAL) {
+            printf("错误：--mode 只支持 pillar/band/sorted/csr\n");
+            return -1;
+        }
+    }
+    std::vector<BenchResult> results;
+    const char *modeNames[] = {"pillar", "band", "incremental", "sorted", "csr"};
+    const char *layoutNames[] = {"nhwc", "nchw", "transpose"};
+    printf("%-7s %-9s %8s %11s %5s %6s %6s %11s %11s %11s %11s %9s\n", "mode", "layout", "pillars", "grid", "C",
+           "block", "dup", "min(ms)", "median(ms)", "p99(ms)", "launch(ms)", "GB/s");
+    for (uint32_t mode : modeList) {
+        for (uint32_t layout : layoutList) {
+            for (size_t g = 0; g < gridList.size(); g += 2) {
+                for (uint32_t numPillars : pillarList) {
+                    for (uint32_t featureSize : channelList) {
+                        for (uint32_t blockDim : blockDimList) {
+                            for (double dupRatio : dupList) {
+                                BenchCase benchCase = {numPillars, gridList[g], gridList[g + 1], featureSize, blockDim,
+                                                       dupRatio, mode, layout, gather};
+                                // 类型、布局、对齐等组合由ValidateConfig检查，反向的限制由BackwardSupported检查
+                                // （均打印原因），不支持的扫描点跳过
+                                PillarScatterConfig config = CaseConfig(benchCase, options);
+                                if (numPillars == 0 || !ValidateConfig(config) ||
+                                    (gather && !BackwardSupported(config))) {
+                                    printf("跳过非法配置 N=%u grid=%ux%u C=%u blockDim=%u\n", numPillars,
+                                           benchCase.nx, benchCase.ny, featureSize, blockDim);
+                                    continue;
+                                }
+                                BenchResult result;
+                                if (!RunCase(benchCase, options, distribution, warmup, iterations, result)) {
+                                    return -1;
+                                }
+                                char grid[32];
+                                snprintf(grid, sizeof(grid), "%ux%u", benchCase.nx, benchCase.ny);
+                                printf("%-7s %-9s %8u %11s %5u %6u %6.2f %11.4f %11.4f %11.4f %11.4f %9.2f\n",
+                                       gather ? "gather" : modeNames[mode], layoutNames[layout], numPillars, grid, featureSize,
+                                       blockDim, dupRatio, result.kernel.min, result.kernel.median,
+                                       result.kernel.p99, result.launch.median, result.gbps);
+                                results.push_back(result);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (!jsonFile.empty() && !WriteJson(jsonFile, label, options, distribution, warmup, iterations, results)) {
+        return -1;
+    }
+    return 0;
+}
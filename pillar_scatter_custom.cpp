@@ -1,19 +1,261 @@
 #include<string.h>
 #include "kernel_operator.h"
+#include "pillar_scatter_tiling.h"
 using namespace AscendC;
 
 // ==================== 算子参数配置 ====================
-constexpr int32_t PILLAR_FEATURE_SIZE = 64;           // 每个pillar的特征维度
-constexpr int32_t MAX_PILLARS_PER_CORE = 2048;        // 每个核心处理的最大pillar数
-constexpr int32_t USE_CORE_NUM = 8;                   // 使用的核心数
+// 网格大小、通道数和核数由host侧经tiling传入，这里只保留与硬件相关的常量
 constexpr int32_t BUFFER_NUM = 2;                     // 双缓冲
-constexpr int32_t FEATURE_X = 1024;                    // BEV特征图宽度 (nx)
-constexpr int32_t FEATURE_Y = 1024;                    // BEV特征图高度 (ny)
+constexpr int32_t COORD_DIM = PILLAR_SCATTER_COORD_DIM;  // 每个pillar的坐标字段数 [batch, y, x, reserved]
+constexpr int32_t BLOCK_BYTES = 32;                   // DataCopy要求的32字节对齐粒度
+constexpr int32_t COORD_ALIGN = BLOCK_BYTES / sizeof(uint32_t);  // 32字节对应的uint32个数
+constexpr int32_t BIN_ENTRY_DIM = PILLAR_SCATTER_BIN_ENTRY_DIM;  // 行分桶条目 [pillar下标, x]
+constexpr int32_t ROW_GROUP = 64;                     // BAND模式每次搬入UB的行起始表长度
+constexpr int32_t ENTRY_TILE = 256;                   // BAND模式每次搬入UB的分桶条目数
+constexpr uint32_t BITMAP_BYTES = 64 * 1024;          // INCREMENTAL模式本核cell占用位图的UB上限
+constexpr int32_t LIST_HEAD = COORD_ALIGN;            // INCREMENTAL模式cell列表的计数头长度（uint32个数）
+constexpr int32_t TRANS_BLOCK = 16;                   // TransDataTo5HD一次转置 16x16 个half
 
 // 控制调试输出的开关
 // constexpr bool ENABLE_DEBUG_PRINT = false;  // 关闭调试输出，提升性能
 
+/**
+ * @brief 将GM上的tiling数据按uint32_t逐字拷贝到栈上
+ */
+__aicore__ inline void CopyTiling(PillarScatterTilingData* tiling, GM_ADDR tilingGm)
+{
+    uint32_t* dst = reinterpret_cast<uint32_t*>(tiling);
+    __gm__ uint32_t* src = reinterpret_cast<__gm__ uint32_t*>(tilingGm);
+    for (uint32_t i = 0; i < sizeof(PillarScatterTilingData) / sizeof(uint32_t); i++) {
+        dst[i] = src[i];
+    }
+}
+
+/**
+ * @brief 设备端坐标校验
+ * 
+ * 直接读取坐标的kernel（PILLAR/SORTED/INCREMENTAL模式和PFN融合入口）对每个条目调用Check：
+ * 填充条目（y、x均为PILLAR_PADDING_COORD）和batch/y/x越界的条目被跳过并分别计数，不再越界写出。
+ * params[0]因此可以是固定长度输入张量的长度（有效pillar数的上界），无需host侧裁剪。
+ * 结束时由Store把本核的诊断字写入workspace中本核的32字节槽位，由host汇总。
+ */
+class CoordValidator {
+public:
+    __aicore__ inline CoordValidator() {}
+    
+    __aicore__ inline void Init(const PillarScatterTilingData& tiling)
+    {
+        nx = tiling.nx;
+        ny = tiling.ny;
+        batch_size = tiling.batchSize;
+        cell_num = batch_size * ny * nx;
+    }
+    
+    /**
+     * @brief 合法时返回true；非法条目计入诊断字
+     */
+    __aicore__ inline bool Check(uint32_t batch, uint32_t y, uint32_t x)
+    {
+        if (batch < batch_size && y < ny && x < nx) {
+            valid++;
+            return true;
+        }
+        if (y == PILLAR_PADDING_COORD && x == PILLAR_PADDING_COORD) {
+            padding++;
+        } else {
+            out_of_range++;
+        }
+        return false;
+    }
+    
+    /**
+     * @brief 线性cell下标（SCATTER_COORD_LINEAR）的校验：PILLAR_PADDING_COORD为填充，其余不小于B*ny*nx的为越界
+     */
+    __aicore__ inline bool CheckCell(uint32_t cell)
+    {
+        if (cell < cell_num) {
+            valid++;
+            return true;
+        }
+        if (cell == PILLAR_PADDING_COORD) {
+            padding++;
+        } else {
+            out_of_range++;
+        }
+        return false;
+    }
+    
+    // 各核扫描同一批坐标时只保留一个核的计数，其余核调用Reset
+    __aicore__ inline void Reset()
+    {
+        valid = 0;
+        out_of_range = 0;
+        padding = 0;
+    }
+    
+    /**
+     * @brief 把本核的诊断字经diagLocal（至少PILLAR_SCATTER_DIAG_DIM个uint32）写入workspace
+     */
+    __aicore__ inline void Store(TPipe& pipe, LocalTensor<uint32_t> diagLocal, GM_ADDR workspace,
+                                 uint32_t diag_offset, int32_t block_idx)
+    {
+        uint32_t status = (out_of_range > 0 ? SCATTER_STATUS_OUT_OF_RANGE : 0) |
+                          (padding > 0 ? SCATTER_STATUS_PADDING : 0);
+        for (uint32_t i = 0; i < PILLAR_SCATTER_DIAG_DIM; i++) {
+            diagLocal.SetValue(i, 0);
+        }
+        diagLocal.SetValue(SCATTER_DIAG_STATUS, status);
+        diagLocal.SetValue(SCATTER_DIAG_VALID, valid);
+        diagLocal.SetValue(SCATTER_DIAG_OUT_OF_RANGE, out_of_range);
+        diagLocal.SetValue(SCATTER_DIAG_PADDING, padding);
+        event_t eventIdSToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::S_MTE3));
+        SetFlag<HardEvent::S_MTE3>(eventIdSToMte3);
+        WaitFlag<HardEvent::S_MTE3>(eventIdSToMte3);
+        GlobalTensor<uint32_t> diagGm;
+        diagGm.SetGlobalBuffer((__gm__ uint32_t*)workspace + diag_offset + block_idx * PILLAR_SCATTER_DIAG_DIM,
+                               PILLAR_SCATTER_DIAG_DIM);
+        DataCopy(diagGm, diagLocal, PILLAR_SCATTER_DIAG_DIM);
+    }
+
+private:
+    uint32_t nx = 0;
+    uint32_t ny = 0;
+    uint32_t batch_size = 0;
+    uint32_t cell_num = 0;  // B*ny*nx，host保证小于PILLAR_PADDING_COORD
+    uint32_t valid = 0;
+    uint32_t out_of_range = 0;
+    uint32_t padding = 0;
+};
+
+// 向上取整到align的倍数
+__aicore__ inline uint32_t AlignUp(uint32_t value, uint32_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+/**
+ * @brief 将一段uint32数据搬入UB并等待其可被标量读取（长度向上取整到32字节）
+ */
+__aicore__ inline void LoadScalars(TPipe& pipe, const LocalTensor<uint32_t>& dst, const GlobalTensor<uint32_t>& src,
+                                   uint32_t count)
+{
+    // 上一批数据的标量读取完成后才能覆盖
+    event_t eventIdSToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::S_MTE2));
+    SetFlag<HardEvent::S_MTE2>(eventIdSToMte2);
+    WaitFlag<HardEvent::S_MTE2>(eventIdSToMte2);
+    DataCopy(dst, src, AlignUp(count, COORD_ALIGN));
+    event_t eventIdMte2ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_S));
+    SetFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+    WaitFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+}
+
+/**
+ * @brief 将标量写好的一段uint32数据写回GM（长度向上取整到32字节，尾部由后续写入覆盖）
+ */
+__aicore__ inline void StoreScalars(TPipe& pipe, const GlobalTensor<uint32_t>& dst, const LocalTensor<uint32_t>& src,
+                                    uint32_t count)
+{
+    event_t eventIdSToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::S_MTE3));
+    SetFlag<HardEvent::S_MTE3>(eventIdSToMte3);
+    WaitFlag<HardEvent::S_MTE3>(eventIdSToMte3);
+    DataCopy(dst, src, AlignUp(count, COORD_ALIGN));
+}
+
+/**
+ * @brief 按阶段统计本核耗时和数据量的性能剖析器
+ * 
+ * 仅在定义PILLAR_SCATTER_PROFILE时生效：Mark把自上次Mark以来的cycle数计入指定阶段，
+ * Store把 [PILLAR_SCATTER_PROFILE_DIM] 个剖析字写入workspace中本核的槽位。
+ * 未定义时为接口全部为空的同名类，调用在编译期被消除，kernel不申请UB、不读cycle计数器。
+ */
+#ifdef PILLAR_SCATTER_PROFILE
+class KernelProfiler {
+public:
+    __aicore__ inline KernelProfiler() {}
+    
+    // kernel入口处调用，此后到第一次Mark的时间计入INIT
+    __aicore__ inline void Start()
+    {
+        for (uint32_t i = 0; i < PILLAR_SCATTER_PROFILE_DIM; i++) {
+            words[i] = 0;
+        }
+        last_cycle = GetSystemCycle();
+    }
+    
+    __aicore__ inline void Init(TPipe& pipe, const PillarScatterTilingData& tiling, GM_ADDR workspace)
+    {
+        pipe.InitBuffer(profileBuf, PILLAR_SCATTER_PROFILE_DIM * sizeof(uint32_t));
+        profile_gm = (__gm__ uint32_t*)workspace + tiling.profileOffset;
+    }
+    
+    __aicore__ inline void Mark(uint32_t phase)
+    {
+        int64_t now = GetSystemCycle();
+        words[phase] += static_cast<uint32_t>(now - last_cycle);
+        last_cycle = now;
+    }
+    
+    __aicore__ inline void Add(uint32_t field, uint32_t value)
+    {
+        words[field] += value;
+    }
+    
+    __aicore__ inline void Store(TPipe& pipe, int32_t block_idx)
+    {
+        words[SCATTER_PROFILE_MAGIC] = PILLAR_SCATTER_PROFILE_MAGIC;
+        LocalTensor<uint32_t> profileLocal = profileBuf.Get<uint32_t>();
+        // 本核之前的写出(MTE3)可能仍在使用同一事件，先等其完成再由标量填写
+        event_t eventIdMte3ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE3_S));
+        SetFlag<HardEvent::MTE3_S>(eventIdMte3ToS);
+        WaitFlag<HardEvent::MTE3_S>(eventIdMte3ToS);
+        for (uint32_t i = 0; i < PILLAR_SCATTER_PROFILE_DIM; i++) {
+            profileLocal.SetValue(i, words[i]);
+        }
+        event_t eventIdSToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::S_MTE3));
+        SetFlag<HardEvent::S_MTE3>(eventIdSToMte3);
+        WaitFlag<HardEvent::S_MTE3>(eventIdSToMte3);
+        GlobalTensor<uint32_t> profileGm;
+        profileGm.SetGlobalBuffer(profile_gm + block_idx * PILLAR_SCATTER_PROFILE_DIM, PILLAR_SCATTER_PROFILE_DIM);
+        DataCopy(profileGm, profileLocal, PILLAR_SCATTER_PROFILE_DIM);
+    }
+
+private:
+    TBuf<TPosition::VECCALC> profileBuf;
+    __gm__ uint32_t* profile_gm = nullptr;
+    int64_t last_cycle = 0;
+    uint32_t words[PILLAR_SCATTER_PROFILE_DIM];
+};
+#else
+class KernelProfiler {
+public:
+    __aicore__ inline KernelProfiler() {}
+    __aicore__ inline void Start() {}
+    __aicore__ inline void Init(TPipe& pipe, const PillarScatterTilingData& tiling, GM_ADDR workspace) {}
+    __aicore__ inline void Mark(uint32_t phase) {}
+    __aicore__ inline void Add(uint32_t field, uint32_t value) {}
+    __aicore__ inline void Store(TPipe& pipe, int32_t block_idx) {}
+};
+#endif
+
+/**
+ * @brief PillarScatter kernel
+ * 
+ * 输入输出类型相同时特征块经UB直通GM；int8输入时在UB中Cast为half并乘以逐通道scale后写出（反量化），
+ * 输入搬运量减半，且省去图中单独的反量化算子。
+ * 通道切分（tiling.channelSplit = G > 1）时核按 (pillar组, 通道片) 二维划分：同组的G个核读同一段坐标，
+ * 各自只搬运和写出 [channel_begin, channel_begin + channel_num) 这些通道，pillar很少时所有核仍有活干，
+ * 每行在UB中只占C/G个通道，同样的UB预算可容纳更多pillar。
+ * 坐标可为紧凑格式（tiling.coordFormat）：线性cell下标或打包的int16 (y, x)，每个pillar 4字节。
+ *
+ * @tparam TIn 输入特征类型（half/bfloat16_t/float/int8_t）
+ * @tparam TOut 输出特征类型，TIn为int8_t时为half，其余与TIn相同
+ * @tparam FIXED_C 编译期通道数；常用的32/64/128走编译期UB分块，
+ *                 为0时通道数和分块长度取自tiling（通用路径）
+ */
+template <typename TIn, typename TOut, int32_t FIXED_C>
 class KernelPillarScatter {
+    static constexpr bool DEQUANT = !IsSameType<TIn, TOut>::value;
+    
 public:
     __aicore__ inline KernelPillarScatter() {}
     
@@ -21,122 +263,440 @@ public:
      * @brief 算子初始化函数
      * 
      * 核心功能：
-     * 1. 解析输入参数，获取pillar总数
+     * 1. 解析输入参数和tiling，获取pillar总数、网格大小和通道数
      * 2. 计算当前AI Core的数据分片范围
      * 3. 设置全局内存缓冲区指针
      * 4. 初始化本地内存队列（双缓冲）
      * 5. 处理内存对齐和边界安全问题
      * 
      * @param pillar_features 输入的pillar特征数据
-     *        - 数据格式: [num_pillars, PILLAR_FEATURE_SIZE] 
-     *        - 数据类型: half (float16)
-     *        - 物理含义: 每个pillar经过PointNet处理后的64维特征向量
-     * 
-     * @param coords 坐标信息数据
-     *        - 数据格式: [num_pillars, 4]
-     *        - 数据类型: uint32_t
-     *        - coords[:, 0]: batch索引（通常为0，单batch处理）
-     *        - coords[:, 1]: pillar在BEV网格中的x坐标 (0 ~ FEATURE_X-1)
-     *        - coords[:, 2]: pillar在BEV网格中的y坐标 (0 ~ FEATURE_Y-1)  
-     *        - coords[:, 3]: 保留字段（未使用）
+     *        - 数据格式: [num_pillars, C] 
+     *        - 数据类型: TIn
+     *        - 物理含义: 每个pillar经过PointNet处理后的C维特征向量
+     * 
+     * @param coords 坐标信息数据，格式由tiling.coordFormat决定
+     *        - SCATTER_COORD_BYXR: [num_pillars, 4] uint32_t
+     *          - coords[:, 0]: batch索引 (0 ~ B-1)，多帧拼接时为帧序号
+     *          - coords[:, 1]: pillar在BEV网格中的y坐标 (0 ~ ny-1)
+     *          - coords[:, 2]: pillar在BEV网格中的x坐标 (0 ~ nx-1)
+     *          - coords[:, 3]: 保留字段（未使用）
+     *        - SCATTER_COORD_LINEAR: [num_pillars] uint32_t，体素化给出的输出cell下标 b*ny*nx + y*nx + x，
+     *          直接作为输出位置，省去逐pillar的下标计算
+     *        - SCATTER_COORD_YX16: [num_pillars] 打包的uint16_t (y, x)，batch为0
+     *        - 紧凑格式每个pillar只有4字节，坐标搬运量为BYXR的1/4
      * 
      * @param params 算子参数
-     *        - params[0]: 有效pillar的总数量 (uint32_t)
-     *        - 用于动态确定处理规模，支持不同大小的输入
+     *        - params[0]: 输入条目数 (uint32_t)，可以是含填充条目的固定长度张量的长度
+     *        - 填充和越界条目由CoordValidator跳过，不必由host裁剪
+     * 
+     * @param tiling host侧计算的tiling数据，已由CopyTiling拷贝到栈上
+     * 
+     * @param workspace 辅助GM缓冲区
+     *        - DYNAMIC调度：counterOffset处为各核共享的块计数器
+     *        - REGION调度：regionOffset处为host按整行切分的各核pillar起始表
+     *        - int8输入：scaleOffset处为逐通道反量化scale [C] half
+     *        - diagOffset处为各核的坐标校验诊断字
      * 
      * @param spatial_features 输出的BEV特征图
-     *        - 数据格式: [1, FEATURE_Y, FEATURE_X, PILLAR_FEATURE_SIZE] (NHWC)
-     *        - 数据类型: half (float16)
-     *        - 物理含义: 720x720的BEV网格，每个位置存储64维特征
+     *        - 数据格式: [B, ny, nx, C] (NHWC)
+     *        - 数据类型: TOut
      *        - 初始状态: 全零，只有有pillar的位置会被填充
      */
-    __aicore__ inline void Init(GM_ADDR pillar_features, GM_ADDR coords, 
-                                GM_ADDR params, GM_ADDR spatial_features)
+    __aicore__ inline void Init(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                GM_ADDR spatial_features)
     {
         // ==================== 1. 获取当前AI Core信息 ====================
+        profiler.Start();
         int32_t current_block_idx = GetBlockIdx();
+        int32_t block_num = GetBlockNum();
         
         // ==================== 2. 解析输入参数 ====================
         uint32_t total_pillars = *((__gm__ uint32_t*)params);
         this->total_pillars = total_pillars;  // 保存为成员变量，供其他函数使用
+        feature_size = (FIXED_C > 0) ? FIXED_C : tiling.featureSize;
+        tile_length = (FIXED_C > 0) ? PILLAR_SCATTER_TILE_BYTES / (FIXED_C * sizeof(TOut)) : tiling.tileLength;
+        nx = tiling.nx;
+        ny = tiling.ny;
+        batch_size = tiling.batchSize;
+        validator.Init(tiling);
+        diag_offset = tiling.diagOffset;
+        diag_workspace = workspace;
+        coord_format = tiling.coordFormat;
+        coord_dim = (coord_format == SCATTER_COORD_BYXR) ? COORD_DIM : 1;
+        // SORTED模式下pillar已由host按cell排序，相邻cell连续的pillar合并为一次DataCopy
+        coalesce_runs = (tiling.scatterMode == SCATTER_MODE_SORTED);
         
-        // ==================== 4. 数据分片计算 ====================
-        int32_t pillars_per_core = (total_pillars + USE_CORE_NUM - 1) / USE_CORE_NUM;
+        // ==================== 3. 数据分片计算 ====================
+        // host侧的分片只有在与实际launch的核数、pillar数一致时才可信，否则按同样规则现算（不做通道切分）
+        // SORTED模式下按下标连续切分即让每个核负责一段连续的输出地址
+        bool tiling_valid = tiling.coreNum == static_cast<uint32_t>(block_num) && tiling.totalPillars == total_pillars;
+        uint32_t former_num = tiling.formerNum;
+        uint32_t former_length = tiling.formerLength;
+        uint32_t tail_length = tiling.tailLength;
+        if (!tiling_valid) {
+            tail_length = total_pillars / block_num;
+            former_num = total_pillars % block_num;
+            former_length = tail_length + 1;
+        }
         
-        // 计算当前Core的数据范围 [pillar_start_idx, pillar_end_idx)
-        pillar_start_idx = current_block_idx * pillars_per_core;
-        pillar_end_idx = Min(pillar_start_idx + pillars_per_core, total_pillars);
-        num_pillars_to_process = pillar_end_idx - pillar_start_idx;
+        // 通道切分：第k核属于第 k/G 个pillar组，处理第 k%G 片通道
+        channel_split = 1;
+        channel_begin = 0;
+        channel_num = feature_size;
+        if (tiling_valid && tiling.channelSplit > 1 && tiling.scheduleMode == SCATTER_SCHEDULE_STATIC) {
+            channel_split = tiling.channelSplit;
+            channel_num = tiling.channelSlice;
+            channel_begin = (current_block_idx % channel_split) * channel_num;
+            tile_length = PILLAR_SCATTER_TILE_BYTES / (channel_num * sizeof(TOut));
+        }
+        int32_t part_idx = current_block_idx / static_cast<int32_t>(channel_split);
         
-        // ==================== 5. 全局内存缓冲区设置 ====================
-        // 5.1 设置pillar特征数据缓冲区
-        // 每个Core只需要访问自己负责的pillar特征
-        // 指针偏移 = pillar_start_idx * PILLAR_FEATURE_SIZE
-        pillarFeaturesGm.SetGlobalBuffer((__gm__ half*)pillar_features + pillar_start_idx * PILLAR_FEATURE_SIZE, 
-                                         num_pillars_to_process * PILLAR_FEATURE_SIZE);
+        // 计算当前Core的数据范围 [pillar_start_idx, pillar_end_idx)
+        if (part_idx < static_cast<int32_t>(former_num)) {
+            pillar_start_idx = part_idx * former_length;
+            num_pillars_to_process = former_length;
+        } else {
+            pillar_start_idx = former_num * former_length + (part_idx - former_num) * tail_length;
+            num_pillars_to_process = tail_length;
+        }
         
-        // 5.2 设置坐标数据缓冲区（简化版）
-        // 每次读取4个uint32_t（1个pillar的坐标），无需复杂的对齐计算
-        int32_t coords_buffer_size = num_pillars_to_process * 4 + 8 ;  // 恰好需要的坐标数量 +8防止溢出
+        // REGION调度：按host给出的整行边界切分，同一行（含重复cell）只由一个核写出
+        schedule_mode = tiling.scheduleMode;
+        if (schedule_mode == SCATTER_SCHEDULE_REGION && tiling_valid) {
+            __gm__ uint32_t* region = (__gm__ uint32_t*)workspace + tiling.regionOffset;
+            pillar_start_idx = region[current_block_idx];
+            num_pillars_to_process = region[current_block_idx + 1] - pillar_start_idx;
+        } else if (schedule_mode == SCATTER_SCHEDULE_REGION) {
+            schedule_mode = SCATTER_SCHEDULE_STATIC;
+        }
+        pillar_end_idx = pillar_start_idx + num_pillars_to_process;
         
+        // DYNAMIC调度：pillar按chunk_length切块，各核运行时领取
+        block_idx = current_block_idx;
+        this->block_num = block_num;
+        chunk_length = (tiling.chunkLength > 0) ? tiling.chunkLength : tile_length;
+        chunk_num = (total_pillars + chunk_length - 1) / chunk_length;
+        chunkCounter = (__gm__ uint32_t*)workspace + tiling.counterOffset;
         
-        coordsGm.SetGlobalBuffer((__gm__ uint32_t*)coords + pillar_start_idx * 4, coords_buffer_size);
+        // ==================== 4. 全局内存缓冲区设置 ====================
+        // 4.1 设置pillar特征数据缓冲区
+        // DYNAMIC调度下各核可能领取任意位置的pillar块，统一以全部pillar为基址
+        pillarFeaturesGm.SetGlobalBuffer((__gm__ TIn*)pillar_features, total_pillars * feature_size);
         
-        // 保存缓冲区大小，供CopyIn函数使用
-        // this->coords_buffer_size = coords_buffer_size;
+        // 4.2 设置坐标数据缓冲区
+        // 按块搬运时坐标长度向上取整到32字节，最后一块最多多读7个uint32_t（BYXR格式为4个），
+        // 由host侧在coords末尾预留的8个uint32_t兜底
+        coordsGm.SetGlobalBuffer((__gm__ uint32_t*)coords, total_pillars * coord_dim + COORD_ALIGN);
         
-        // 5.3 设置输出特征图缓冲区
+        // 4.3 设置输出特征图缓冲区
         // 所有Core共享同一个输出缓冲区，但写入不同位置（无冲突）
-        // NHWC格式: [1, 720, 720, 64]，同一位置的64个通道连续存储
-        spatialFeaturesGm.SetGlobalBuffer((__gm__ half*)spatial_features, 1 * FEATURE_Y * FEATURE_X * PILLAR_FEATURE_SIZE);
+        // NHWC格式: [B, ny, nx, C]，同一位置的C个通道连续存储
+        spatialFeaturesGm.SetGlobalBuffer((__gm__ TOut*)spatial_features,
+                                          static_cast<uint64_t>(batch_size) * ny * nx * feature_size);
+        
+        // ==================== 5. 本地内存队列初始化 ====================
+        if constexpr (DEQUANT) {
+            // 反量化：原始int8块搬入rawQueue，Cast+Mul后的half块经featureQueue写出
+            pipe.InitBuffer(rawQueue, BUFFER_NUM, tile_length * channel_num * sizeof(TIn));
+            pipe.InitBuffer(outQueue, BUFFER_NUM, tile_length * channel_num * sizeof(TOut));
+            InitScale((__gm__ TOut*)workspace + tiling.scaleOffset * (sizeof(uint32_t) / sizeof(TOut)));
+        } else {
+            // 特征块经UB直通GM，使用VECIN->VECOUT绑定队列，省去一次UB内拷贝
+            pipe.InitBuffer(featureQueue, BUFFER_NUM, tile_length * channel_num * sizeof(TIn));
+        }
+        pipe.InitBuffer(coordsQueue, BUFFER_NUM, AlignUp(tile_length * coord_dim, COORD_ALIGN) * sizeof(uint32_t));
+        // 每块合法pillar压缩后的输出cell索引和块内下标，由Compute写入、CopyOut读取
+        pipe.InitBuffer(offsetBuf, AlignUp(tile_length, COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(sourceBuf, AlignUp(tile_length, COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(diagBuf, PILLAR_SCATTER_DIAG_DIM * sizeof(uint32_t));
+        profiler.Init(pipe, tiling, workspace);
+        profiler.Mark(SCATTER_PROFILE_INIT);
     }
     
+    /**
+     * @brief 主处理流程
+     * 
+     * STATIC/REGION调度处理Init中确定的连续范围；DYNAMIC调度循环领取pillar块直到领完。
+     * 最后写出本核的坐标校验诊断字；通道切分时同组各核校验同一批坐标，只保留第0片的计数。
+     */
     __aicore__ inline void Process()
     {
-        int32_t current_core_id = GetBlockIdx();
-        
-        for (int32_t i = 0; i < num_pillars_to_process; i++) {
-            Compute(i);  // 计算处理：坐标验证 + 特征写入
+        if (schedule_mode != SCATTER_SCHEDULE_DYNAMIC) {
+            ProcessRange(pillar_start_idx, num_pillars_to_process);
+        } else {
+            for (uint32_t chunk = ClaimChunk(0); chunk < chunk_num; chunk = ClaimChunk(chunk)) {
+                uint32_t start = chunk * chunk_length;
+                uint32_t length = (start + chunk_length <= total_pillars) ? chunk_length : total_pillars - start;
+                ProcessRange(start, length);
+            }
         }
+        if (channel_begin != 0) {
+            validator.Reset();
+        }
+        validator.Store(pipe, diagBuf.Get<uint32_t>(), diag_workspace, diag_offset, block_idx);
+        profiler.Mark(SCATTER_PROFILE_TAIL);
+        profiler.Store(pipe, block_idx);
     }
 
 private:
-    __aicore__ inline void Compute(int32_t progress)
+    /**
+     * @brief 处理 [start, start+count) 范围内的pillar
+     * 
+     * 按tile_length分块执行 CopyIn -> Compute -> CopyOut。
+     * 双缓冲下第i+1块的MTE2搬入与第i块的MTE3写出重叠执行。
+     */
+    __aicore__ inline void ProcessRange(uint32_t start, uint32_t count)
+    {
+        for (uint32_t offset = 0; offset < count; offset += tile_length) {
+            int32_t length = (offset + tile_length <= count) ? tile_length : count - offset;
+            CopyIn(start + offset, length);        // 整块搬入特征和坐标
+            int32_t valid = Compute(length);       // 坐标校验，压缩出合法pillar的输出偏移（int8输入时同时反量化）
+            CopyOut(length, valid);                // 逐行DataCopy写入BEV特征图
+            profiler.Add(SCATTER_PROFILE_TILES, 1);
+            profiler.Add(SCATTER_PROFILE_ENTRIES, length);
+            profiler.Add(SCATTER_PROFILE_WRITTEN, valid);
+            profiler.Add(SCATTER_PROFILE_SKIPPED, length - valid);
+            profiler.Add(SCATTER_PROFILE_BYTES_IN, length * (channel_num * sizeof(TIn) + coord_dim * sizeof(uint32_t)));
+            profiler.Add(SCATTER_PROFILE_BYTES_OUT, valid * channel_num * sizeof(TOut));
+        }
+    }
+    
+    /**
+     * @brief int8输入：把本核通道片的scale平铺成tile_length份，Compute中一次Mul完成整块反量化
+     */
+    __aicore__ inline void InitScale(__gm__ TOut* scale)
+    {
+        pipe.InitBuffer(scaleBuf, tile_length * channel_num * sizeof(TOut));
+        LocalTensor<TOut> scaleLocal = scaleBuf.Get<TOut>();
+        GlobalTensor<TOut> scaleGm;
+        scaleGm.SetGlobalBuffer(scale, feature_size);
+        for (uint32_t i = 0; i < tile_length; i++) {
+            DataCopy(scaleLocal[i * channel_num], scaleGm[channel_begin], channel_num);
+        }
+        event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+        SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+    }
+    
+    /**
+     * @brief DYNAMIC调度：领取下一个pillar块
+     * 
+     * 支持标量GM原子操作的芯片(__CCE_AICORE__ >= 220)上从共享计数器领取，先做完的核继续领取；
+     * 其余芯片退化为按核号交错的细粒度块分配（第i核处理第 i, i+block_num, ... 块）。
+     * 
+     * @param prev 上一次领取的块号（首次领取时忽略）
+     */
+    __aicore__ inline uint32_t ClaimChunk(uint32_t prev)
+    {
+#if defined(__CCE_AICORE__) && (__CCE_AICORE__ >= 220)
+        (void)prev;
+        return AtomicAdd(chunkCounter, static_cast<uint32_t>(1));
+#else
+        return (claimed++ == 0) ? static_cast<uint32_t>(block_idx) : prev + block_num;
+#endif
+    }
+    
+    /**
+     * @brief 将一块pillar的特征和坐标从GM搬入UB
+     * 
+     * 特征和坐标各一次DataCopy；坐标为每个pillar coord_dim个uint32，长度向上取整到32字节。
+     * 通道切分时特征为一次跨步DataCopy：每行取本核的channel_num个通道，跳过其余通道，在UB中紧密排列。
+     * 
+     * @param start 本块首个pillar的全局下标
+     */
+    __aicore__ inline void CopyIn(uint32_t start, int32_t length)
+    {
+        LocalTensor<TIn> featureLocal = DEQUANT ? rawQueue.AllocTensor<TIn>()
+                                                : featureQueue.AllocTensor<TIn>();
+        LocalTensor<uint32_t> coordsLocal = coordsQueue.AllocTensor<uint32_t>();
+        
+        uint64_t feature_offset = static_cast<uint64_t>(start) * feature_size + channel_begin;
+        if (channel_split > 1) {
+            DataCopyParams params(static_cast<uint16_t>(length),
+                                  static_cast<uint16_t>(channel_num * sizeof(TIn) / BLOCK_BYTES),
+                                  static_cast<uint16_t>((feature_size - channel_num) * sizeof(TIn) / BLOCK_BYTES), 0);
+            DataCopy(featureLocal, pillarFeaturesGm[feature_offset], params);
+        } else {
+            DataCopy(featureLocal, pillarFeaturesGm[feature_offset], length * feature_size);
+        }
+        DataCopy(coordsLocal, coordsGm[static_cast<uint64_t>(start) * coord_dim],
+                 AlignUp(length * coord_dim, COORD_ALIGN));
+        
+        if constexpr (DEQUANT) {
+            rawQueue.EnQue(featureLocal);
+        } else {
+            featureQueue.EnQue(featureLocal);
+        }
+        coordsQueue.EnQue(coordsLocal);
+    }
+    
+    /**
+     * @brief 解析一块坐标，校验后把合法pillar压缩为连续列表
+     * 
+     * 第k个合法pillar的输出cell和块内下标写入offsetBuf/sourceBuf的第k项，
+     * k为块内合法标记的前缀和，CopyOut只需遍历前valid项。
+     * 
+     * @return 本块合法pillar数
+     */
+    __aicore__ inline int32_t Compute(int32_t length)
     {
-        // ==================== 1. 获取本地数据 ====================
-        int32_t current_offset = progress * 4;
+        LocalTensor<uint32_t> coordsLocal = coordsQueue.DeQue<uint32_t>();
+        LocalTensor<uint32_t> offsetLocal = offsetBuf.Get<uint32_t>();
+        LocalTensor<uint32_t> sourceLocal = sourceBuf.Get<uint32_t>();
         
-        // ==================== 2. 解析坐标信息 ====================
-        uint32_t batch = coordsGm.GetValue(current_offset + 0);  // batch索引（通常为0）
-        uint32_t x = coordsGm.GetValue(current_offset + 2);      // BEV网格x坐标 [0, FEATURE_X-1] (修复：原来是GetValue(1))
-        uint32_t y = coordsGm.GetValue(current_offset + 1);      // BEV网格y坐标 [0, FEATURE_Y-1] (修复：原来是GetValue(2))
-        // coordsLocal.GetValue(3) 是保留字段，未使用
+        // 坐标由标量单元读取，需要等待MTE2搬运完成
+        event_t eventIdMte2ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_S));
+        SetFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        WaitFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        profiler.Mark(SCATTER_PROFILE_COPY_IN);
+        
+        int32_t valid = 0;
+        for (int32_t i = 0; i < length; i++) {
+            // ==================== 1~3. 解析、校验坐标并得到输出cell ====================
+            uint32_t cell;
+            if (!DecodeCell(coordsLocal, i, cell)) {
+                continue;
+            }
+            offsetLocal.SetValue(valid, cell);
+            sourceLocal.SetValue(valid, i);
+            valid++;
+        }
+        
+        coordsQueue.FreeTensor(coordsLocal);
+        
+        // ==================== 4. int8反量化 ====================
+        // out = half(in) * scale，scale已按通道平铺，整块一次Cast+Mul
+        if constexpr (DEQUANT) {
+            LocalTensor<TIn> rawLocal = rawQueue.DeQue<TIn>();
+            LocalTensor<TOut> outLocal = outQueue.AllocTensor<TOut>();
+            LocalTensor<TOut> scaleLocal = scaleBuf.Get<TOut>();
+            Cast(outLocal, rawLocal, RoundMode::CAST_NONE, length * channel_num);
+            Mul(outLocal, outLocal, scaleLocal, length * channel_num);
+            outQueue.EnQue(outLocal);
+            rawQueue.FreeTensor(rawLocal);
+        }
+        return valid;
+    }
+    
+    /**
+     * @brief 解析块内第i个坐标，合法时给出NHWC输出的cell索引（CopyOut中再乘以C得到元素偏移）
+     * 
+     * 格式在整个launch内不变，分支对每个pillar走同一路径。
+     * 
+     * @return 坐标合法时返回true；填充和越界条目计入诊断字后返回false
+     */
+    __aicore__ inline bool DecodeCell(const LocalTensor<uint32_t>& coordsLocal, int32_t i, uint32_t& cell)
+    {
+        if (coord_format == SCATTER_COORD_LINEAR) {
+            // 体素化已算好的cell下标，只需与B*ny*nx比较
+            cell = coordsLocal.GetValue(i);
+            return validator.CheckCell(cell);
+        }
+        uint32_t batch = 0;
+        uint32_t y;
+        uint32_t x;
+        if (coord_format == SCATTER_COORD_YX16) {
+            // 低16位为y、高16位为x；两半均为0xFFFF即整字为PILLAR_PADDING_COORD时按填充计数
+            uint32_t packed = coordsLocal.GetValue(i);
+            y = (packed == PILLAR_PADDING_COORD) ? PILLAR_PADDING_COORD : (packed & 0xFFFF);
+            x = (packed == PILLAR_PADDING_COORD) ? PILLAR_PADDING_COORD : (packed >> 16);
+        } else {
+            batch = coordsLocal.GetValue(i * COORD_DIM + 0);  // batch索引 [0, B-1]
+            y = coordsLocal.GetValue(i * COORD_DIM + 1);      // BEV网格y坐标 [0, ny-1]
+            x = coordsLocal.GetValue(i * COORD_DIM + 2);      // BEV网格x坐标 [0, nx-1]
+            // coordsLocal.GetValue(3) 是保留字段，未使用
+        }
+        if (!validator.Check(batch, y, x)) {
+            return false;
+        }
+        // NHWC格式：[Batch, Height, Width, Channel]，cell索引为 batch * H * W + y * W + x
+        cell = (batch * ny + y) * nx + x;
+        return true;
+    }
+    
+    /**
+     * @brief 将一块中的合法pillar特征逐行写入BEV特征图
+     * 
+     * 每个pillar的C个通道连续存储（C=64时为128字节），一次DataCopy完成；通道切分时写出本核的通道片。
+     * SORTED模式下cell索引和块内下标都连续递增的一串pillar在UB和输出中都连续，合并为一次DataCopy
+     * （通道切分时为一次跨步DataCopy，输出中相邻cell的通道片相隔C-channel_num个通道）。
+     */
+    __aicore__ inline void CopyOut(int32_t length, int32_t valid)
+    {
+        (void)length;
+        LocalTensor<TOut> featureLocal = DEQUANT ? outQueue.DeQue<TOut>()
+                                                 : featureQueue.DeQue<TOut>();
+        LocalTensor<uint32_t> offsetLocal = offsetBuf.Get<uint32_t>();
+        LocalTensor<uint32_t> sourceLocal = sourceBuf.Get<uint32_t>();
         
-        // ==================== 6. 计算NHWC格式的输出位置 ====================
-        // NHWC格式：[Batch, Height, Width, Channel]
-        // 对于位置(x,y)，64个通道的特征值连续存储
-        // offset公式：batch * H * W * C + y * W * C + x * C
-        uint32_t base_offset = y * FEATURE_X * PILLAR_FEATURE_SIZE + x * PILLAR_FEATURE_SIZE;
+        if (coalesce_runs && valid > 0) {
+            int32_t run_start = 0;
+            uint32_t run_cell = offsetLocal.GetValue(0);
+            uint32_t run_source = sourceLocal.GetValue(0);
+            for (int32_t k = 1; k <= valid; k++) {
+                uint32_t cell = (k < valid) ? offsetLocal.GetValue(k) : 0;
+                uint32_t source = (k < valid) ? sourceLocal.GetValue(k) : 0;
+                uint32_t run_length = k - run_start;
+                if (k < valid && cell == run_cell + run_length && source == run_source + run_length) {
+                    continue;
+                }
+                // 同一cell的重复pillar相邻且不连续，各自单独写出，保持原始顺序
+                uint64_t offset = static_cast<uint64_t>(run_cell) * feature_size + channel_begin;
+                if (channel_split > 1) {
+                    DataCopyParams params(static_cast<uint16_t>(run_length),
+                                          static_cast<uint16_t>(channel_num * sizeof(TOut) / BLOCK_BYTES), 0,
+                                          static_cast<uint16_t>((feature_size - channel_num) * sizeof(TOut) /
+                                                                BLOCK_BYTES));
+                    DataCopy(spatialFeaturesGm[offset], featureLocal[run_source * channel_num], params);
+                } else {
+                    DataCopy(spatialFeaturesGm[offset], featureLocal[run_source * feature_size],
+                             run_length * feature_size);
+                }
+                run_start = k;
+                run_cell = cell;
+                run_source = source;
+            }
+            FreeOutput(featureLocal);
+            profiler.Mark(SCATTER_PROFILE_SCATTER);
+            return;
+        }
         
-        for (int32_t i = 0; i < PILLAR_FEATURE_SIZE; i++) {
-            spatialFeaturesGm.SetValue(base_offset + i, pillarFeaturesGm.GetValue(progress * PILLAR_FEATURE_SIZE + i));
+        for (int32_t k = 0; k < valid; k++) {
+            uint64_t offset = static_cast<uint64_t>(offsetLocal.GetValue(k)) * feature_size + channel_begin;
+            DataCopy(spatialFeaturesGm[offset], featureLocal[sourceLocal.GetValue(k) * channel_num], channel_num);
         }
+        
+        FreeOutput(featureLocal);
+        profiler.Mark(SCATTER_PROFILE_SCATTER);
     }
     
-    __aicore__ inline int32_t Min(int32_t a, int32_t b)
+    __aicore__ inline void FreeOutput(LocalTensor<TOut>& featureLocal)
     {
-        return (a < b) ? a : b;
+        if constexpr (DEQUANT) {
+            outQueue.FreeTensor(featureLocal);
+        } else {
+            featureQueue.FreeTensor(featureLocal);
+        }
     }
 
 private:
     // ==================== 流水线和队列管理 ====================
     TPipe pipe;  // 流水线管理器，协调数据传输和计算
+    TQueBind<TPosition::VECIN, TPosition::VECOUT, BUFFER_NUM> featureQueue;  // 特征块队列（GM->UB->GM直通）
+    TQue<QuePosition::VECIN, BUFFER_NUM> rawQueue;                           // int8输入：原始特征块队列
+    TQue<QuePosition::VECOUT, BUFFER_NUM> outQueue;                          // int8输入：反量化后的特征块队列
+    TQue<QuePosition::VECIN, BUFFER_NUM> coordsQueue;                        // 坐标块队列
+    TBuf<TPosition::VECCALC> offsetBuf;                                      // 当前块合法pillar的输出cell索引
+    TBuf<TPosition::VECCALC> sourceBuf;                                      // 当前块合法pillar的块内下标
+    TBuf<TPosition::VECCALC> scaleBuf;                                       // int8输入：平铺的逐通道scale
+    TBuf<TPosition::VECCALC> diagBuf;                                        // 诊断字写出缓冲
     
     // ==================== 全局内存访问张量 ====================
     // 这些张量管理对全局内存的访问，提供了类型安全和边界检查
-    GlobalTensor<half> pillarFeaturesGm;      // pillar特征数据全局内存访问器
+    GlobalTensor<TIn> pillarFeaturesGm;       // pillar特征数据全局内存访问器
     GlobalTensor<uint32_t> coordsGm;          // 坐标数据全局内存访问器  
-    GlobalTensor<half> spatialFeaturesGm;     // 输出特征图全局内存访问器
+    GlobalTensor<TOut> spatialFeaturesGm;     // 输出特征图全局内存访问器
     
     // ==================== 数据分片和处理参数 ====================
     // 当前AI Core的数据处理范围和相关信息
@@ -145,26 +705,1885 @@ private:
     int32_t num_pillars_to_process;  // 当前Core需要处理的pillar总数
     uint32_t total_pillars;          // 全局pillar总数（所有Core共享）
     
-    // ==================== 内存管理和对齐参数 ====================
-    // int32_t coords_buffer_size;      // 坐标缓冲区的实际大小（uint32_t个数）
+    // ==================== 调度参数 ====================
+    uint32_t schedule_mode;          // pillar分配方式（PillarScatterSchedule）
+    int32_t block_idx;               // 当前Core编号
+    uint32_t block_num;              // 实际launch的核数
+    uint32_t chunk_length;           // DYNAMIC调度每块pillar数
+    uint32_t chunk_num;              // DYNAMIC调度总块数
+    uint32_t claimed = 0;            // 已领取的块数（交错分配时使用）
+    __gm__ uint32_t* chunkCounter;   // DYNAMIC调度的共享块计数器
+    
+    // ==================== 网格和分块参数（来自tiling） ====================
+    uint32_t nx;                     // BEV特征图宽度
+    uint32_t ny;                     // BEV特征图高度
+    uint32_t batch_size;             // 输出batch数
+    uint32_t feature_size;           // 每个pillar的特征维度 C
+    uint32_t tile_length;            // 每块pillar数
+    bool coalesce_runs;              // 是否合并cell连续的pillar写出（SORTED模式）
+    uint32_t coord_format;           // 坐标格式（PillarScatterCoordFormat）
+    uint32_t coord_dim;              // 每个pillar的坐标uint32个数：BYXR为4，紧凑格式为1
+    
+    // ==================== 通道切分 ====================
+    uint32_t channel_split;          // 通道切分份数 G，1表示不切分
+    uint32_t channel_begin;          // 本核处理的首个通道
+    uint32_t channel_num;            // 本核处理的通道数，也是UB中每行的长度
+    
+    // ==================== 坐标校验 ====================
+    CoordValidator validator;        // 跳过填充/越界条目并计数
+    uint32_t diag_offset;            // workspace中诊断字的偏移
+    GM_ADDR diag_workspace;          // workspace基址
+    KernelProfiler profiler;         // 性能剖析（PILLAR_SCATTER_PROFILE）
 };
 
-extern "C" __global__ __aicore__ void pillar_scatter_custom(GM_ADDR pillar_features, 
-                                                            GM_ADDR coords, 
-                                                            GM_ADDR params, 
-                                                            GM_ADDR spatial_features)
+/**
+ * @brief UB内把 [cells, C] 的NHWC段转置为 [C, cells] 的通道平面，cells和C均为16的倍数
+ * 
+ * 每次TransDataTo5HD转置16个cell x 16个通道：16个源地址为各cell行内同一组通道，
+ * 16个目的地址为各通道平面内同一组cell；按通道块重复，源前进1个32字节块，目的前进16个通道平面即cells个块。
+ */
+__aicore__ inline void TransposeToPlanes(const LocalTensor<half>& dst, const LocalTensor<half>& src, uint32_t cells,
+                                         uint32_t feature_size)
 {
-    KernelPillarScatter op;
-    op.Init(pillar_features, coords, params, spatial_features);  // 初始化和数据分片
-    op.Process();  // 执行主要的scatter操作
+    uint8_t channel_blocks = static_cast<uint8_t>(feature_size / TRANS_BLOCK);
+    // 只重复一次时步长无意义，按接口要求置0
+    uint16_t dst_stride = channel_blocks > 1 ? static_cast<uint16_t>(cells) : 0;
+    uint16_t src_stride = channel_blocks > 1 ? 1 : 0;
+    TransDataTo5HDParams params(false, false, channel_blocks, dst_stride, src_stride);
+    LocalTensor<half> srcList[NCHW_CONV_ADDR_LIST_SIZE];
+    LocalTensor<half> dstList[NCHW_CONV_ADDR_LIST_SIZE];
+    for (uint32_t cell = 0; cell < cells; cell += TRANS_BLOCK) {
+        for (int32_t i = 0; i < TRANS_BLOCK; i++) {
+            srcList[i] = src[(cell + i) * feature_size];
+            dstList[i] = dst[i * cells + cell];
+        }
+        TransDataTo5HD<half>(dstList, srcList, params);
+    }
 }
 
-#ifndef ASCENDC_CPU_DEBUG
-void pillar_scatter_do(uint32_t blockDim, void *stream, GM_ADDR pillar_features, 
-                                                            GM_ADDR coords, 
-                                                            GM_ADDR params, 
-                                                            GM_ADDR spatial_features)
+/**
+ * @brief 把 [C, cells] 的通道平面写到NCHW输出，每个通道写一段连续的cells个half
+ * 
+ * offset为第0个通道平面内首个cell的位置；平面间距可用32字节块表示时一条跨步DataCopy写完全部通道。
+ */
+__aicore__ inline void WritePlanes(const GlobalTensor<half>& outGm, const LocalTensor<half>& planeLocal,
+                                   uint64_t offset, uint64_t plane_size, uint32_t cells, uint32_t feature_size)
+{
+    uint64_t gap_blocks = (plane_size - cells) / TRANS_BLOCK;
+    if (gap_blocks <= UINT16_MAX) {
+        DataCopyParams params(static_cast<uint16_t>(feature_size), static_cast<uint16_t>(cells / TRANS_BLOCK), 0,
+                              static_cast<uint16_t>(gap_blocks));
+        DataCopy(outGm[offset], planeLocal, params);
+        return;
+    }
+    for (uint32_t c = 0; c < feature_size; c++) {
+        DataCopy(outGm[offset + c * plane_size], planeLocal[c * cells], cells);
+    }
+}
+
+/**
+ * @brief 输出驻留(BAND)模式的PillarScatter kernel
+ * 
+ * 每个AI Core负责连续的一段BEV行（跨batch按 b*ny+y 编号），
+ * 每行按UB容量切成若干段：段内先用Duplicate清零，再把落在该段的pillar特征
+ * 直接从GM搬到段内对应位置，最后整段连续写回GM。
+ * 输出的每个字节恰好写一次，host侧无需预先清零输出。
+ * 
+ * 落在每行的pillar由host侧按行分桶（计数排序）给出：
+ *   - rowStart[B*ny+1]: 第r行的条目范围为 [rowStart[r], rowStart[r+1])
+ *   - bins[N, 2]: 条目 [pillar下标, x]，同一行内保持pillar原始顺序
+ * 同一cell的重复pillar按原始顺序依次写入UB，结果确定（最后一个生效）。
+ * 
+ * 每行只由一个核处理，重复pillar也可在UB中按原始顺序归约（tiling.reduceMode）：
+ * 每段维护一个cell计数，cell的首个pillar直接搬入段内，其余pillar搬入暂存区后
+ * 与段内已有值做Add/Max；MEAN模式在段写出前对计数大于1的cell乘以1/count。
+ * 归约顺序固定，结果逐次运行可复现，无需GM原子操作。
+ * 
+ * NCHW输出（tiling.outputLayout）：段长取16的倍数，构造好的段在UB内转置为 [C, cells] 的通道平面，
+ * 再按通道写出连续的W方向片段，省去scatter之后对整张特征图的单独转置。
+ * 
+ * @tparam FIXED_C 编译期通道数，为0时取自tiling
+ */
+template <int32_t FIXED_C>
+class KernelPillarScatterBand {
+public:
+    __aicore__ inline KernelPillarScatterBand() {}
+    
+    /**
+     * @brief 初始化：按行均分输出，设置GM缓冲区和UB队列
+     * 
+     * 参数含义同KernelPillarScatter::Init；coords不使用，
+     * workspace中存放host侧生成的行起始表和行分桶条目。
+     */
+    __aicore__ inline void Init(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                GM_ADDR spatial_features)
+    {
+        // ==================== 1. 解析tiling ====================
+        profiler.Start();
+        int32_t current_block_idx = GetBlockIdx();
+        int32_t block_num = GetBlockNum();
+        block_idx = current_block_idx;
+        feature_size = (FIXED_C > 0) ? FIXED_C : tiling.featureSize;
+        segment_length = (FIXED_C > 0) ? PILLAR_SCATTER_TILE_BYTES / (FIXED_C * sizeof(half)) : tiling.tileLength;
+        nx = tiling.nx;
+        ny = tiling.ny;
+        row_num = tiling.batchSize * tiling.ny;
+        total_pillars = *((__gm__ uint32_t*)params);
+        reduce_mode = tiling.reduceMode;
+        output_layout = tiling.outputLayout;
+        if (output_layout == SCATTER_LAYOUT_NCHW) {
+            // UB转置以16个cell为单位
+            segment_length = segment_length / TRANS_BLOCK * TRANS_BLOCK;
+        }
+        
+        // ==================== 2. 按行分核 ====================
+        // 每行的写出量相同（nx*C），按行数均分即可均衡负载
+        uint32_t tail_rows = row_num / block_num;
+        uint32_t former_num = row_num % block_num;
+        if (current_block_idx < static_cast<int32_t>(former_num)) {
+            row_begin = current_block_idx * (tail_rows + 1);
+            row_end = row_begin + tail_rows + 1;
+        } else {
+            row_begin = former_num * (tail_rows + 1) + (current_block_idx - former_num) * tail_rows;
+            row_end = row_begin + tail_rows;
+        }
+        segment_num = (nx + segment_length - 1) / segment_length;
+        
+        // ==================== 3. 全局内存缓冲区设置 ====================
+        pillarFeaturesGm.SetGlobalBuffer((__gm__ half*)pillar_features, total_pillars * feature_size);
+        rowStartGm.SetGlobalBuffer((__gm__ uint32_t*)workspace + tiling.rowStartOffset, row_num + 1 + COORD_ALIGN);
+        binsGm.SetGlobalBuffer((__gm__ uint32_t*)workspace + tiling.binOffset,
+                               total_pillars * BIN_ENTRY_DIM + COORD_ALIGN);
+        spatialFeaturesGm.SetGlobalBuffer((__gm__ half*)spatial_features,
+                                          static_cast<uint64_t>(row_num) * nx * feature_size);
+        
+        // ==================== 4. 本地内存初始化 ====================
+        pipe.InitBuffer(segmentQueue, BUFFER_NUM, segment_length * feature_size * sizeof(half));
+        pipe.InitBuffer(rowStartBuf, (ROW_GROUP + COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(entryBuf, ENTRY_TILE * BIN_ENTRY_DIM * sizeof(uint32_t));
+        if (reduce_mode != SCATTER_REDUCE_OVERWRITE) {
+            pipe.InitBuffer(countBuf, ((segment_length + COORD_ALIGN - 1) / COORD_ALIGN * COORD_ALIGN) *
+                                      sizeof(uint32_t));
+            pipe.InitBuffer(stageBuf, feature_size * sizeof(half));
+        }
+        if (output_layout == SCATTER_LAYOUT_NCHW) {
+            pipe.InitBuffer(planeQueue, BUFFER_NUM, segment_length * feature_size * sizeof(half));
+        }
+        profiler.Init(pipe, tiling, workspace);
+        profiler.Mark(SCATTER_PROFILE_INIT);
+    }
+    
+    /**
+     * @brief 主处理流程：逐行逐段 清零 -> 填充 -> （NCHW时转置）-> 写出
+     */
+    __aicore__ inline void Process()
+    {
+        LocalTensor<uint32_t> rowStartLocal = rowStartBuf.Get<uint32_t>();
+        for (uint32_t row = row_begin; row < row_end; row++) {
+            // 每ROW_GROUP行搬入一次行起始表（多搬1个作为最后一行的结束位置）
+            uint32_t group_idx = (row - row_begin) % ROW_GROUP;
+            if (group_idx == 0) {
+                LoadScalars(pipe, rowStartLocal, rowStartGm[row], ROW_GROUP + 1);
+            }
+            entry_begin = rowStartLocal.GetValue(group_idx);
+            entry_end = rowStartLocal.GetValue(group_idx + 1);
+            loaded_begin = entry_end;  // 标记当前entryBuf内容无效
+            uint32_t entries = entry_end - entry_begin;
+            profiler.Add(SCATTER_PROFILE_ENTRIES, entries);
+            profiler.Add(SCATTER_PROFILE_WRITTEN, entries);
+            profiler.Add(SCATTER_PROFILE_BYTES_IN, entries * (feature_size * sizeof(half) +
+                                                              BIN_ENTRY_DIM * sizeof(uint32_t)));
+            
+            for (uint32_t seg = 0; seg < segment_num; seg++) {
+                uint32_t x_begin = seg * segment_length;
+                uint32_t cells = (x_begin + segment_length <= nx) ? segment_length : nx - x_begin;
+                FillSegment(x_begin, cells);
+                profiler.Mark(SCATTER_PROFILE_COPY_IN);
+                if (output_layout == SCATTER_LAYOUT_NCHW) {
+                    TransposeSegment(cells);
+                    CopyOutPlanes(row, x_begin, cells);
+                } else {
+                    CopyOut(row, x_begin, cells);
+                }
+                profiler.Mark(SCATTER_PROFILE_SCATTER);
+                profiler.Add(SCATTER_PROFILE_TILES, 1);
+                profiler.Add(SCATTER_PROFILE_BYTES_OUT, cells * feature_size * sizeof(half));
+            }
+        }
+        profiler.Mark(SCATTER_PROFILE_TAIL);
+        profiler.Store(pipe, block_idx);
+    }
+
+private:
+    /**
+     * @brief 在UB中构造一段输出：清零后填入落在 [x_begin, x_begin+cells) 的pillar
+     */
+    __aicore__ inline void FillSegment(uint32_t x_begin, uint32_t cells)
+    {
+        LocalTensor<half> segmentLocal = segmentQueue.AllocTensor<half>();
+        Duplicate(segmentLocal, static_cast<half>(0), cells * feature_size);
+        if (reduce_mode != SCATTER_REDUCE_OVERWRITE) {
+            // cell计数由标量单元逐个读写，直接在标量侧清零
+            LocalTensor<uint32_t> countLocal = countBuf.Get<uint32_t>();
+            for (uint32_t i = 0; i < cells; i++) {
+                countLocal.SetValue(i, 0);
+            }
+        }
+        
+        // 清零由Vector单元完成，特征搬入(MTE2)前需等待
+        event_t eventIdVToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_MTE2));
+        SetFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+        WaitFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+        
+        LocalTensor<uint32_t> entryLocal = entryBuf.Get<uint32_t>();
+        for (uint32_t chunk = entry_begin; chunk < entry_end; chunk += ENTRY_TILE) {
+            uint32_t count = (chunk + ENTRY_TILE <= entry_end) ? ENTRY_TILE : entry_end - chunk;
+            if (chunk != loaded_begin) {
+                LoadScalars(pipe, entryLocal, binsGm[chunk * BIN_ENTRY_DIM], count * BIN_ENTRY_DIM);
+                loaded_begin = chunk;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t pillar_idx = entryLocal.GetValue(i * BIN_ENTRY_DIM + 0);
+                uint32_t x = entryLocal.GetValue(i * BIN_ENTRY_DIM + 1);
+                if (x < x_begin || x >= x_begin + cells) {
+                    continue;
+                }
+                if (reduce_mode != SCATTER_REDUCE_OVERWRITE) {
+                    ReduceInto(segmentLocal, x - x_begin, pillar_idx);
+                } else {
+                    DataCopy(segmentLocal[(x - x_begin) * feature_size],
+                             pillarFeaturesGm[static_cast<uint64_t>(pillar_idx) * feature_size], feature_size);
+                }
+            }
+        }
+        if (reduce_mode == SCATTER_REDUCE_MEAN) {
+            ApplyMean(segmentLocal, cells);
+        }
+        
+        if (output_layout == SCATTER_LAYOUT_NCHW) {
+            // 特征搬入(MTE2)完成后才能在UB内转置(V)
+            event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+            SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+            WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        } else {
+            // 特征搬入(MTE2)完成后才能整段写出(MTE3)
+            event_t eventIdMte2ToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_MTE3));
+            SetFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+            WaitFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        }
+        segmentQueue.EnQue(segmentLocal);
+    }
+    
+    /**
+     * @brief 将一个pillar按reduce_mode归约到段内第cell_idx个cell
+     * 
+     * cell的首个pillar直接搬入段内；之后的pillar先搬入暂存区，再由Vector单元与已有值归约。
+     */
+    __aicore__ inline void ReduceInto(const LocalTensor<half>& segmentLocal, uint32_t cell_idx, uint32_t pillar_idx)
+    {
+        LocalTensor<uint32_t> countLocal = countBuf.Get<uint32_t>();
+        uint32_t count = countLocal.GetValue(cell_idx);
+        countLocal.SetValue(cell_idx, count + 1);
+        LocalTensor<half> cellLocal = segmentLocal[cell_idx * feature_size];
+        if (count == 0) {
+            DataCopy(cellLocal, pillarFeaturesGm[static_cast<uint64_t>(pillar_idx) * feature_size], feature_size);
+            return;
+        }
+        
+        LocalTensor<half> stageLocal = stageBuf.Get<half>();
+        DataCopy(stageLocal, pillarFeaturesGm[static_cast<uint64_t>(pillar_idx) * feature_size], feature_size);
+        
+        // 暂存区和cell首个pillar均由MTE2搬入，归约前需等待
+        event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+        SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        
+        if (reduce_mode == SCATTER_REDUCE_MAX) {
+            Max(cellLocal, cellLocal, stageLocal, feature_size);
+        } else {
+            Add(cellLocal, cellLocal, stageLocal, feature_size);
+        }
+        
+        // 归约完成后暂存区才能被下一个pillar覆盖
+        event_t eventIdVToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_MTE2));
+        SetFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+        WaitFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+    }
+    
+    /**
+     * @brief MEAN模式：对段内计数大于1的cell乘以1/count
+     */
+    __aicore__ inline void ApplyMean(const LocalTensor<half>& segmentLocal, uint32_t cells)
+    {
+        event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+        SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        
+        LocalTensor<uint32_t> countLocal = countBuf.Get<uint32_t>();
+        for (uint32_t i = 0; i < cells; i++) {
+            uint32_t count = countLocal.GetValue(i);
+            if (count > 1) {
+                LocalTensor<half> cellLocal = segmentLocal[i * feature_size];
+                Muls(cellLocal, cellLocal, static_cast<half>(1.0f / count), feature_size);
+            }
+        }
+    }
+    
+    /**
+     * @brief 将构造好的一段连续写回GM
+     */
+    __aicore__ inline void CopyOut(uint32_t row, uint32_t x_begin, uint32_t cells)
+    {
+        LocalTensor<half> segmentLocal = segmentQueue.DeQue<half>();
+        uint64_t offset = (static_cast<uint64_t>(row) * nx + x_begin) * feature_size;
+        DataCopy(spatialFeaturesGm[offset], segmentLocal, cells * feature_size);
+        segmentQueue.FreeTensor(segmentLocal);
+    }
+    
+    /**
+     * @brief NCHW输出：把构造好的段转置为通道平面
+     */
+    __aicore__ inline void TransposeSegment(uint32_t cells)
+    {
+        LocalTensor<half> segmentLocal = segmentQueue.DeQue<half>();
+        LocalTensor<half> planeLocal = planeQueue.AllocTensor<half>();
+        TransposeToPlanes(planeLocal, segmentLocal, cells, feature_size);
+        planeQueue.EnQue(planeLocal);
+        segmentQueue.FreeTensor(segmentLocal);
+    }
+    
+    /**
+     * @brief NCHW输出：第row行（b*ny+y）的一段写入各通道平面
+     */
+    __aicore__ inline void CopyOutPlanes(uint32_t row, uint32_t x_begin, uint32_t cells)
+    {
+        LocalTensor<half> planeLocal = planeQueue.DeQue<half>();
+        uint64_t plane_size = static_cast<uint64_t>(ny) * nx;
+        uint64_t offset = static_cast<uint64_t>(row / ny) * feature_size * plane_size +
+                          static_cast<uint64_t>(row % ny) * nx + x_begin;
+        WritePlanes(spatialFeaturesGm, planeLocal, offset, plane_size, cells, feature_size);
+        planeQueue.FreeTensor(planeLocal);
+    }
+
+private:
+    // ==================== 流水线和队列管理 ====================
+    TPipe pipe;
+    TQue<QuePosition::VECOUT, BUFFER_NUM> segmentQueue;  // 输出段队列（清零+填充后写出）
+    TQue<QuePosition::VECOUT, BUFFER_NUM> planeQueue;    // NCHW输出：转置后的通道平面队列
+    TBuf<TPosition::VECCALC> rowStartBuf;                 // 当前行组的行起始表
+    TBuf<TPosition::VECCALC> entryBuf;                    // 当前行的分桶条目
+    TBuf<TPosition::VECCALC> countBuf;                    // 非覆盖归约：当前段每个cell的pillar计数
+    TBuf<TPosition::VECCALC> stageBuf;                    // 非覆盖归约：重复pillar的特征暂存区
+    
+    // ==================== 全局内存访问张量 ====================
+    GlobalTensor<half> pillarFeaturesGm;      // 全部pillar特征（按分桶条目随机读取）
+    GlobalTensor<uint32_t> rowStartGm;        // 行起始表
+    GlobalTensor<uint32_t> binsGm;            // 行分桶条目
+    GlobalTensor<half> spatialFeaturesGm;     // 输出特征图
+    
+    // ==================== 分核和分段参数 ====================
+    uint32_t row_begin;              // 当前Core负责的起始行（含）
+    uint32_t row_end;                // 当前Core负责的结束行（不含）
+    uint32_t row_num;                // 总行数 B*ny
+    uint32_t nx;                     // BEV特征图宽度
+    uint32_t ny;                     // BEV特征图高度
+    uint32_t feature_size;           // 每个pillar的特征维度 C
+    uint32_t segment_length;         // 每段cell数
+    uint32_t segment_num;            // 每行段数
+    uint32_t total_pillars;          // pillar总数
+    uint32_t reduce_mode;            // 重复坐标归约方式（PillarScatterReduce）
+    uint32_t output_layout;          // 输出布局（PillarScatterLayout）
+    uint32_t entry_begin;            // 当前行分桶条目范围（含）
+    uint32_t entry_end;              // 当前行分桶条目范围（不含）
+    uint32_t loaded_begin;           // entryBuf中已加载条目块的起始位置
+    int32_t block_idx;               // 当前Core编号
+    KernelProfiler profiler;         // 性能剖析（PILLAR_SCATTER_PROFILE）
+};
+
+/**
+ * @brief 持久输出(INCREMENTAL)模式的PillarScatter kernel
+ * 
+ * 连续帧复用同一块输出，每帧只清零上一帧写过的cell，代价与pillar数成正比而非网格面积。
+ * 
+ * 按输出行归属分核：第k核负责连续的ownerRows行 [k*ownerRows, (k+1)*ownerRows)，这些cell只由本核清零和写入，
+ * 同一cell的清零与写入在同一核内按序完成，核间无需同步。
+ * host已按归属核对pillar分桶（越界和填充条目被丢弃），坐标为输出cell下标 [N]，
+ * 各核从workspace中的起始表取得自己的一段连续pillar，坐标和特征都按块整段搬入，
+ * 每帧每个pillar的坐标和特征只被读取一次。
+ * 
+ * workspace中保存两组按核划分的cell列表，按帧序号params[1]的奇偶交替读写：
+ *   - 读取上一帧本核写过的cell列表，写出本帧本核写入的cell列表
+ *   - 每个核的区间为 [计数头(8个字), cell...]，首帧前由host清零
+ * 本核cell数不超过BITMAP_BYTES*8时，先用UB位图记录本帧写入的cell，
+ * 清零时跳过会被覆盖的cell；否则先全部清零再写入。
+ * 
+ * @tparam FIXED_C 编译期通道数，为0时取自tiling
+ */
+template <int32_t FIXED_C>
+class KernelPillarScatterIncremental {
+public:
+    __aicore__ inline KernelPillarScatterIncremental() {}
+    
+    /**
+     * @brief 初始化：确定本核归属的行和pillar范围、上一帧/本帧cell列表和UB缓冲区
+     * 
+     * 参数含义同KernelPillarScatter::Init，coords为分桶后的cell下标；params[1]为帧序号。
+     */
+    __aicore__ inline void Init(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                GM_ADDR spatial_features)
+    {
+        // ==================== 1. 解析参数和tiling ====================
+        profiler.Start();
+        block_idx = GetBlockIdx();
+        block_num = GetBlockNum();
+        total_pillars = *((__gm__ uint32_t*)params);
+        uint32_t frame_idx = *((__gm__ uint32_t*)params + 1);
+        feature_size = (FIXED_C > 0) ? FIXED_C : tiling.featureSize;
+        tile_length = (FIXED_C > 0) ? PILLAR_SCATTER_TILE_BYTES / (FIXED_C * sizeof(half)) : tiling.tileLength;
+        nx = tiling.nx;
+        uint32_t row_num = tiling.batchSize * tiling.ny;
+        uint64_t total_cells = static_cast<uint64_t>(row_num) * nx;
+        
+        // ==================== 2. 本核归属的行和pillar ====================
+        uint32_t row_begin = block_idx * tiling.ownerRows;
+        row_begin = (row_begin < row_num) ? row_begin : row_num;
+        uint32_t row_end = (row_begin + tiling.ownerRows < row_num) ? row_begin + tiling.ownerRows : row_num;
+        cell_begin = row_begin * nx;
+        uint32_t owned_cells = (row_end - row_begin) * nx;
+        __gm__ uint32_t* start = (__gm__ uint32_t*)workspace + tiling.regionOffset;
+        pillar_begin = start[block_idx];
+        pillar_num = start[block_idx + 1] - pillar_begin;
+        bitmap_words = (owned_cells + 31) / 32;
+        use_bitmap = owned_cells > 0 && bitmap_words * sizeof(uint32_t) <= BITMAP_BYTES;
+        
+        // ==================== 3. 全局内存缓冲区设置 ====================
+        pillarFeaturesGm.SetGlobalBuffer((__gm__ half*)pillar_features, total_pillars * feature_size);
+        // 按块搬运时cell下标长度向上取整到32字节，最多多读7个uint32_t，由host在末尾预留的8个uint32_t兜底
+        cellsGm.SetGlobalBuffer((__gm__ uint32_t*)coords, total_pillars + COORD_ALIGN);
+        spatialFeaturesGm.SetGlobalBuffer((__gm__ half*)spatial_features, total_cells * feature_size);
+        // 两组列表按帧奇偶交替：上一帧写入(frame_idx-1)的列表作为本帧的清零列表
+        uint32_t prev_set = (frame_idx + 1) & 1;
+        uint32_t next_set = frame_idx & 1;
+        __gm__ uint32_t* lists = (__gm__ uint32_t*)workspace + tiling.cellListOffset;
+        prevListGm.SetGlobalBuffer(lists + (prev_set * block_num + block_idx) * tiling.cellListStride,
+                                   tiling.cellListStride);
+        nextListGm.SetGlobalBuffer(lists + (next_set * block_num + block_idx) * tiling.cellListStride,
+                                   tiling.cellListStride);
+        
+        // ==================== 4. 本地内存初始化 ====================
+        pipe.InitBuffer(featureQueue, BUFFER_NUM, tile_length * feature_size * sizeof(half));
+        pipe.InitBuffer(cellQueue, BUFFER_NUM, AlignUp(tile_length, COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(listBuf, (ENTRY_TILE + LIST_HEAD) * sizeof(uint32_t));
+        pipe.InitBuffer(zeroBuf, feature_size * sizeof(half));
+        if (use_bitmap) {
+            pipe.InitBuffer(bitmapBuf, AlignUp(bitmap_words, COORD_ALIGN) * sizeof(uint32_t));
+            bitmapLocal = bitmapBuf.Get<uint32_t>();
+        }
+        profiler.Init(pipe, tiling, workspace);
+        profiler.Mark(SCATTER_PROFILE_INIT);
+    }
+    
+    /**
+     * @brief 主处理流程
+     * 
+     * 有位图：写入本帧pillar并记录位图 -> 清零上一帧未被覆盖的cell
+     * 无位图：清零上一帧全部cell -> 写入本帧pillar
+     * 两种顺序下同一cell的最终值都是本帧的特征。
+     */
+    __aicore__ inline void Process()
+    {
+        LocalTensor<half> zeroLocal = zeroBuf.Get<half>();
+        Duplicate(zeroLocal, static_cast<half>(0), feature_size);
+        if (use_bitmap) {
+            Duplicate(bitmapLocal, static_cast<uint32_t>(0), AlignUp(bitmap_words, COORD_ALIGN));
+        }
+        // 零行(Vector)写出前、位图(Vector)被标量读写前均需等待清零完成
+        event_t eventIdVToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_S));
+        SetFlag<HardEvent::V_S>(eventIdVToS);
+        WaitFlag<HardEvent::V_S>(eventIdVToS);
+        event_t eventIdVToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_MTE3));
+        SetFlag<HardEvent::V_MTE3>(eventIdVToMte3);
+        WaitFlag<HardEvent::V_MTE3>(eventIdVToMte3);
+        
+        // 先读出上一帧的cell数，本帧列表写出后会覆盖另一组
+        LocalTensor<uint32_t> listLocal = listBuf.Get<uint32_t>();
+        LoadScalars(pipe, listLocal, prevListGm, LIST_HEAD);
+        prev_count = listLocal.GetValue(0);
+        
+        if (!use_bitmap) {
+            ClearPrevious();
+            profiler.Mark(SCATTER_PROFILE_TAIL);
+        }
+        next_count = 0;
+        uint32_t tile_num = (pillar_num + tile_length - 1) / tile_length;
+        for (uint32_t i = 0; i < tile_num; i++) {
+            uint32_t length = (i == tile_num - 1) ? pillar_num - i * tile_length : tile_length;
+            CopyIn(i, length);
+            profiler.Mark(SCATTER_PROFILE_COPY_IN);
+            Scatter(length);
+            profiler.Mark(SCATTER_PROFILE_SCATTER);
+            profiler.Add(SCATTER_PROFILE_TILES, 1);
+            profiler.Add(SCATTER_PROFILE_ENTRIES, length);
+            profiler.Add(SCATTER_PROFILE_WRITTEN, length);
+            profiler.Add(SCATTER_PROFILE_BYTES_IN, length * (sizeof(uint32_t) + feature_size * sizeof(half)));
+            profiler.Add(SCATTER_PROFILE_BYTES_OUT, length * feature_size * sizeof(half));
+        }
+        if (use_bitmap) {
+            ClearPrevious();
+        }
+        
+        // 写出本帧本核的cell计数，供下一帧使用
+        event_t eventIdMte3ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE3_S));
+        SetFlag<HardEvent::MTE3_S>(eventIdMte3ToS);
+        WaitFlag<HardEvent::MTE3_S>(eventIdMte3ToS);
+        listLocal.SetValue(0, next_count);
+        StoreScalars(pipe, nextListGm, listLocal, LIST_HEAD);
+        profiler.Mark(SCATTER_PROFILE_TAIL);
+        profiler.Store(pipe, block_idx);
+    }
+
+private:
+    /**
+     * @brief 搬入本核一块连续pillar的cell下标和特征，各一次DataCopy
+     */
+    __aicore__ inline void CopyIn(uint32_t progress, uint32_t length)
+    {
+        uint64_t start = pillar_begin + progress * tile_length;
+        LocalTensor<uint32_t> cellLocal = cellQueue.AllocTensor<uint32_t>();
+        LocalTensor<half> featureLocal = featureQueue.AllocTensor<half>();
+        DataCopy(cellLocal, cellsGm[start], AlignUp(length, COORD_ALIGN));
+        DataCopy(featureLocal, pillarFeaturesGm[start * feature_size], length * feature_size);
+        cellQueue.EnQue(cellLocal);
+        featureQueue.EnQue(featureLocal);
+    }
+    
+    /**
+     * @brief 把一块pillar特征逐行写入输出、记录位图，并把cell下标追加到本帧cell列表
+     */
+    __aicore__ inline void Scatter(uint32_t length)
+    {
+        LocalTensor<uint32_t> cellLocal = cellQueue.DeQue<uint32_t>();
+        LocalTensor<half> featureLocal = featureQueue.DeQue<half>();
+        event_t eventIdMte2ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_S));
+        SetFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        WaitFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        
+        for (uint32_t i = 0; i < length; i++) {
+            uint32_t cell = cellLocal.GetValue(i);
+            if (use_bitmap) {
+                uint32_t local_cell = cell - cell_begin;
+                uint32_t word = bitmapLocal.GetValue(local_cell / 32);
+                bitmapLocal.SetValue(local_cell / 32, word | (1u << (local_cell % 32)));
+            }
+            DataCopy(spatialFeaturesGm[static_cast<uint64_t>(cell) * feature_size], featureLocal[i * feature_size],
+                     feature_size);
+        }
+        if (length > 0) {
+            StoreScalars(pipe, nextListGm[LIST_HEAD + next_count], cellLocal, length);
+            next_count += length;
+        }
+        // cell列表写出(MTE3)完成后该缓冲区才能被下一次搬入覆盖
+        event_t eventIdMte3ToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE3_MTE2));
+        SetFlag<HardEvent::MTE3_MTE2>(eventIdMte3ToMte2);
+        WaitFlag<HardEvent::MTE3_MTE2>(eventIdMte3ToMte2);
+        featureQueue.FreeTensor(featureLocal);
+        cellQueue.FreeTensor(cellLocal);
+    }
+    
+    /**
+     * @brief 清零上一帧本核写过的cell；有位图时跳过本帧已写入的cell
+     */
+    __aicore__ inline void ClearPrevious()
+    {
+        LocalTensor<half> zeroLocal = zeroBuf.Get<half>();
+        LocalTensor<uint32_t> listLocal = listBuf.Get<uint32_t>();
+        for (uint32_t chunk = 0; chunk < prev_count; chunk += ENTRY_TILE) {
+            uint32_t count = (chunk + ENTRY_TILE <= prev_count) ? ENTRY_TILE : prev_count - chunk;
+            LoadScalars(pipe, listLocal, prevListGm[LIST_HEAD + chunk], count);
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t cell = listLocal.GetValue(i);
+                if (use_bitmap) {
+                    uint32_t local_cell = cell - cell_begin;
+                    if ((bitmapLocal.GetValue(local_cell / 32) >> (local_cell % 32)) & 1) {
+                        continue;  // 本帧已覆盖
+                    }
+                }
+                DataCopy(spatialFeaturesGm[static_cast<uint64_t>(cell) * feature_size], zeroLocal, feature_size);
+                profiler.Add(SCATTER_PROFILE_BYTES_OUT, feature_size * sizeof(half));
+            }
+        }
+    }
+
+private:
+    // ==================== 流水线和队列管理 ====================
+    TPipe pipe;
+    TQueBind<TPosition::VECIN, TPosition::VECOUT, BUFFER_NUM> featureQueue;  // 本核pillar特征（GM->UB->GM）
+    TQue<QuePosition::VECIN, BUFFER_NUM> cellQueue;                          // 本核pillar的cell下标块
+    TBuf<TPosition::VECCALC> listBuf;        // cell列表读写缓冲
+    TBuf<TPosition::VECCALC> zeroBuf;        // 一行零值
+    TBuf<TPosition::VECCALC> bitmapBuf;      // 本帧写入cell的位图
+    LocalTensor<uint32_t> bitmapLocal;       // 位图（仅use_bitmap时有效）
+    
+    // ==================== 全局内存访问张量 ====================
+    GlobalTensor<half> pillarFeaturesGm;
+    GlobalTensor<uint32_t> cellsGm;          // 分桶后各pillar的输出cell下标
+    GlobalTensor<half> spatialFeaturesGm;
+    GlobalTensor<uint32_t> prevListGm;       // 上一帧本核写过的cell列表
+    GlobalTensor<uint32_t> nextListGm;       // 本帧本核写入的cell列表
+    
+    // ==================== 分核和处理参数 ====================
+    int32_t block_idx;
+    int32_t block_num;
+    uint32_t total_pillars;
+    uint32_t nx;
+    uint32_t feature_size;
+    uint32_t tile_length;
+    uint32_t pillar_begin;           // 本核第一个pillar在分桶结果中的下标
+    uint32_t pillar_num;             // 本核pillar数
+    uint32_t cell_begin;             // 本核归属的第一个cell
+    uint32_t bitmap_words;           // 位图长度（uint32个数）
+    bool use_bitmap;                 // 位图能否放入UB
+    uint32_t prev_count;             // 上一帧本核写过的cell数
+    uint32_t next_count;             // 本帧本核已写入的cell数
+    KernelProfiler profiler;         // 性能剖析（PILLAR_SCATTER_PROFILE）
+};
+
+/**
+ * @brief 稀疏(CSR)输出模式的PillarScatter kernel
+ * 
+ * 供稀疏卷积骨干网络使用：不写 [B, ny, nx, C] 稠密特征图，只输出去重后按行优先排序的cell。
+ * host侧已按cell稳定排序pillar（越界pillar被丢弃），并生成：
+ *   - workspace中的runStart[M+1]：第m个cell的pillar在排序后列表中的范围 [runStart[m], runStart[m+1])
+ *   - 输出开头的行偏移表 [B*ny+1] 和列下标 [M]（由host直接写入输出）
+ * kernel按cell均分到各核，每次处理tile_length个cell：同一cell的pillar在输入中连续，
+ * 覆盖模式取最后一个（源行连续的cell合并为一次DataCopy），SUM/MAX/MEAN把整段pillar一次搬入暂存区后
+ * 两两折半归约；整块一次连续写入紧凑特征 [M, C]。每个cell只由一个核处理，结果确定。
+ * 
+ * @tparam FIXED_C 编译期通道数，为0时取自tiling
+ */
+template <int32_t FIXED_C>
+class KernelPillarScatterCsr {
+public:
+    __aicore__ inline KernelPillarScatterCsr() {}
+    
+    /**
+     * @brief 初始化：按cell均分，设置GM缓冲区和UB队列
+     * 
+     * 参数含义同KernelPillarScatter::Init；coords不使用，
+     * spatial_features为CSR输出缓冲区，紧凑特征位于其csrFeatureOffset处。
+     */
+    __aicore__ inline void Init(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                GM_ADDR spatial_features)
+    {
+        // ==================== 1. 解析参数和tiling ====================
+        profiler.Start();
+        int32_t current_block_idx = GetBlockIdx();
+        int32_t block_num = GetBlockNum();
+        block_idx = current_block_idx;
+        total_pillars = *((__gm__ uint32_t*)params);
+        feature_size = (FIXED_C > 0) ? FIXED_C : tiling.featureSize;
+        tile_length = (FIXED_C > 0) ? PILLAR_SCATTER_TILE_BYTES / (FIXED_C * sizeof(half)) : tiling.tileLength;
+        cell_count = tiling.cellCount;
+        reduce_mode = tiling.reduceMode;
+        
+        // ==================== 2. 按cell均分 ====================
+        // 每个cell写出C个元素，按cell数均分即均衡写出量
+        uint32_t tail_cells = cell_count / block_num;
+        uint32_t former_num = cell_count % block_num;
+        if (current_block_idx < static_cast<int32_t>(former_num)) {
+            cell_begin = current_block_idx * (tail_cells + 1);
+            cell_num = tail_cells + 1;
+        } else {
+            cell_begin = former_num * (tail_cells + 1) + (current_block_idx - former_num) * tail_cells;
+            cell_num = tail_cells;
+        }
+        
+        // ==================== 3. 全局内存缓冲区设置 ====================
+        pillarFeaturesGm.SetGlobalBuffer((__gm__ half*)pillar_features, total_pillars * feature_size);
+        runStartGm.SetGlobalBuffer((__gm__ uint32_t*)workspace + tiling.runStartOffset, cell_count + 1 + COORD_ALIGN);
+        csrFeaturesGm.SetGlobalBuffer((__gm__ half*)((__gm__ uint32_t*)spatial_features + tiling.csrFeatureOffset),
+                                      static_cast<uint64_t>(cell_count) * feature_size);
+        
+        // ==================== 4. 本地内存初始化 ====================
+        pipe.InitBuffer(outQueue, BUFFER_NUM, tile_length * feature_size * sizeof(half));
+        pipe.InitBuffer(runStartBuf, AlignUp(tile_length + 1, COORD_ALIGN) * sizeof(uint32_t));
+        if (reduce_mode != SCATTER_REDUCE_OVERWRITE) {
+            pipe.InitBuffer(stageBuf, tile_length * feature_size * sizeof(half));
+        }
+        profiler.Init(pipe, tiling, workspace);
+        profiler.Mark(SCATTER_PROFILE_INIT);
+    }
+    
+    /**
+     * @brief 主处理流程：逐块 收集/归约 -> 连续写出
+     */
+    __aicore__ inline void Process()
+    {
+        for (uint32_t offset = 0; offset < cell_num; offset += tile_length) {
+            uint32_t cells = (offset + tile_length <= cell_num) ? tile_length : cell_num - offset;
+            Gather(cell_begin + offset, cells);
+            profiler.Mark(SCATTER_PROFILE_COPY_IN);
+            CopyOut(cell_begin + offset, cells);
+            profiler.Mark(SCATTER_PROFILE_SCATTER);
+            profiler.Add(SCATTER_PROFILE_TILES, 1);
+            profiler.Add(SCATTER_PROFILE_WRITTEN, cells);
+            profiler.Add(SCATTER_PROFILE_BYTES_OUT, cells * feature_size * sizeof(half));
+        }
+        profiler.Mark(SCATTER_PROFILE_TAIL);
+        profiler.Store(pipe, block_idx);
+    }
+
+private:
+    /**
+     * @brief 在UB中构造 [first, first+cells) 这些cell的紧凑特征
+     */
+    __aicore__ inline void Gather(uint32_t first, uint32_t cells)
+    {
+        LocalTensor<uint32_t> runLocal = runStartBuf.Get<uint32_t>();
+        LoadScalars(pipe, runLocal, runStartGm[first], cells + 1);
+        LocalTensor<half> outLocal = outQueue.AllocTensor<half>();
+#ifdef PILLAR_SCATTER_PROFILE
+        // 覆盖模式每个cell只读最后一个pillar，归约模式读整段pillar
+        uint32_t pillars = runLocal.GetValue(cells) - runLocal.GetValue(0);
+        uint32_t read_rows = (reduce_mode == SCATTER_REDUCE_OVERWRITE) ? cells : pillars;
+        profiler.Add(SCATTER_PROFILE_ENTRIES, pillars);
+        profiler.Add(SCATTER_PROFILE_BYTES_IN, (cells + 1) * sizeof(uint32_t) + read_rows * feature_size * sizeof(half));
+#endif
+        
+        if (reduce_mode == SCATTER_REDUCE_OVERWRITE) {
+            // 每个cell取其最后一个pillar；无重复时源行连续，整块一次搬运
+            uint32_t run_begin = 0;
+            uint32_t src_begin = runLocal.GetValue(1) - 1;
+            for (uint32_t i = 1; i <= cells; i++) {
+                uint32_t src = (i < cells) ? runLocal.GetValue(i + 1) - 1 : 0;
+                if (i < cells && src == src_begin + (i - run_begin)) {
+                    continue;
+                }
+                DataCopy(outLocal[run_begin * feature_size],
+                         pillarFeaturesGm[static_cast<uint64_t>(src_begin) * feature_size],
+                         (i - run_begin) * feature_size);
+                run_begin = i;
+                src_begin = src;
+            }
+        } else {
+            for (uint32_t i = 0; i < cells; i++) {
+                uint32_t start = runLocal.GetValue(i);
+                ReduceCell(outLocal[i * feature_size], start, runLocal.GetValue(i + 1) - start);
+            }
+        }
+        
+        // 特征搬入(MTE2)完成后才能整块写出(MTE3)
+        event_t eventIdMte2ToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_MTE3));
+        SetFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        WaitFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        outQueue.EnQue(outLocal);
+    }
+    
+    /**
+     * @brief 将排序后连续的count个pillar按reduce_mode归约到cellLocal
+     * 
+     * 首个pillar直接搬入输出行，其余pillar每次最多tile_length个整段搬入暂存区，
+     * 两两折半归约为一行后再并入输出行。
+     */
+    __aicore__ inline void ReduceCell(const LocalTensor<half>& cellLocal, uint32_t start, uint32_t count)
+    {
+        DataCopy(cellLocal, pillarFeaturesGm[static_cast<uint64_t>(start) * feature_size], feature_size);
+        LocalTensor<half> stageLocal = stageBuf.Get<half>();
+        for (uint32_t done = 1; done < count; done += tile_length) {
+            uint32_t width = (count - done < tile_length) ? count - done : tile_length;
+            // 上一次归约读完暂存区后才能覆盖
+            event_t eventIdVToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_MTE2));
+            SetFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+            WaitFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+            DataCopy(stageLocal, pillarFeaturesGm[static_cast<uint64_t>(start + done) * feature_size],
+                     width * feature_size);
+            event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+            SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+            WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+            // 把 [w-h, w) 并入 [0, h)，h = w/2，直到只剩1行
+            while (width > 1) {
+                uint32_t half_width = width / 2;
+                Combine(stageLocal, stageLocal[(width - half_width) * feature_size], half_width * feature_size);
+                width -= half_width;
+            }
+            Combine(cellLocal, stageLocal, feature_size);
+        }
+        if (reduce_mode == SCATTER_REDUCE_MEAN && count > 1) {
+            Muls(cellLocal, cellLocal, static_cast<half>(1.0f / count), feature_size);
+        }
+    }
+    
+    /**
+     * @brief dst = dst (+/max) src
+     */
+    __aicore__ inline void Combine(const LocalTensor<half>& dst, const LocalTensor<half>& src, uint32_t length)
+    {
+        if (reduce_mode == SCATTER_REDUCE_MAX) {
+            Max(dst, dst, src, length);
+        } else {
+            Add(dst, dst, src, length);
+        }
+    }
+    
+    /**
+     * @brief 将一块紧凑特征连续写回GM
+     */
+    __aicore__ inline void CopyOut(uint32_t first, uint32_t cells)
+    {
+        LocalTensor<half> outLocal = outQueue.DeQue<half>();
+        DataCopy(csrFeaturesGm[static_cast<uint64_t>(first) * feature_size], outLocal, cells * feature_size);
+        outQueue.FreeTensor(outLocal);
+    }
+
+private:
+    // ==================== 流水线和队列管理 ====================
+    TPipe pipe;
+    TQue<QuePosition::VECOUT, BUFFER_NUM> outQueue;  // 紧凑特征块队列
+    TBuf<TPosition::VECCALC> runStartBuf;            // 当前块各cell的pillar起始位置
+    TBuf<TPosition::VECCALC> stageBuf;               // 非覆盖归约：同一cell其余pillar的暂存区
+    
+    // ==================== 全局内存访问张量 ====================
+    GlobalTensor<half> pillarFeaturesGm;      // 按cell排序后的pillar特征
+    GlobalTensor<uint32_t> runStartGm;        // 各cell的pillar起始表
+    GlobalTensor<half> csrFeaturesGm;         // 紧凑特征 [M, C]
+    
+    // ==================== 分核和处理参数 ====================
+    uint32_t cell_begin;             // 当前Core负责的首个cell
+    uint32_t cell_num;               // 当前Core负责的cell数
+    uint32_t cell_count;             // 去重后的cell总数 M
+    uint32_t total_pillars;          // 排序后的有效pillar数
+    uint32_t feature_size;           // 每个pillar的特征维度 C
+    uint32_t tile_length;            // 每块cell数
+    uint32_t reduce_mode;            // 重复坐标归约方式（PillarScatterReduce）
+    int32_t block_idx;               // 当前Core编号
+    KernelProfiler profiler;         // 性能剖析（PILLAR_SCATTER_PROFILE）
+};
+
+/**
+ * @brief 多分辨率(MULTIRES)模式的PillarScatter kernel
+ * 
+ * 一次遍历pillar同时写出全分辨率输出 [B, ny, nx, C] 和若干步长 s=2^k 的池化输出 [B, ny/s, nx/s, C]，
+ * 结果与先scatter、再对稠密输出做 s x s 窗口的max/mean池化相同，省去池化算子对整张稠密特征图的读取。
+ * host侧已把pillar按最大步长的粗网格块排序（块内为四叉树顺序），同一cell只保留最后一个pillar，
+ * 因此任一步长的每个粗cell在输入中都是连续的一段；各核起始表按最大步长的块对齐，粗cell不跨核。
+ * 
+ * 每块特征一次DataCopy读入UB，每行只读一次：相邻cell连续的行合并写入全分辨率输出；
+ * 池化按步长从小到大逐级累积，每行并入最小步长的累积行，一个粗cell结束时其累积行并入下一级步长。
+ * MAX在窗口未被占满时再与0取最大值（空cell为0），MEAN写出时乘以1/(s*s)。
+ * 一块内结束的粗cell先写入暂存区，块末统一写出。仅支持half。
+ * 
+ * @tparam FIXED_C 编译期通道数，为0时取自tiling
+ */
+template <int32_t FIXED_C>
+class KernelPillarScatterMultiRes {
+public:
+    __aicore__ inline KernelPillarScatterMultiRes() {}
+    
+    /**
+     * @brief 初始化：按host的起始表分核，设置全分辨率和各步长输出的GM缓冲区及UB
+     * 
+     * 参数含义同KernelPillarScatter::Init；params[0]为去重后的cell数，
+     * spatial_features依次为全分辨率输出和按步长升序的各池化输出。
+     */
+    __aicore__ inline void Init(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                GM_ADDR spatial_features)
+    {
+        // ==================== 1. 解析参数和tiling ====================
+        profiler.Start();
+        int32_t current_block_idx = GetBlockIdx();
+        int32_t block_num = GetBlockNum();
+        block_idx = current_block_idx;
+        total_cells = *((__gm__ uint32_t*)params);
+        feature_size = (FIXED_C > 0) ? FIXED_C : tiling.featureSize;
+        // 每级步长另需一块暂存区，块长取其他模式的一半
+        tile_length = (FIXED_C > 0) ? PILLAR_SCATTER_TILE_BYTES / (FIXED_C * sizeof(half)) : tiling.tileLength;
+        tile_length = (tile_length > 1) ? tile_length / 2 : 1;
+        nx = tiling.nx;
+        ny = tiling.ny;
+        pool_mode = tiling.poolMode;
+        level_num = 0;
+        uint64_t output_length = static_cast<uint64_t>(tiling.batchSize) * ny * nx * feature_size;
+        for (uint32_t k = 1; k <= PILLAR_SCATTER_MAX_POOL_SHIFT; k++) {
+            if ((tiling.poolStrideMask >> k) & 1) {
+                level_shift[level_num] = k;
+                level_offset[level_num] = output_length;
+                level_count[level_num] = 0;
+                output_length += static_cast<uint64_t>(tiling.batchSize) * (ny >> k) * (nx >> k) * feature_size;
+                level_num++;
+            }
+        }
+        
+        // ==================== 2. 按起始表分核 ====================
+        // 起始表与实际launch不一致时不能保证粗cell不跨核，由0号核处理全部cell
+        if (tiling.coreNum == static_cast<uint32_t>(block_num) && tiling.totalPillars == total_cells) {
+            __gm__ uint32_t* region = (__gm__ uint32_t*)workspace + tiling.regionOffset;
+            cell_begin = region[current_block_idx];
+            cell_num = region[current_block_idx + 1] - cell_begin;
+        } else {
+            cell_begin = 0;
+            cell_num = (current_block_idx == 0) ? total_cells : 0;
+        }
+        
+        // ==================== 3. 全局内存缓冲区设置 ====================
+        pillarFeaturesGm.SetGlobalBuffer((__gm__ half*)pillar_features, total_cells * feature_size);
+        // 每块多读一行坐标用于判断粗cell是否结束，越过末尾的部分由host在coords末尾预留的8个uint32_t兜底
+        coordsGm.SetGlobalBuffer((__gm__ uint32_t*)coords, total_cells * COORD_DIM + COORD_ALIGN);
+        spatialFeaturesGm.SetGlobalBuffer((__gm__ half*)spatial_features, output_length);
+        
+        // ==================== 4. 本地内存初始化 ====================
+        pipe.InitBuffer(featureBuf, tile_length * feature_size * sizeof(half));
+        pipe.InitBuffer(coordsBuf, AlignUp((tile_length + 1) * COORD_DIM, COORD_ALIGN) * sizeof(uint32_t));
+        if (level_num > 0) {
+            pipe.InitBuffer(accBuf, level_num * feature_size * sizeof(half));
+            pipe.InitBuffer(stageBuf, level_num * tile_length * feature_size * sizeof(half));
+            pipe.InitBuffer(stageCellBuf, AlignUp(level_num * tile_length, COORD_ALIGN) * sizeof(uint32_t));
+        }
+        profiler.Init(pipe, tiling, workspace);
+        profiler.Mark(SCATTER_PROFILE_INIT);
+    }
+    
+    /**
+     * @brief 主处理流程：逐块 搬入 -> 写全分辨率输出 -> 逐级池化并写出结束的粗cell
+     */
+    __aicore__ inline void Process()
+    {
+        for (uint32_t offset = 0; offset < cell_num; offset += tile_length) {
+            uint32_t length = (offset + tile_length <= cell_num) ? tile_length : cell_num - offset;
+            CopyIn(cell_begin + offset, length);
+            profiler.Mark(SCATTER_PROFILE_COPY_IN);
+            CopyOutFull(length);
+            uint32_t pooled = Pool(length, offset + length == cell_num);
+            profiler.Mark(SCATTER_PROFILE_SCATTER);
+            profiler.Add(SCATTER_PROFILE_TILES, 1);
+            profiler.Add(SCATTER_PROFILE_ENTRIES, length);
+            profiler.Add(SCATTER_PROFILE_WRITTEN, length + pooled);
+            profiler.Add(SCATTER_PROFILE_BYTES_IN, length * (feature_size * sizeof(half) + COORD_DIM * sizeof(uint32_t)));
+            profiler.Add(SCATTER_PROFILE_BYTES_OUT, (length + pooled) * feature_size * sizeof(half));
+        }
+        profiler.Mark(SCATTER_PROFILE_TAIL);
+        profiler.Store(pipe, block_idx);
+    }
+
+private:
+    /**
+     * @brief 搬入一块特征和 length+1 行坐标（最后一行为下一块的首行）
+     */
+    __aicore__ inline void CopyIn(uint32_t start, uint32_t length)
+    {
+        LocalTensor<half> featureLocal = featureBuf.Get<half>();
+        LocalTensor<uint32_t> coordsLocal = coordsBuf.Get<uint32_t>();
+        // 上一块的池化(V)、写出(MTE3)和坐标读取(S)结束后才能覆盖
+        event_t eventIdVToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_MTE2));
+        SetFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+        WaitFlag<HardEvent::V_MTE2>(eventIdVToMte2);
+        event_t eventIdMte3ToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE3_MTE2));
+        SetFlag<HardEvent::MTE3_MTE2>(eventIdMte3ToMte2);
+        WaitFlag<HardEvent::MTE3_MTE2>(eventIdMte3ToMte2);
+        event_t eventIdSToMte2 = static_cast<event_t>(pipe.FetchEventID(HardEvent::S_MTE2));
+        SetFlag<HardEvent::S_MTE2>(eventIdSToMte2);
+        WaitFlag<HardEvent::S_MTE2>(eventIdSToMte2);
+        DataCopy(featureLocal, pillarFeaturesGm[static_cast<uint64_t>(start) * feature_size], length * feature_size);
+        DataCopy(coordsLocal, coordsGm[static_cast<uint64_t>(start) * COORD_DIM],
+                 AlignUp((length + 1) * COORD_DIM, COORD_ALIGN));
+        event_t eventIdMte2ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_S));
+        SetFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        WaitFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+    }
+    
+    /**
+     * @brief 把一块特征写入全分辨率输出，cell连续的行合并为一次DataCopy
+     */
+    __aicore__ inline void CopyOutFull(uint32_t length)
+    {
+        LocalTensor<half> featureLocal = featureBuf.Get<half>();
+        LocalTensor<uint32_t> coordsLocal = coordsBuf.Get<uint32_t>();
+        event_t eventIdMte2ToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_MTE3));
+        SetFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        WaitFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        uint32_t run_begin = 0;
+        uint64_t run_cell = CellOf(coordsLocal, 0, 0);
+        for (uint32_t i = 1; i <= length; i++) {
+            uint64_t cell = (i < length) ? CellOf(coordsLocal, i, 0) : 0;
+            if (i < length && cell == run_cell + (i - run_begin)) {
+                continue;
+            }
+            DataCopy(spatialFeaturesGm[run_cell * feature_size], featureLocal[run_begin * feature_size],
+                     (i - run_begin) * feature_size);
+            run_begin = i;
+            run_cell = cell;
+        }
+    }
+    
+    /**
+     * @brief 逐行并入各级累积行，写出本块内结束的粗cell
+     * 
+     * @param core_end 本块是否为本核的最后一块（末行结束所有步长的粗cell）
+     * @return 本块写出的粗cell数（各步长合计）
+     */
+    __aicore__ inline uint32_t Pool(uint32_t length, bool core_end)
+    {
+        if (level_num == 0) {
+            return 0;
+        }
+        LocalTensor<half> featureLocal = featureBuf.Get<half>();
+        LocalTensor<uint32_t> coordsLocal = coordsBuf.Get<uint32_t>();
+        // 特征搬入完成后才能做Vector计算；上一块的暂存行写出后才能覆盖
+        event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+        SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+        event_t eventIdMte3ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE3_V));
+        SetFlag<HardEvent::MTE3_V>(eventIdMte3ToV);
+        WaitFlag<HardEvent::MTE3_V>(eventIdMte3ToV);
+        for (uint32_t l = 0; l < level_num; l++) {
+            staged[l] = 0;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+            Accumulate(0, featureLocal[i * feature_size], 1);
+            // 粗cell按步长嵌套：较小步长的粗cell未结束时，更大步长的也未结束
+            bool row_end = core_end && i + 1 == length;
+            for (uint32_t l = 0; l < level_num; l++) {
+                if (!row_end && CellOf(coordsLocal, i, level_shift[l]) == CellOf(coordsLocal, i + 1, level_shift[l])) {
+                    break;
+                }
+                FinishCell(l, CellOf(coordsLocal, i, level_shift[l]));
+            }
+        }
+        
+        event_t eventIdVToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::V_MTE3));
+        SetFlag<HardEvent::V_MTE3>(eventIdVToMte3);
+        WaitFlag<HardEvent::V_MTE3>(eventIdVToMte3);
+        LocalTensor<half> stageLocal = stageBuf.Get<half>();
+        LocalTensor<uint32_t> stageCellLocal = stageCellBuf.Get<uint32_t>();
+        uint32_t pooled = 0;
+        for (uint32_t l = 0; l < level_num; l++) {
+            // 暂存行按粗cell升序排列，相邻粗cell连续的行合并写出
+            uint32_t base = l * tile_length;
+            uint32_t run_begin = 0;
+            for (uint32_t j = 1; j <= staged[l]; j++) {
+                if (j < staged[l] && stageCellLocal.GetValue(base + j) ==
+                                     stageCellLocal.GetValue(base + run_begin) + (j - run_begin)) {
+                    continue;
+                }
+                uint64_t cell = stageCellLocal.GetValue(base + run_begin);
+                DataCopy(spatialFeaturesGm[level_offset[l] + cell * feature_size],
+                         stageLocal[(base + run_begin) * feature_size], (j - run_begin) * feature_size);
+                run_begin = j;
+            }
+            pooled += staged[l];
+        }
+        return pooled;
+    }
+    
+    /**
+     * @brief 把count个cell的累积结果src并入第l级的累积行
+     */
+    __aicore__ inline void Accumulate(uint32_t l, const LocalTensor<half>& src, uint32_t count)
+    {
+        LocalTensor<half> accLocal = accBuf.Get<half>()[l * feature_size];
+        if (level_count[l] == 0) {
+            Muls(accLocal, src, static_cast<half>(1.0f), feature_size);
+        } else if (pool_mode == SCATTER_REDUCE_MAX) {
+            Max(accLocal, accLocal, src, feature_size);
+        } else {
+            Add(accLocal, accLocal, src, feature_size);
+        }
+        level_count[l] += count;
+    }
+    
+    /**
+     * @brief 第l级的粗cell结束：写入暂存区并并入下一级，累积行清空
+     * 
+     * MAX模式下窗口内有空cell（值为0）时结果不小于0；MEAN模式累积行保持为和，只在暂存时除以窗口大小。
+     */
+    __aicore__ inline void FinishCell(uint32_t l, uint32_t coarse_cell)
+    {
+        LocalTensor<half> accLocal = accBuf.Get<half>()[l * feature_size];
+        uint32_t window = 1u << (2 * level_shift[l]);
+        if (pool_mode == SCATTER_REDUCE_MAX && level_count[l] < window) {
+            Maxs(accLocal, accLocal, static_cast<half>(0), feature_size);
+        }
+        uint32_t slot = l * tile_length + staged[l];
+        float scale = (pool_mode == SCATTER_REDUCE_MEAN) ? 1.0f / window : 1.0f;
+        Muls(stageBuf.Get<half>()[slot * feature_size], accLocal, static_cast<half>(scale), feature_size);
+        stageCellBuf.Get<uint32_t>().SetValue(slot, coarse_cell);
+        staged[l]++;
+        if (l + 1 < level_num) {
+            Accumulate(l + 1, accLocal, level_count[l]);
+        }
+        level_count[l] = 0;
+    }
+    
+    /**
+     * @brief 块内第i行在步长 2^shift 的网格中的cell编号 (b * (ny>>shift) + (y>>shift)) * (nx>>shift) + (x>>shift)
+     */
+    __aicore__ inline uint64_t CellOf(const LocalTensor<uint32_t>& coordsLocal, uint32_t i, uint32_t shift)
+    {
+        uint64_t b = coordsLocal.GetValue(i * COORD_DIM + 0);
+        uint32_t y = coordsLocal.GetValue(i * COORD_DIM + 1) >> shift;
+        uint32_t x = coordsLocal.GetValue(i * COORD_DIM + 2) >> shift;
+        return (b * (ny >> shift) + y) * (nx >> shift) + x;
+    }
+
+private:
+    // ==================== 流水线和队列管理 ====================
+    TPipe pipe;
+    TBuf<TPosition::VECCALC> featureBuf;    // 当前块的特征
+    TBuf<TPosition::VECCALC> coordsBuf;     // 当前块及下一行的坐标
+    TBuf<TPosition::VECCALC> accBuf;        // 各级步长当前粗cell的累积行
+    TBuf<TPosition::VECCALC> stageBuf;      // 各级步长本块内结束的粗cell，块末写出
+    TBuf<TPosition::VECCALC> stageCellBuf;  // 暂存行对应的粗cell编号
+    
+    // ==================== 全局内存访问张量 ====================
+    GlobalTensor<half> pillarFeaturesGm;    // 排序去重后的pillar特征 [M, C]
+    GlobalTensor<uint32_t> coordsGm;        // 排序去重后的坐标 [M, 4]
+    GlobalTensor<half> spatialFeaturesGm;   // 全分辨率输出和各步长的池化输出
+    
+    // ==================== 分核和池化参数 ====================
+    uint32_t cell_begin;             // 当前Core负责的首个cell
+    uint32_t cell_num;               // 当前Core负责的cell数
+    uint32_t total_cells;            // 去重后的cell总数 M
+    uint32_t feature_size;           // 每个pillar的特征维度 C
+    uint32_t tile_length;            // 每块cell数
+    uint32_t nx;                     // BEV网格宽度
+    uint32_t ny;                     // BEV网格高度
+    uint32_t pool_mode;              // 池化方式（SCATTER_REDUCE_MAX/MEAN）
+    uint32_t level_num;              // 池化输出的个数
+    uint32_t level_shift[PILLAR_SCATTER_MAX_POOL_SHIFT];   // 各级步长的log2，升序
+    uint64_t level_offset[PILLAR_SCATTER_MAX_POOL_SHIFT];  // 各级输出在输出缓冲区中的元素偏移
+    uint32_t level_count[PILLAR_SCATTER_MAX_POOL_SHIFT];   // 各级当前粗cell已累积的cell数
+    uint32_t staged[PILLAR_SCATTER_MAX_POOL_SHIFT];        // 各级本块暂存的粗cell数
+    int32_t block_idx;               // 当前Core编号
+    KernelProfiler profiler;         // 性能剖析（PILLAR_SCATTER_PROFILE）
+};
+
+/**
+ * @brief PFN最大池化与scatter融合的kernel
+ * 
+ * PointPillars中scatter之前的PFN层把逐点特征 [P, N, C] 在点维度上取最大值得到 [P, C]，
+ * 写回GM后再由pillar_scatter_custom读出。本kernel直接读入逐点特征，在UB中按每个pillar的
+ * 有效点数做掩码最大值归约，再把归约结果写入BEV特征图，省去一次 [P, C] 的GM往返。
+ * 
+ * 归约在输入块内原地两两折半：宽度为w的点区间每次用一条Max把后半段并入前半段，
+ * 每个pillar只需log2(n)条Vector指令；最后一步直接写入输出块。
+ * 有效点数为0的pillar输出全零（与未被任何pillar覆盖的cell一致）。
+ * 填充和越界的pillar由CoordValidator跳过，不做归约，归约结果按合法pillar压缩存放。
+ * 
+ * 分核方式与KernelPillarScatter的STATIC调度相同（按pillar下标均分），仅支持half。
+ */
+class KernelPillarScatterPfn {
+public:
+    __aicore__ inline KernelPillarScatterPfn() {}
+    
+    /**
+     * @brief 初始化：按pillar均分，设置GM缓冲区和UB队列
+     * 
+     * @param point_features 逐点特征 [num_pillars, maxPoints, C] half，超出有效点数的部分不参与归约
+     * @param point_counts 每个pillar的有效点数 [num_pillars] uint32_t，末尾预留8个uint32_t
+     * @param workspace diagOffset处为各核的坐标校验诊断字
+     * 其余参数含义同KernelPillarScatter::Init
+     */
+    __aicore__ inline void Init(GM_ADDR point_features, GM_ADDR point_counts, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace, GM_ADDR spatial_features)
+    {
+        // ==================== 1. 解析参数 ====================
+        int32_t current_block_idx = GetBlockIdx();
+        block_idx = current_block_idx;
+        int32_t block_num = GetBlockNum();
+        total_pillars = *((__gm__ uint32_t*)params);
+        feature_size = tiling.featureSize;
+        max_points = tiling.maxPoints;
+        tile_length = tiling.tileLength;
+        nx = tiling.nx;
+        ny = tiling.ny;
+        validator.Init(tiling);
+        diag_offset = tiling.diagOffset;
+        diag_workspace = workspace;
+        
+        // ==================== 2. 按pillar均分 ====================
+        uint32_t tail_length = total_pillars / block_num;
+        uint32_t former_num = total_pillars % block_num;
+        if (current_block_idx < static_cast<int32_t>(former_num)) {
+            pillar_start_idx = current_block_idx * (tail_length + 1);
+            num_pillars_to_process = tail_length + 1;
+        } else {
+            pillar_start_idx = former_num * (tail_length + 1) + (current_block_idx - former_num) * tail_length;
+            num_pillars_to_process = tail_length;
+        }
+        
+        // ==================== 3. 全局内存缓冲区设置 ====================
+        uint64_t point_row = static_cast<uint64_t>(max_points) * feature_size;
+        pointFeaturesGm.SetGlobalBuffer((__gm__ half*)point_features, total_pillars * point_row);
+        pointCountsGm.SetGlobalBuffer((__gm__ uint32_t*)point_counts, total_pillars + COORD_ALIGN);
+        coordsGm.SetGlobalBuffer((__gm__ uint32_t*)coords, total_pillars * COORD_DIM + COORD_ALIGN);
+        spatialFeaturesGm.SetGlobalBuffer((__gm__ half*)spatial_features,
+                                          static_cast<uint64_t>(tiling.batchSize) * ny * nx * feature_size);
+        
+        // ==================== 4. 本地内存队列初始化 ====================
+        pipe.InitBuffer(pointQueue, BUFFER_NUM, tile_length * point_row * sizeof(half));
+        pipe.InitBuffer(outQueue, BUFFER_NUM, tile_length * feature_size * sizeof(half));
+        pipe.InitBuffer(coordsQueue, BUFFER_NUM, AlignUp(tile_length * COORD_DIM, COORD_ALIGN) * sizeof(uint32_t));
+        // 有效点数从8字对齐的位置开始搬运，最多多搬8个字
+        pipe.InitBuffer(countsQueue, BUFFER_NUM, (AlignUp(tile_length, COORD_ALIGN) + COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(offsetBuf, AlignUp(tile_length, COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(diagBuf, PILLAR_SCATTER_DIAG_DIM * sizeof(uint32_t));
+    }
+    
+    /**
+     * @brief 主处理流程：按tile_length分块执行 CopyIn -> Compute -> CopyOut，最后写出诊断字
+     */
+    __aicore__ inline void Process()
+    {
+        for (uint32_t offset = 0; offset < num_pillars_to_process; offset += tile_length) {
+            uint32_t length = (offset + tile_length <= num_pillars_to_process) ? tile_length
+                                                                                : num_pillars_to_process - offset;
+            CopyIn(pillar_start_idx + offset, length);
+            uint32_t valid = Compute(length);
+            CopyOut(valid);
+        }
+        validator.Store(pipe, diagBuf.Get<uint32_t>(), diag_workspace, diag_offset, block_idx);
+    }
+
+private:
+    /**
+     * @brief 将一块pillar的逐点特征、有效点数和坐标从GM搬入UB
+     */
+    __aicore__ inline void CopyIn(uint32_t start, uint32_t length)
+    {
+        LocalTensor<half> pointLocal = pointQueue.AllocTensor<half>();
+        LocalTensor<uint32_t> coordsLocal = coordsQueue.AllocTensor<uint32_t>();
+        LocalTensor<uint32_t> countsLocal = countsQueue.AllocTensor<uint32_t>();
+        
+        uint64_t point_row = static_cast<uint64_t>(max_points) * feature_size;
+        DataCopy(pointLocal, pointFeaturesGm[start * point_row], length * point_row);
+        DataCopy(coordsLocal, coordsGm[static_cast<uint64_t>(start) * COORD_DIM],
+                 AlignUp(length * COORD_DIM, COORD_ALIGN));
+        // 有效点数按32字节向上取整搬运，起始位置需按8个uint32_t对齐，多搬的部分不使用
+        uint32_t counts_begin = start / COORD_ALIGN * COORD_ALIGN;
+        counts_skip = start - counts_begin;
+        DataCopy(countsLocal, pointCountsGm[counts_begin], AlignUp(counts_skip + length, COORD_ALIGN));
+        
+        pointQueue.EnQue(pointLocal);
+        coordsQueue.EnQue(coordsLocal);
+        countsQueue.EnQue(countsLocal);
+    }
+    
+    /**
+     * @brief 校验坐标，对每个合法pillar的有效点做最大值归约
+     * 
+     * 第k个合法pillar的cell和归约结果分别写入offsetBuf的第k项和outLocal的第k行。
+     * @return 本块合法pillar数
+     */
+    __aicore__ inline uint32_t Compute(uint32_t length)
+    {
+        LocalTensor<half> pointLocal = pointQueue.DeQue<half>();
+        LocalTensor<uint32_t> coordsLocal = coordsQueue.DeQue<uint32_t>();
+        LocalTensor<uint32_t> countsLocal = countsQueue.DeQue<uint32_t>();
+        LocalTensor<half> outLocal = outQueue.AllocTensor<half>();
+        LocalTensor<uint32_t> offsetLocal = offsetBuf.Get<uint32_t>();
+        
+        // 坐标和有效点数由标量单元读取，需要等待MTE2搬运完成
+        event_t eventIdMte2ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_S));
+        SetFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        WaitFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        
+        uint32_t valid = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            // ==================== 1. 校验坐标，计算输出cell ====================
+            uint32_t batch = coordsLocal.GetValue(i * COORD_DIM + 0);
+            uint32_t y = coordsLocal.GetValue(i * COORD_DIM + 1);
+            uint32_t x = coordsLocal.GetValue(i * COORD_DIM + 2);
+            if (!validator.Check(batch, y, x)) {
+                continue;
+            }
+            offsetLocal.SetValue(valid, (batch * ny + y) * nx + x);
+            
+            // ==================== 2. 有效点最大值归约 ====================
+            uint32_t count = countsLocal.GetValue(counts_skip + i);
+            count = (count < max_points) ? count : max_points;
+            LocalTensor<half> points = pointLocal[i * max_points * feature_size];
+            LocalTensor<half> reduced = outLocal[valid * feature_size];
+            valid++;
+            if (count == 0) {
+                Duplicate(reduced, static_cast<half>(0), feature_size);
+                continue;
+            }
+            if (count == 1) {
+                DataCopy(reduced, points, feature_size);
+                continue;
+            }
+            // 两两折半：把 [w-h, w) 并入 [0, h)，h = w/2，直到只剩2个点
+            uint32_t width = count;
+            while (width > 2) {
+                uint32_t half_width = width / 2;
+                Max(points, points, points[(width - half_width) * feature_size], half_width * feature_size);
+                width -= half_width;
+            }
+            Max(reduced, points, points[feature_size], feature_size);
+        }
+        
+        outQueue.EnQue(outLocal);
+        pointQueue.FreeTensor(pointLocal);
+        coordsQueue.FreeTensor(coordsLocal);
+        countsQueue.FreeTensor(countsLocal);
+        return valid;
+    }
+    
+    /**
+     * @brief 将归约后的合法pillar特征逐行写入BEV特征图
+     */
+    __aicore__ inline void CopyOut(uint32_t valid)
+    {
+        LocalTensor<half> outLocal = outQueue.DeQue<half>();
+        LocalTensor<uint32_t> offsetLocal = offsetBuf.Get<uint32_t>();
+        for (uint32_t i = 0; i < valid; i++) {
+            uint64_t offset = static_cast<uint64_t>(offsetLocal.GetValue(i)) * feature_size;
+            DataCopy(spatialFeaturesGm[offset], outLocal[i * feature_size], feature_size);
+        }
+        outQueue.FreeTensor(outLocal);
+    }
+
+private:
+    // ==================== 流水线和队列管理 ====================
+    TPipe pipe;
+    TQue<QuePosition::VECIN, BUFFER_NUM> pointQueue;    // 逐点特征块队列
+    TQue<QuePosition::VECOUT, BUFFER_NUM> outQueue;     // 归约结果块队列
+    TQue<QuePosition::VECIN, BUFFER_NUM> coordsQueue;   // 坐标块队列
+    TQue<QuePosition::VECIN, BUFFER_NUM> countsQueue;   // 有效点数块队列
+    TBuf<TPosition::VECCALC> offsetBuf;                 // 当前块合法pillar的输出cell索引
+    TBuf<TPosition::VECCALC> diagBuf;                   // 诊断字写出缓冲
+    
+    // ==================== 全局内存访问张量 ====================
+    GlobalTensor<half> pointFeaturesGm;       // 逐点特征
+    GlobalTensor<uint32_t> pointCountsGm;     // 每个pillar的有效点数
+    GlobalTensor<uint32_t> coordsGm;          // 坐标
+    GlobalTensor<half> spatialFeaturesGm;     // 输出特征图
+    
+    // ==================== 分片和网格参数 ====================
+    uint32_t pillar_start_idx;       // 当前Core处理的起始pillar索引
+    uint32_t num_pillars_to_process; // 当前Core需要处理的pillar数
+    uint32_t total_pillars;          // 全局pillar总数
+    uint32_t counts_skip;            // 当前块有效点数在countsLocal中的起始偏移
+    uint32_t nx;                     // BEV特征图宽度
+    uint32_t ny;                     // BEV特征图高度
+    uint32_t feature_size;           // 每个pillar的特征维度 C
+    uint32_t max_points;             // 每个pillar的最大点数 N
+    uint32_t tile_length;            // 每块pillar数
+    int32_t block_idx;               // 当前Core编号
+    
+    // ==================== 坐标校验 ====================
+    CoordValidator validator;        // 跳过填充/越界条目并计数
+    uint32_t diag_offset;            // workspace中诊断字的偏移
+    GM_ADDR diag_workspace;          // workspace基址
+};
+
+// 按特征类型实例化的PillarScatter kernel，供DispatchFeatureSize按通道数分发
+template <int32_t FIXED_C>
+using KernelPillarScatterHalf = KernelPillarScatter<half, half, FIXED_C>;
+template <int32_t FIXED_C>
+using KernelPillarScatterFloat = KernelPillarScatter<float, float, FIXED_C>;
+template <int32_t FIXED_C>
+using KernelPillarScatterInt8 = KernelPillarScatter<int8_t, half, FIXED_C>;
+/**
+ * @brief NHWC -> NCHW 转置kernel，作为NCHW_TRANSPOSE布局的对比基线
+ * 
+ * 对应生产中scatter之后单独的转置算子：按BEV行分核，每段cell整段读入UB，
+ * 用与BAND模式NCHW输出相同的UB转置写出通道平面，比BAND模式多一次整张特征图的读入和写出。
+ */
+class KernelNhwcToNchw {
+public:
+    __aicore__ inline KernelNhwcToNchw() {}
+    
+    /**
+     * @brief 初始化：按行均分输入
+     * 
+     * @param nhwc_features 输入特征图 [B, ny, nx, C] half
+     * @param tiling tiling数据，使用nx/ny/batchSize/featureSize/tileLength
+     * @param nchw_features 输出特征图 [B, C, ny, nx] half
+     */
+    __aicore__ inline void Init(GM_ADDR nhwc_features, const PillarScatterTilingData& tiling, GM_ADDR nchw_features)
+    {
+        int32_t current_block_idx = GetBlockIdx();
+        int32_t block_num = GetBlockNum();
+        feature_size = tiling.featureSize;
+        segment_length = tiling.tileLength / TRANS_BLOCK * TRANS_BLOCK;
+        nx = tiling.nx;
+        ny = tiling.ny;
+        uint32_t row_num = tiling.batchSize * tiling.ny;
+        uint32_t tail_rows = row_num / block_num;
+        uint32_t former_num = row_num % block_num;
+        if (current_block_idx < static_cast<int32_t>(former_num)) {
+            row_begin = current_block_idx * (tail_rows + 1);
+            row_end = row_begin + tail_rows + 1;
+        } else {
+            row_begin = former_num * (tail_rows + 1) + (current_block_idx - former_num) * tail_rows;
+            row_end = row_begin + tail_rows;
+        }
+        
+        uint64_t total = static_cast<uint64_t>(row_num) * nx * feature_size;
+        nhwcGm.SetGlobalBuffer((__gm__ half*)nhwc_features, total);
+        nchwGm.SetGlobalBuffer((__gm__ half*)nchw_features, total);
+        pipe.InitBuffer(inQueue, BUFFER_NUM, segment_length * feature_size * sizeof(half));
+        pipe.InitBuffer(planeQueue, BUFFER_NUM, segment_length * feature_size * sizeof(half));
+    }
+    
+    /**
+     * @brief 逐行逐段 读入 -> 转置 -> 写出
+     */
+    __aicore__ inline void Process()
+    {
+        uint64_t plane_size = static_cast<uint64_t>(ny) * nx;
+        for (uint32_t row = row_begin; row < row_end; row++) {
+            for (uint32_t x_begin = 0; x_begin < nx; x_begin += segment_length) {
+                uint32_t cells = (x_begin + segment_length <= nx) ? segment_length : nx - x_begin;
+                
+                LocalTensor<half> segmentLocal = inQueue.AllocTensor<half>();
+                DataCopy(segmentLocal, nhwcGm[(static_cast<uint64_t>(row) * nx + x_begin) * feature_size],
+                         cells * feature_size);
+                inQueue.EnQue(segmentLocal);
+                
+                segmentLocal = inQueue.DeQue<half>();
+                LocalTensor<half> planeLocal = planeQueue.AllocTensor<half>();
+                TransposeToPlanes(planeLocal, segmentLocal, cells, feature_size);
+                planeQueue.EnQue(planeLocal);
+                inQueue.FreeTensor(segmentLocal);
+                
+                planeLocal = planeQueue.DeQue<half>();
+                uint64_t offset = static_cast<uint64_t>(row / ny) * feature_size * plane_size +
+                                  static_cast<uint64_t>(row % ny) * nx + x_begin;
+                WritePlanes(nchwGm, planeLocal, offset, plane_size, cells, feature_size);
+                planeQueue.FreeTensor(planeLocal);
+            }
+        }
+    }
+
+private:
+    TPipe pipe;
+    TQue<QuePosition::VECIN, BUFFER_NUM> inQueue;      // NHWC段
+    TQue<QuePosition::VECOUT, BUFFER_NUM> planeQueue;  // 转置后的通道平面
+    GlobalTensor<half> nhwcGm;
+    GlobalTensor<half> nchwGm;
+    uint32_t row_begin;              // 当前Core负责的起始行（含）
+    uint32_t row_end;                // 当前Core负责的结束行（不含）
+    uint32_t nx;                     // BEV特征图宽度
+    uint32_t ny;                     // BEV特征图高度
+    uint32_t feature_size;           // 通道数 C
+    uint32_t segment_length;         // 每段cell数，16的倍数
+};
+
+/**
+ * @brief PillarGather kernel：PillarScatter的反向（伴随）
+ * 
+ * 按cell把输出梯度 [B, ny, nx, C] 读回每个pillar，写出pillar梯度 [P, C]。
+ * 坐标校验和按下标均分的分核与PILLAR模式的前向相同；每块先把各pillar所在cell的梯度行逐行搬入UB
+ * （cell和下标都连续的一串pillar合并为一次搬运），再整块连续写出。
+ * 重复坐标按前向的归约语义分配梯度，份数由host写入坐标的保留字段 coords[:, 3]：
+ * 覆盖模式下同一cell只有最后一个pillar为1、其余为0，MEAN为该cell的pillar数n（梯度乘以1/n），SUM均为1。
+ * 份数为0的pillar和非法条目的梯度为0。
+ * 
+ * @tparam T 梯度类型（half/float；bf16按16位原样搬运，只有MEAN需要数值运算，而MEAN只支持half）
+ * @tparam FIXED_C 编译期通道数，为0时取自tiling
+ */
+template <typename T, int32_t FIXED_C>
+class KernelPillarGather {
+public:
+    __aicore__ inline KernelPillarGather() {}
+    
+    /**
+     * @brief 初始化：按下标均分pillar，申请梯度块、坐标块和份数缓冲
+     * 
+     * @param spatial_grad 输出梯度 [B, ny, nx, C]，NHWC
+     * @param coords 前向的坐标 [num_pillars, 4]，coords[:, 3] 为host写入的梯度份数
+     * @param params params[0]为条目数
+     * @param tiling 使用nx/ny/batchSize/featureSize/tileLength/former/tail/reduceMode/diagOffset
+     * @param workspace diagOffset处为各核的坐标校验诊断字
+     * @param pillar_grad pillar梯度 [num_pillars, C]
+     */
+    __aicore__ inline void Init(GM_ADDR spatial_grad, GM_ADDR coords, GM_ADDR params,
+                                const PillarScatterTilingData& tiling, GM_ADDR workspace, GM_ADDR pillar_grad)
+    {
+        profiler.Start();
+        int32_t current_block_idx = GetBlockIdx();
+        int32_t block_num = GetBlockNum();
+        uint32_t total_pillars = *((__gm__ uint32_t*)params);
+        feature_size = (FIXED_C > 0) ? FIXED_C : tiling.featureSize;
+        tile_length = (FIXED_C > 0) ? PILLAR_SCATTER_TILE_BYTES / (FIXED_C * sizeof(T)) : tiling.tileLength;
+        nx = tiling.nx;
+        ny = tiling.ny;
+        reduce_mode = tiling.reduceMode;
+        block_idx = current_block_idx;
+        validator.Init(tiling);
+        diag_offset = tiling.diagOffset;
+        diag_workspace = workspace;
+        
+        // 与前向相同的former/tail分片，tiling与实际launch不一致时现算
+        uint32_t former_num = tiling.formerNum;
+        uint32_t former_length = tiling.formerLength;
+        uint32_t tail_length = tiling.tailLength;
+        if (tiling.coreNum != static_cast<uint32_t>(block_num) || tiling.totalPillars != total_pillars) {
+            tail_length = total_pillars / block_num;
+            former_num = total_pillars % block_num;
+            former_length = tail_length + 1;
+        }
+        if (current_block_idx < static_cast<int32_t>(former_num)) {
+            pillar_start_idx = current_block_idx * former_length;
+            num_pillars_to_process = former_length;
+        } else {
+            pillar_start_idx = former_num * former_length + (current_block_idx - former_num) * tail_length;
+            num_pillars_to_process = tail_length;
+        }
+        
+        spatialGradGm.SetGlobalBuffer((__gm__ T*)spatial_grad,
+                                      static_cast<uint64_t>(tiling.batchSize) * ny * nx * feature_size);
+        coordsGm.SetGlobalBuffer((__gm__ uint32_t*)coords, total_pillars * COORD_DIM + COORD_ALIGN);
+        pillarGradGm.SetGlobalBuffer((__gm__ T*)pillar_grad, static_cast<uint64_t>(total_pillars) * feature_size);
+        
+        pipe.InitBuffer(gradQueue, BUFFER_NUM, tile_length * feature_size * sizeof(T));
+        pipe.InitBuffer(coordsQueue, BUFFER_NUM, AlignUp(tile_length * COORD_DIM, COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(shareBuf, AlignUp(tile_length, COORD_ALIGN) * sizeof(uint32_t));
+        pipe.InitBuffer(diagBuf, PILLAR_SCATTER_DIAG_DIM * sizeof(uint32_t));
+        profiler.Init(pipe, tiling, workspace);
+        profiler.Mark(SCATTER_PROFILE_INIT);
+    }
+    
+    /**
+     * @brief 逐块 搬入坐标 -> 按cell搬入梯度行并修正份数 -> 连续写出，最后写出诊断字
+     */
+    __aicore__ inline void Process()
+    {
+        for (uint32_t offset = 0; offset < num_pillars_to_process; offset += tile_length) {
+            uint32_t length = (offset + tile_length <= num_pillars_to_process) ? tile_length
+                                                                               : num_pillars_to_process - offset;
+            uint32_t start = pillar_start_idx + offset;
+            CopyIn(start, length);
+            uint32_t gathered = Gather(length);
+            CopyOut(start, length);
+            profiler.Add(SCATTER_PROFILE_TILES, 1);
+            profiler.Add(SCATTER_PROFILE_ENTRIES, length);
+            profiler.Add(SCATTER_PROFILE_WRITTEN, gathered);
+            profiler.Add(SCATTER_PROFILE_SKIPPED, length - gathered);
+            profiler.Add(SCATTER_PROFILE_BYTES_IN, length * COORD_DIM * sizeof(uint32_t) +
+                                                   gathered * feature_size * sizeof(T));
+            profiler.Add(SCATTER_PROFILE_BYTES_OUT, length * feature_size * sizeof(T));
+        }
+        validator.Store(pipe, diagBuf.Get<uint32_t>(), diag_workspace, diag_offset, block_idx);
+        profiler.Mark(SCATTER_PROFILE_TAIL);
+        profiler.Store(pipe, block_idx);
+    }
+
+private:
+    __aicore__ inline void CopyIn(uint32_t start, uint32_t length)
+    {
+        LocalTensor<uint32_t> coordsLocal = coordsQueue.AllocTensor<uint32_t>();
+        DataCopy(coordsLocal, coordsGm[static_cast<uint64_t>(start) * COORD_DIM],
+                 AlignUp(length * COORD_DIM, COORD_ALIGN));
+        coordsQueue.EnQue(coordsLocal);
+    }
+    
+    /**
+     * @brief 把一块pillar所在cell的梯度行搬入UB，份数不为1的行在搬运完成后清零或缩放
+     * 
+     * @return 读到梯度（份数不为0的合法条目）的pillar数
+     */
+    __aicore__ inline uint32_t Gather(uint32_t length)
+    {
+        LocalTensor<uint32_t> coordsLocal = coordsQueue.DeQue<uint32_t>();
+        LocalTensor<uint32_t> shareLocal = shareBuf.Get<uint32_t>();
+        LocalTensor<T> gradLocal = gradQueue.AllocTensor<T>();
+        
+        // 坐标由标量单元读取，需要等待MTE2搬运完成
+        event_t eventIdMte2ToS = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_S));
+        SetFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        WaitFlag<HardEvent::MTE2_S>(eventIdMte2ToS);
+        
+        uint32_t gathered = 0;
+        bool fixup = false;
+        uint32_t run_begin = 0;
+        uint32_t run_length = 0;
+        uint32_t run_cell = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            uint32_t batch = coordsLocal.GetValue(i * COORD_DIM + 0);
+            uint32_t y = coordsLocal.GetValue(i * COORD_DIM + 1);
+            uint32_t x = coordsLocal.GetValue(i * COORD_DIM + 2);
+            uint32_t share = 0;
+            if (validator.Check(batch, y, x)) {
+                share = (reduce_mode == SCATTER_REDUCE_SUM) ? 1
+                                                            : coordsLocal.GetValue(i * COORD_DIM + PILLAR_GATHER_SHARE_FIELD);
+            }
+            shareLocal.SetValue(i, share);
+            fixup = fixup || share != 1;
+            if (share == 0) {
+                continue;
+            }
+            gathered++;
+            uint32_t cell = (batch * ny + y) * nx + x;
+            // 下标和cell都连续的pillar在UB和输出梯度中都连续，合并为一次搬运
+            if (run_length > 0 && i == run_begin + run_length && cell == run_cell + run_length) {
+                run_length++;
+                continue;
+            }
+            FlushRun(gradLocal, run_begin, run_cell, run_length);
+            run_begin = i;
+            run_cell = cell;
+            run_length = 1;
+        }
+        FlushRun(gradLocal, run_begin, run_cell, run_length);
+        coordsQueue.FreeTensor(coordsLocal);
+        profiler.Mark(SCATTER_PROFILE_COPY_IN);
+        
+        if (fixup) {
+            event_t eventIdMte2ToV = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_V));
+            SetFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+            WaitFlag<HardEvent::MTE2_V>(eventIdMte2ToV);
+            for (uint32_t i = 0; i < length; i++) {
+                uint32_t share = shareLocal.GetValue(i);
+                if (share == 0) {
+                    Duplicate(gradLocal[i * feature_size], static_cast<T>(0), feature_size);
+                } else if (share > 1) {
+                    Muls(gradLocal[i * feature_size], gradLocal[i * feature_size], static_cast<T>(1.0f / share),
+                         feature_size);
+                }
+            }
+        }
+        // 梯度搬入(MTE2)完成后才能整块写出(MTE3)
+        event_t eventIdMte2ToMte3 = static_cast<event_t>(pipe.FetchEventID(HardEvent::MTE2_MTE3));
+        SetFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        WaitFlag<HardEvent::MTE2_MTE3>(eventIdMte2ToMte3);
+        gradQueue.EnQue(gradLocal);
+        return gathered;
+    }
+    
+    __aicore__ inline void FlushRun(const LocalTensor<T>& gradLocal, uint32_t run_begin, uint32_t run_cell,
+                                    uint32_t run_length)
+    {
+        if (run_length > 0) {
+            DataCopy(gradLocal[run_begin * feature_size], spatialGradGm[static_cast<uint64_t>(run_cell) * feature_size],
+                     run_length * feature_size);
+        }
+    }
+    
+    /**
+     * @brief 整块pillar梯度连续写出，非法和不分得梯度的行已在UB中清零
+     */
+    __aicore__ inline void CopyOut(uint32_t start, uint32_t length)
+    {
+        LocalTensor<T> gradLocal = gradQueue.DeQue<T>();
+        DataCopy(pillarGradGm[static_cast<uint64_t>(start) * feature_size], gradLocal, length * feature_size);
+        gradQueue.FreeTensor(gradLocal);
+        profiler.Mark(SCATTER_PROFILE_SCATTER);
+    }
+
+private:
+    TPipe pipe;
+    TQue<QuePosition::VECOUT, BUFFER_NUM> gradQueue;    // 一块pillar的梯度（GM梯度图 -> UB -> GM）
+    TQue<QuePosition::VECIN, BUFFER_NUM> coordsQueue;   // 坐标块
+    TBuf<TPosition::VECCALC> shareBuf;                  // 当前块各pillar的梯度份数，0表示清零
+    TBuf<TPosition::VECCALC> diagBuf;                   // 诊断字写出缓冲
+    GlobalTensor<T> spatialGradGm;
+    GlobalTensor<uint32_t> coordsGm;
+    GlobalTensor<T> pillarGradGm;
+    uint32_t pillar_start_idx;       // 当前Core处理的起始pillar索引
+    uint32_t num_pillars_to_process; // 当前Core处理的pillar数
+    uint32_t nx;                     // BEV特征图宽度
+    uint32_t ny;                     // BEV特征图高度
+    uint32_t feature_size;           // 通道数 C
+    uint32_t tile_length;            // 每块pillar数
+    uint32_t reduce_mode;            // 前向的PillarScatterReduce
+    int32_t block_idx;               // 当前Core编号
+    
+    // ==================== 坐标校验 ====================
+    CoordValidator validator;        // 跳过填充/越界条目并计数
+    uint32_t diag_offset;            // workspace中诊断字的偏移
+    GM_ADDR diag_workspace;          // workspace基址
+    KernelProfiler profiler;         // 性能剖析（PILLAR_SCATTER_PROFILE）
+};
+
+template <int32_t FIXED_C>
+using KernelPillarGatherHalf = KernelPillarGather<half, FIXED_C>;
+template <int32_t FIXED_C>
+using KernelPillarGatherFloat = KernelPillarGather<float, FIXED_C>;
+
+#if defined(__CCE_AICORE__) && (__CCE_AICORE__ >= 220)
+template <int32_t FIXED_C>
+using KernelPillarScatterBf16 = KernelPillarScatter<bfloat16_t, bfloat16_t, FIXED_C>;
+#else
+// 不支持bfloat16_t的芯片上按16位原样搬运，scatter不做数值运算，结果逐位一致
+template <int32_t FIXED_C>
+using KernelPillarScatterBf16 = KernelPillarScatter<half, half, FIXED_C>;
+#endif
+
+/**
+ * @brief 运行单个kernel实例
+ */
+template <typename KernelT>
+__aicore__ inline void RunKernel(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                 const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                 GM_ADDR spatial_features)
+{
+    KernelT op;
+    op.Init(pillar_features, coords, params, tiling, workspace, spatial_features);  // 初始化和数据分片
+    op.Process();  // 执行主要的scatter操作
+}
+
+/**
+ * @brief 按通道数分发到对应的kernel实例（32/64/128走编译期快速路径）
+ */
+template <template <int32_t> class KernelT>
+__aicore__ inline void DispatchFeatureSize(GM_ADDR pillar_features, GM_ADDR coords, GM_ADDR params,
+                                           const PillarScatterTilingData& tiling, GM_ADDR workspace,
+                                           GM_ADDR spatial_features)
+{
+    switch (tiling.featureSize) {
+        case 32:
+            RunKernel<KernelT<32>>(pillar_features, coords, params, tiling, workspace, spatial_features);
+            break;
+        case 64:
+            RunKernel<KernelT<64>>(pillar_features, coords, params, tiling, workspace, spatial_features);
+            break;
+        case 128:
+            RunKernel<KernelT<128>>(pillar_features, coords, params, tiling, workspace, spatial_features);
+            break;
+        default:
+            RunKernel<KernelT<0>>(pillar_features, coords, params, tiling, workspace, spatial_features);
+            break;
+    }
+}
+
+extern "C" __global__ __aicore__ void pillar_scatter_custom(GM_ADDR pillar_features, 
+                                                            GM_ADDR coords, 
+                                                            GM_ADDR params, 
+                                                            GM_ADDR tiling,
+                                                            GM_ADDR workspace,
+                                                            GM_ADDR spatial_features)
+{
+    PillarScatterTilingData tilingData;
+    CopyTiling(&tilingData, tiling);
+    
+    if (tilingData.scatterMode == SCATTER_MODE_BAND) {
+        DispatchFeatureSize<KernelPillarScatterBand>(pillar_features, coords, params, tilingData, workspace,
+                                                     spatial_features);
+    } else if (tilingData.scatterMode == SCATTER_MODE_INCREMENTAL) {
+        DispatchFeatureSize<KernelPillarScatterIncremental>(pillar_features, coords, params, tilingData, workspace,
+                                                            spatial_features);
+    } else if (tilingData.scatterMode == SCATTER_MODE_CSR) {
+        DispatchFeatureSize<KernelPillarScatterCsr>(pillar_features, coords, params, tilingData, workspace,
+                                                    spatial_features);
+    } else if (tilingData.scatterMode == SCATTER_MODE_MULTIRES) {
+        DispatchFeatureSize<KernelPillarScatterMultiRes>(pillar_features, coords, params, tilingData, workspace,
+                                                         spatial_features);
+    } else if (tilingData.inputDtype == SCATTER_DTYPE_INT8) {
+        DispatchFeatureSize<KernelPillarScatterInt8>(pillar_features, coords, params, tilingData, workspace,
+                                                     spatial_features);
+    } else if (tilingData.inputDtype == SCATTER_DTYPE_FP32) {
+        DispatchFeatureSize<KernelPillarScatterFloat>(pillar_features, coords, params, tilingData, workspace,
+                                                      spatial_features);
+    } else if (tilingData.inputDtype == SCATTER_DTYPE_BF16) {
+        DispatchFeatureSize<KernelPillarScatterBf16>(pillar_features, coords, params, tilingData, workspace,
+                                                     spatial_features);
+    } else {
+        DispatchFeatureSize<KernelPillarScatterHalf>(pillar_features, coords, params, tilingData, workspace,
+                                                     spatial_features);
+    }
+}
+
+/**
+ * @brief PFN最大池化与scatter融合的入口
+ * 
+ * 与pillar_scatter_custom相比，输入为逐点特征 [P, maxPoints, C] 及每个pillar的有效点数 [P]，
+ * 其余参数相同；tiling中的scatterMode应为PILLAR，tileLength为每块pillar数。
+ */
+extern "C" __global__ __aicore__ void pillar_scatter_pfn_custom(GM_ADDR point_features,
+                                                                GM_ADDR point_counts,
+                                                                GM_ADDR coords,
+                                                                GM_ADDR params,
+                                                                GM_ADDR tiling,
+                                                                GM_ADDR workspace,
+                                                                GM_ADDR spatial_features)
+{
+    PillarScatterTilingData tilingData;
+    CopyTiling(&tilingData, tiling);
+    
+    KernelPillarScatterPfn op;
+    op.Init(point_features, point_counts, coords, params, tilingData, workspace, spatial_features);
+    op.Process();
+}
+
+/**
+ * @brief NHWC -> NCHW 转置入口，NCHW_TRANSPOSE布局下紧接pillar_scatter_custom执行
+ */
+extern "C" __global__ __aicore__ void pillar_scatter_transpose_custom(GM_ADDR nhwc_features,
+                                                                      GM_ADDR tiling,
+                                                                      GM_ADDR nchw_features)
+{
+    PillarScatterTilingData tilingData;
+    CopyTiling(&tilingData, tiling);
+    
+    KernelNhwcToNchw op;
+    op.Init(nhwc_features, tilingData, nchw_features);
+    op.Process();
+}
+
+/**
+ * @brief PillarGather（反向）入口：由输出梯度 [B, ny, nx, C] 按坐标读出pillar梯度 [P, C]
+ * 
+ * 参数与pillar_scatter_custom对应：spatial_grad取代pillar_features作为输入，pillar_grad为输出；
+ * tiling按PILLAR模式、STATIC调度生成，reduceMode为前向的归约方式。fp32走float实例，其余16位类型按half搬运。
+ */
+extern "C" __global__ __aicore__ void pillar_gather_custom(GM_ADDR spatial_grad,
+                                                           GM_ADDR coords,
+                                                           GM_ADDR params,
+                                                           GM_ADDR tiling,
+                                                           GM_ADDR workspace,
+                                                           GM_ADDR pillar_grad)
+{
+    PillarScatterTilingData tilingData;
+    CopyTiling(&tilingData, tiling);
+    
+    if (tilingData.inputDtype == SCATTER_DTYPE_FP32) {
+        DispatchFeatureSize<KernelPillarGatherFloat>(spatial_grad, coords, params, tilingData, workspace,
+                                                     pillar_grad);
+    } else {
+        DispatchFeatureSize<KernelPillarGatherHalf>(spatial_grad, coords, params, tilingData, workspace,
+                                                    pillar_grad);
+    }
+}
+
+#ifndef ASCENDC_CPU_DEBUG
+void pillar_scatter_do(uint32_t blockDim, void *stream, GM_ADDR pillar_features, 
+                                                            GM_ADDR coords, 
+                                                            GM_ADDR params, 
+                                                            GM_ADDR tiling,
+                                                            GM_ADDR workspace,
+                                                            GM_ADDR spatial_features)
+{
+    pillar_scatter_custom<<<blockDim, nullptr, stream>>>(pillar_features, coords, params, tiling, workspace,
+                                                         spatial_features);
+}
+
+void pillar_scatter_pfn_do(uint32_t blockDim, void *stream, GM_ADDR point_features,
+                                                                GM_ADDR point_counts,
+                                                                GM_ADDR coords,
+                                                                GM_ADDR params,
+                                                                GM_ADDR tiling,
+                                                                GM_ADDR workspace,
+                                                                GM_ADDR spatial_features)
+{
+    pillar_scatter_pfn_custom<<<blockDim, nullptr, stream>>>(point_features, point_counts, coords, params, tiling,
+                                                             workspace, spatial_features);
+}
+
+void pillar_scatter_transpose_do(uint32_t blockDim, void *stream, GM_ADDR nhwc_features, GM_ADDR tiling,
+                                 GM_ADDR nchw_features)
+{
+    pillar_scatter_transpose_custom<<<blockDim, nullptr, stream>>>(nhwc_features, tiling, nchw_features);
+}
+
+void pillar_gather_do(uint32_t blockDim, void *stream, GM_ADDR spatial_grad, GM_ADDR coords, GM_ADDR params,
+                      GM_ADDR tiling, GM_ADDR workspace, GM_ADDR pillar_grad)
 {
-    pillar_scatter_custom<<<blockDim, nullptr, stream>>>(pillar_features, coords, params, spatial_features);
+    pillar_gather_custom<<<blockDim, nullptr, stream>>>(spatial_grad, coords, params, tiling, workspace, pillar_grad);
 }
-#endif
\ No newline at end of file
+#endif
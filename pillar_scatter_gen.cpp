@@ -0,0 +1,134 @@
+/**
+ * @file pillar_scatter_gen.cpp
+ *
+ * PillarScatter算子的输入数据生成工具。
+ * 按种子、pillar数、网格大小、空间分布、重复坐标比例、越界比例和填充比例生成可复现的合成LiDAR场景，
+ * 写出 <前缀>_x.bin（特征 [P, C]）和 <前缀>_coords.bin（坐标 [P, 4] uint32），可直接作为
+ * ascendc_kernels_bbit的默认输入、--frame参数或--frame-dir目录使用。
+ */
+#include "pillar_scatter_tiling.h"
+#include "pillar_scatter_workload.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 写出二进制文件
+ */
+bool WriteBinary(const std::string &path, const void *data, size_t size)
+{
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr) {
+        printf("错误：无法写入 %s\n", path.c_str());
+        return false;
+    }
+    bool ok = size == 0 || fwrite(data, 1, size, fp) == size;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok) {
+        printf("错误：写入 %s 失败\n", path.c_str());
+    }
+    return ok;
+}
+
+void PrintUsage(const char *program)
+{
+    printf("用法：%s [--out 前缀] [--frames K] [--seed S] [--pillars N] [--nx W] [--ny H] [--c C]\n"
+           "          [--dtype fp16|bf16|fp32|int8] [--dist uniform|ring|urban]\n"
+           "          [--dup 比例] [--invalid 比例] [--padding 比例]\n"
+           "默认写出 ./input/OpTest_scatter_input_x.bin 和 ./input/OpTest_scatter_input_coords.bin；\n"
+           "K>1时第k帧写出 <前缀>_<k>_x.bin 和 <前缀>_<k>_coords.bin，种子为S+k。\n",
+           program);
+}
+
+int32_t main(int32_t argc, char *argv[])
+{
+    // 默认与ascendc_kernels_bbit的默认网格和通道数一致
+    WorkloadConfig config = {12000, 1024, 1024, 64, SCATTER_DTYPE_FP16, PILLAR_DIST_RING, 0, 0.0, 0.0, 0.0};
+    std::string prefix = "./input/OpTest_scatter_input";
+    uint32_t frameNum = 1;
+    for (int32_t i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            printf("错误：参数 %s 缺少取值\n", argv[i]);
+            PrintUsage(argv[0]);
+            return -1;
+        }
+        const char *value = argv[i + 1];
+        bool ok = true;
+        if (strcmp(argv[i], "--out") == 0) {
+            prefix = value;
+        } else if (strcmp(argv[i], "--frames") == 0) {
+            frameNum = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = frameNum > 0;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (strcmp(argv[i], "--pillars") == 0) {
+            config.numPillars = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (strcmp(argv[i], "--nx") == 0) {
+            config.nx = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = config.nx > 0;
+        } else if (strcmp(argv[i], "--ny") == 0) {
+            config.ny = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = config.ny > 0;
+        } else if (strcmp(argv[i], "--c") == 0) {
+            config.featureSize = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = config.featureSize > 0;
+        } else if (strcmp(argv[i], "--dtype") == 0) {
+            const char *names[] = {"fp16", "bf16", "fp32", "int8"};
+            ok = false;
+            for (uint32_t d = 0; d < 4; d++) {
+                if (strcmp(value, names[d]) == 0) {
+                    config.inputDtype = d;
+                    ok = true;
+                }
+            }
+        } else if (strcmp(argv[i], "--dist") == 0) {
+            ok = ParseDistribution(value, config.distribution);
+        } else if (strcmp(argv[i], "--dup") == 0) {
+            config.dupRatio = strtod(value, nullptr);
+            ok = config.dupRatio >= 0 && config.dupRatio <= 1;
+        } else if (strcmp(argv[i], "--invalid") == 0) {
+            config.invalidRatio = strtod(value, nullptr);
+            ok = config.invalidRatio >= 0 && config.invalidRatio <= 1;
+        } else if (strcmp(argv[i], "--padding") == 0) {
+            config.paddingRatio = strtod(value, nullptr);
+            ok = config.paddingRatio >= 0 && config.paddingRatio <= 1;
+        } else {
+            printf("错误：未知参数 %s\n", argv[i]);
+            PrintUsage(argv[0]);
+            return -1;
+        }
+        if (!ok) {
+            printf("错误：参数 %s 的取值 %s 非法\n", argv[i], value);
+            return -1;
+        }
+    }
+
+    uint32_t baseSeed = config.seed;
+    for (uint32_t frame = 0; frame < frameNum; frame++) {
+        std::string name = prefix;
+        if (frameNum > 1) {
+            char suffix[16];
+            snprintf(suffix, sizeof(suffix), "_%04u", frame);
+            name += suffix;
+        }
+        config.seed = baseSeed + frame;
+        std::vector<uint8_t> features;
+        std::vector<uint32_t> coords;
+        WorkloadStats stats;
+        if (!GenerateWorkload(config, features, coords, &stats)) {
+            printf("错误：生成配置非法\n");
+            return -1;
+        }
+        if (!WriteBinary(name + "_x.bin", features.data(), features.size()) ||
+            !WriteBinary(name + "_coords.bin", coords.data(), coords.size() * sizeof(uint32_t))) {
+            return -1;
+        }
+        printf("%s: pillars=%u grid=%ux%u C=%u dist=%s seed=%u 占用cell=%u 重复=%u 越界=%u 填充=%u\n",
+               name.c_str(), config.numPillars, config.nx, config.ny, config.featureSize,
+               DistributionName(config.distribution), config.seed, stats.uniqueCells, stats.duplicates,
+               stats.invalid, stats.padding);
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file pillar_scatter_host_utils.h
+ *
+ * host侧工具共用的小函数：多线程区间划分、按64字节块的全零检查和half/bfloat16位模式转换。
+ * 均为内联实现，不依赖ACL。
+ */
+#ifndef PILLAR_SCATTER_HOST_UTILS_H
+#define PILLAR_SCATTER_HOST_UTILS_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+constexpr size_t ZERO_BLOCK_BYTES = 64;  // 全零检查的块大小
+
+/**
+ * @brief 线程数：0表示使用全部硬件线程
+ */
+inline uint32_t ResolveThreadNum(uint32_t threadNum)
+{
+    return threadNum > 0 ? threadNum : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief 把 [0, count) 均分给threadNum个线程执行 func(线程号, begin, end)，单线程时在调用线程执行
+ */
+template <typename Func>
+void ParallelFor(uint32_t threadNum, size_t count, Func func)
+{
+    if (count == 0) {
+        return;
+    }
+    threadNum = static_cast<uint32_t>(std::min<size_t>(threadNum, count));
+    if (threadNum <= 1) {
+        func(0u, static_cast<size_t>(0), count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threadNum; t++) {
+        workers.emplace_back(func, t, count * t / threadNum, count * (t + 1) / threadNum);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief 按64字节块检查一段内存是否全零，每块8个字先按位或再判断（编译器可向量化）
+ */
+inline bool AllZero(const uint8_t *data, size_t size)
+{
+    size_t i = 0;
+    for (; i + ZERO_BLOCK_BYTES <= size; i += ZERO_BLOCK_BYTES) {
+        uint64_t words[ZERO_BLOCK_BYTES / sizeof(uint64_t)];
+        memcpy(words, data + i, ZERO_BLOCK_BYTES);
+        uint64_t merged = 0;
+        for (uint64_t word : words) {
+            merged |= word;
+        }
+        if (merged != 0) {
+            return false;
+        }
+    }
+    for (; i < size; i++) {
+        if (data[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 半精度位模式转float
+ */
+inline float HalfBitsToFloat(uint16_t bits)
+{
+    uint32_t sign = static_cast<uint32_t>(bits & 0x8000) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1F;
+    uint32_t mantissa = bits & 0x3FF;
+    uint32_t result;
+    if (exponent == 0x1F) {
+        result = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        result = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        result = sign;
+    } else {
+        // 非规格化数：规格化尾数
+        exponent = 113;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        result = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    float value;
+    memcpy(&value, &result, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief float转半精度位模式（就近舍入到偶数）
+ */
+inline uint16_t FloatToHalfBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t absBits = bits & 0x7FFFFFFF;
+    if (absBits > 0x7F800000) {
+        return static_cast<uint16_t>(sign | 0x7E00);  // NaN
+    }
+    if (absBits >= 0x47800000) {
+        return static_cast<uint16_t>(sign | 0x7C00);  // 溢出为Inf
+    }
+    uint32_t half;
+    uint32_t remainder;
+    uint32_t midpoint;
+    if (absBits < 0x38800000) {
+        // half非规格化数：单位为2^-24
+        if (absBits < 0x33000000) {
+            return static_cast<uint16_t>(sign);
+        }
+        uint32_t shift = 126 - (absBits >> 23);
+        uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+        half = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        midpoint = 1u << (shift - 1);
+    } else {
+        half = (((absBits >> 23) - 112) << 10) | ((absBits >> 13) & 0x3FF);
+        remainder = absBits & 0x1FFF;
+        midpoint = 0x1000;
+    }
+    // 进位可直接进入指数位
+    if (remainder > midpoint || (remainder == midpoint && (half & 1))) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+inline float Bf16BitsToFloat(uint16_t bits)
+{
+    uint32_t value = static_cast<uint32_t>(bits) << 16;
+    float result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+/**
+ * @brief float转bfloat16位模式（就近舍入到偶数）
+ */
+inline uint16_t FloatToBf16Bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return static_cast<uint16_t>((bits >> 16) | 0x40);
+    }
+    return static_cast<uint16_t>((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+}
+
+#endif // PILLAR_SCATTER_HOST_UTILS_H
@@ -0,0 +1,272 @@
+/**
+ * @file pillar_scatter_io.h
+ *
+ * host侧文件读写，不依赖ACL，ascendc_kernels_bbit和pillar_scatter_verify共用。
+ * 读入用分块pread直接写入目标缓冲区，不经过iostream和中间缓冲；
+ * 输出的BEV特征图绝大部分为0，可写成跳过全零4KB页的稀疏文件，或只保存被写入cell的紧凑容器；
+ * CSR模式的输出直接写成紧凑容器。
+ */
+#ifndef PILLAR_SCATTER_IO_H
+#define PILLAR_SCATTER_IO_H
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pillar_scatter_host_utils.h"
+
+constexpr size_t IO_CHUNK_BYTES = 8 << 20;  // 单次pread/pwrite的最大字节数
+constexpr size_t SPARSE_PAGE_BYTES = 4096;  // 稀疏文件跳过全零数据的粒度
+constexpr uint32_t COMPACT_OUTPUT_MAGIC = 0x4F435350;  // "PSCO"
+constexpr uint32_t COMPACT_OUTPUT_VERSION = 1;
+
+// 输出文件格式
+enum OutputFileFormat : uint32_t {
+    OUTPUT_FORMAT_DENSE = 0,    // 完整写出 [B, ny, nx, C]
+    OUTPUT_FORMAT_SPARSE = 1,   // 同样的字节内容，全零页留作文件空洞，按普通文件读取即可
+    OUTPUT_FORMAT_COMPACT = 2,  // CompactOutputHeader + 坐标 [N, 4] uint32 + 特征 [N, C]，只含非零cell
+};
+
+// 紧凑输出容器的文件头，之后依次为被写入cell的坐标 (b, y, x, 0) 和对应特征，cell按NHWC顺序排列
+struct CompactOutputHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t batchSize;
+    uint32_t ny;
+    uint32_t nx;
+    uint32_t featureSize;
+    uint32_t elemSize;   // 输出元素字节数
+    uint32_t cellCount;  // 保存的cell数
+};
+
+/**
+ * @brief pread/pwrite循环：处理短读写和EINTR，每次最多IO_CHUNK_BYTES
+ * @return 完成的字节数，出错或读到文件尾时小于size
+ */
+template <bool WRITE>
+inline size_t TransferFully(int fd, uint8_t *data, size_t size, off_t offset)
+{
+    size_t done = 0;
+    while (done < size) {
+        size_t chunk = std::min(size - done, IO_CHUNK_BYTES);
+        ssize_t ret = WRITE ? pwrite(fd, data + done, chunk, offset + static_cast<off_t>(done)) :
+                              pread(fd, data + done, chunk, offset + static_cast<off_t>(done));
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(ret);
+    }
+    return done;
+}
+
+/**
+ * @brief 读入文件开头的size字节到buffer，文件不足size字节时失败
+ */
+inline bool ReadFileRange(const std::string &path, void *buffer, size_t size)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        printf("错误：无法打开 %s\n", path.c_str());
+        return false;
+    }
+    (void)posix_fadvise(fd, 0, static_cast<off_t>(size), POSIX_FADV_SEQUENTIAL);
+    size_t done = TransferFully<false>(fd, static_cast<uint8_t *>(buffer), size, 0);
+    (void)close(fd);
+    if (done != size) {
+        printf("错误：读取 %s 失败（%zu/%zu 字节）\n", path.c_str(), done, size);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 读入整个文件
+ */
+inline bool ReadWholeFile(const std::string &path, std::vector<uint8_t> &data)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        printf("错误：无法打开 %s\n", path.c_str());
+        return false;
+    }
+    data.resize(static_cast<size_t>(st.st_size));
+    return ReadFileRange(path, data.data(), data.size());
+}
+
+/**
+ * @brief 写出size字节；sparse为true时跳过全零的4KB页，最后用ftruncate补足文件长度
+ *
+ * 跳过的页成为文件空洞，读回时为0，内容与稠密写出完全相同，但不占磁盘空间、也不产生写入量。
+ */
+inline bool WriteOutputBytes(const std::string &path, const void *data, size_t size, bool sparse)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0) {
+        printf("错误：无法写入 %s\n", path.c_str());
+        return false;
+    }
+    uint8_t *bytes = static_cast<uint8_t *>(const_cast<void *>(data));
+    bool ok = true;
+    if (!sparse) {
+        ok = TransferFully<true>(fd, bytes, size, 0) == size;
+    } else {
+        // 连续的非零页合并为一次写入
+        size_t runStart = 0;
+        size_t runEnd = 0;
+        for (size_t page = 0; page < size && ok; page += SPARSE_PAGE_BYTES) {
+            size_t pageEnd = std::min(page + SPARSE_PAGE_BYTES, size);
+            if (AllZero(bytes + page, pageEnd - page)) {
+                continue;
+            }
+            if (page != runEnd) {
+                ok = TransferFully<true>(fd, bytes + runStart, runEnd - runStart, static_cast<off_t>(runStart)) ==
+                     runEnd - runStart;
+                runStart = page;
+            }
+            runEnd = pageEnd;
+        }
+        ok = ok && TransferFully<true>(fd, bytes + runStart, runEnd - runStart, static_cast<off_t>(runStart)) ==
+                   runEnd - runStart;
+        ok = ok && ftruncate(fd, static_cast<off_t>(size)) == 0;
+    }
+    ok = close(fd) == 0 && ok;
+    if (!ok) {
+        printf("错误：写入 %s 失败\n", path.c_str());
+    }
+    return ok;
+}
+
+/**
+ * @brief 写出紧凑容器：只保存至少一个通道非零的cell，output为 [B, ny, nx, C] NHWC
+ * @param shape 只使用batchSize/ny/nx/featureSize/elemSize
+ */
+inline bool WriteCompactOutput(const std::string &path, const uint8_t *output, const CompactOutputHeader &shape)
+{
+    size_t cellBytes = static_cast<size_t>(shape.featureSize) * shape.elemSize;
+    size_t rowBytes = cellBytes * shape.nx;
+    std::vector<uint32_t> coords;
+    std::vector<uint8_t> features;
+    for (uint32_t row = 0; row < shape.batchSize * shape.ny; row++) {
+        const uint8_t *rowData = output + row * rowBytes;
+        if (AllZero(rowData, rowBytes)) {
+            continue;
+        }
+        for (uint32_t x = 0; x < shape.nx; x++) {
+            const uint8_t *cell = rowData + x * cellBytes;
+            if (AllZero(cell, cellBytes)) {
+                continue;
+            }
+            coords.insert(coords.end(), {row / shape.ny, row % shape.ny, x, 0});
+            features.insert(features.end(), cell, cell + cellBytes);
+        }
+    }
+    CompactOutputHeader header = shape;
+    header.magic = COMPACT_OUTPUT_MAGIC;
+    header.version = COMPACT_OUTPUT_VERSION;
+    header.cellCount = static_cast<uint32_t>(coords.size() / 4);
+    std::vector<uint8_t> file(sizeof(header) + coords.size() * sizeof(uint32_t) + features.size());
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), coords.data(), coords.size() * sizeof(uint32_t));
+    memcpy(file.data() + sizeof(header) + coords.size() * sizeof(uint32_t), features.data(), features.size());
+    return WriteOutputBytes(path, file.data(), file.size(), false);
+}
+
+/**
+ * @brief 由CSR输出写出紧凑容器，cell已按行优先排序
+ *
+ * @param rowOffsets 第一个batch首行的cell起始表，共 batchSize*ny+1 项；其中的值是columns/features的绝对下标
+ * @param columns 各cell的列下标x
+ * @param features 各cell的特征 [M, C]
+ * @param shape 只使用batchSize/ny/nx/featureSize/elemSize，坐标中的b从第一个batch起算
+ */
+inline bool WriteCsrOutput(const std::string &path, const uint32_t *rowOffsets, const uint32_t *columns,
+                           const uint8_t *features, const CompactOutputHeader &shape)
+{
+    size_t cellBytes = static_cast<size_t>(shape.featureSize) * shape.elemSize;
+    uint32_t rowNum = shape.batchSize * shape.ny;
+    uint32_t first = rowOffsets[0];
+    CompactOutputHeader header = shape;
+    header.magic = COMPACT_OUTPUT_MAGIC;
+    header.version = COMPACT_OUTPUT_VERSION;
+    header.cellCount = rowOffsets[rowNum] - first;
+    size_t coordBytes = static_cast<size_t>(header.cellCount) * 4 * sizeof(uint32_t);
+    std::vector<uint8_t> file(sizeof(header) + coordBytes + header.cellCount * cellBytes);
+    memcpy(file.data(), &header, sizeof(header));
+    uint32_t *coords = reinterpret_cast<uint32_t *>(file.data() + sizeof(header));
+    for (uint32_t row = 0; row < rowNum; row++) {
+        for (uint32_t m = rowOffsets[row]; m < rowOffsets[row + 1]; m++) {
+            uint32_t *coord = coords + static_cast<size_t>(m - first) * 4;
+            coord[0] = row / shape.ny;
+            coord[1] = row % shape.ny;
+            coord[2] = columns[m];
+            coord[3] = 0;
+        }
+    }
+    memcpy(file.data() + sizeof(header) + coordBytes, features + first * cellBytes, header.cellCount * cellBytes);
+    return WriteOutputBytes(path, file.data(), file.size(), false);
+}
+
+/**
+ * @brief 按格式写出 [B, ny, nx, C] 输出
+ */
+inline bool WriteOutputFile(const std::string &path, const uint8_t *output, const CompactOutputHeader &shape,
+                            uint32_t format)
+{
+    if (format == OUTPUT_FORMAT_COMPACT) {
+        return WriteCompactOutput(path, output, shape);
+    }
+    size_t size = static_cast<size_t>(shape.batchSize) * shape.ny * shape.nx * shape.featureSize * shape.elemSize;
+    return WriteOutputBytes(path, output, size, format == OUTPUT_FORMAT_SPARSE);
+}
+
+/**
+ * @brief 读入输出文件：稠密和稀疏文件原样读入，紧凑容器展开为稠密 [B, ny, nx, C]
+ * @param compact 非空时返回文件是否为紧凑容器
+ */
+inline bool ReadOutputFile(const std::string &path, std::vector<uint8_t> &output, bool *compact = nullptr)
+{
+    std::vector<uint8_t> file;
+    if (!ReadWholeFile(path, file)) {
+        return false;
+    }
+    CompactOutputHeader header = {};
+    if (file.size() >= sizeof(header)) {
+        memcpy(&header, file.data(), sizeof(header));
+    }
+    size_t cellBytes = static_cast<size_t>(header.featureSize) * header.elemSize;
+    bool isCompact = header.magic == COMPACT_OUTPUT_MAGIC && header.version == COMPACT_OUTPUT_VERSION &&
+                     file.size() == sizeof(header) + header.cellCount * (4 * sizeof(uint32_t) + cellBytes);
+    if (compact != nullptr) {
+        *compact = isCompact;
+    }
+    if (!isCompact) {
+        output.swap(file);
+        return true;
+    }
+    output.assign(static_cast<size_t>(header.batchSize) * header.ny * header.nx * cellBytes, 0);
+    const uint8_t *coordData = file.data() + sizeof(header);
+    const uint8_t *featureData = coordData + header.cellCount * 4 * sizeof(uint32_t);
+    for (uint32_t i = 0; i < header.cellCount; i++) {
+        uint32_t coord[4];
+        memcpy(coord, coordData + i * sizeof(coord), sizeof(coord));
+        if (coord[0] >= header.batchSize || coord[1] >= header.ny || coord[2] >= header.nx) {
+            printf("错误：%s 第%u个cell坐标越界\n", path.c_str(), i);
+            return false;
+        }
+        size_t cell = (static_cast<size_t>(coord[0]) * header.ny + coord[1]) * header.nx + coord[2];
+        memcpy(output.data() + cell * cellBytes, featureData + i * cellBytes, cellBytes);
+    }
+    return true;
+}
+
+#endif // PILLAR_SCATTER_IO_H
@@ -0,0 +1,107 @@
+/**
+ * @file pillar_scatter_profile.cpp
+ *
+ * 性能剖析结果的汇总和输出。
+ */
+#include "pillar_scatter_profile.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+const char *PHASE_NAMES[] = {"init", "copy_in", "scatter", "tail"};
+
+uint64_t TotalCycles(const CoreProfile &core)
+{
+    return (uint64_t)core.initCycles + core.copyInCycles + core.scatterCycles + core.tailCycles;
+}
+
+double CyclesToUs(uint64_t cycles)
+{
+    return cycles / PROFILE_CYCLES_PER_US;
+}
+
+// 按阶段顺序取出cycle数
+uint64_t PhaseCycles(const CoreProfile &core, uint32_t phase)
+{
+    const uint32_t cycles[] = {core.initCycles, core.copyInCycles, core.scatterCycles, core.tailCycles};
+    return cycles[phase];
+}
+} // namespace
+
+void PrintProfileReport(const ProfileRecord &record)
+{
+    if (record.cores.empty()) {
+        return;
+    }
+    printf("\n各核剖析 (第%u次launch，kernel %.3f ms，单位us):\n", record.launch, record.kernelMs);
+    printf("  %4s %9s %9s %9s %9s %9s %6s %8s %8s %6s %10s %10s\n", "core", "init", "copy_in", "scatter", "tail",
+           "total", "tiles", "entries", "written", "skip", "bytes_in", "bytes_out");
+    uint64_t maxTotal = 0;
+    uint64_t sumTotal = 0;
+    size_t slowest = 0;
+    uint64_t phaseMax[4] = {};
+    uint64_t phaseSum[4] = {};
+    for (size_t i = 0; i < record.cores.size(); i++) {
+        const CoreProfile &core = record.cores[i];
+        uint64_t total = TotalCycles(core);
+        printf("  %4zu %9.1f %9.1f %9.1f %9.1f %9.1f %6u %8u %8u %6u %10u %10u\n", i,
+               CyclesToUs(core.initCycles), CyclesToUs(core.copyInCycles), CyclesToUs(core.scatterCycles),
+               CyclesToUs(core.tailCycles), CyclesToUs(total), core.tiles, core.entries, core.written, core.skipped,
+               core.bytesIn, core.bytesOut);
+        if (total > maxTotal) {
+            maxTotal = total;
+            slowest = i;
+        }
+        sumTotal += total;
+        for (uint32_t phase = 0; phase < 4; phase++) {
+            phaseMax[phase] = std::max(phaseMax[phase], PhaseCycles(core, phase));
+            phaseSum[phase] += PhaseCycles(core, phase);
+        }
+    }
+    double meanTotal = (double)sumTotal / record.cores.size();
+    printf("  不均衡度(max/mean): %.2f，最慢的核: %zu (%.1f us)\n", meanTotal > 0 ? maxTotal / meanTotal : 0.0,
+           slowest, CyclesToUs(maxTotal));
+    printf("  各阶段max/mean:");
+    for (uint32_t phase = 0; phase < 4; phase++) {
+        double mean = (double)phaseSum[phase] / record.cores.size();
+        printf(" %s=%.2f", PHASE_NAMES[phase], mean > 0 ? phaseMax[phase] / mean : 0.0);
+    }
+    printf("\n");
+}
+
+bool WriteProfileJson(const std::string &path, const std::vector<ProfileRecord> &records)
+{
+    FILE *fp = fopen(path.c_str(), "w");
+    if (fp == nullptr) {
+        printf("错误：无法写入 %s\n", path.c_str());
+        return false;
+    }
+    fprintf(fp, "{\n  \"cycles_per_us\": %.1f,\n  \"records\": [\n", PROFILE_CYCLES_PER_US);
+    for (size_t r = 0; r < records.size(); r++) {
+        const ProfileRecord &record = records[r];
+        uint64_t maxTotal = 0;
+        uint64_t sumTotal = 0;
+        for (const CoreProfile &core : record.cores) {
+            maxTotal = std::max(maxTotal, TotalCycles(core));
+            sumTotal += TotalCycles(core);
+        }
+        double meanTotal = record.cores.empty() ? 0.0 : (double)sumTotal / record.cores.size();
+        fprintf(fp, "    {\"launch\": %u, \"kernel_ms\": %.6f, \"imbalance\": %.4f, \"cores\": [\n", record.launch,
+                record.kernelMs, meanTotal > 0 ? maxTotal / meanTotal : 0.0);
+        for (size_t i = 0; i < record.cores.size(); i++) {
+            const CoreProfile &core = record.cores[i];
+            fprintf(fp, "      {\"core\": %zu", i);
+            for (uint32_t phase = 0; phase < 4; phase++) {
+                fprintf(fp, ", \"%s_us\": %.3f", PHASE_NAMES[phase], CyclesToUs(PhaseCycles(core, phase)));
+            }
+            fprintf(fp, ", \"total_us\": %.3f, \"tiles\": %u, \"entries\": %u, \"written\": %u, \"skipped\": %u, "
+                        "\"bytes_in\": %u, \"bytes_out\": %u}%s\n", CyclesToUs(TotalCycles(core)), core.tiles,
+                    core.entries, core.written, core.skipped, core.bytesIn, core.bytesOut,
+                    i + 1 < record.cores.size() ? "," : "");
+        }
+        fprintf(fp, "    ]}%s\n", r + 1 < records.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
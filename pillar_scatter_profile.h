@@ -0,0 +1,35 @@
+/**
+ * @file pillar_scatter_profile.h
+ *
+ * 性能剖析结果的汇总和输出，供ascendc_kernels_bbit在每次launch之后打印各核负载不均衡报告并写出JSON。
+ * 剖析字由kernel在PILLAR_SCATTER_PROFILE编译选项下写出，经PillarScatterRunner::LastProfile()按核解码；
+ * 未开启该选项时LastProfile()为空，本模块不输出任何内容。
+ */
+#ifndef PILLAR_SCATTER_PROFILE_H
+#define PILLAR_SCATTER_PROFILE_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pillar_scatter_runner.h"
+
+// GetSystemCycle()的计数频率（MHz），用于把cycle数换算为微秒
+constexpr double PROFILE_CYCLES_PER_US = 50.0;
+
+// 一次launch的剖析结果
+struct ProfileRecord {
+    uint32_t launch;                 // launch序号（流水线模式下为帧序号）
+    float kernelMs;                  // host侧事件计时的kernel耗时，用于核对cycle换算
+    std::vector<CoreProfile> cores;  // 各核剖析结果，按核号排列
+};
+
+/**
+ * @brief 打印一次launch的各核阶段耗时、数据量，以及总耗时的最大/平均值之比（不均衡度）和最慢的核
+ */
+void PrintProfileReport(const ProfileRecord &record);
+
+/**
+ * @brief 写出全部launch的剖析结果：顶层records数组每项为一次launch，cores数组每项为一个核（耗时单位us）
+ */
+bool WriteProfileJson(const std::string &path, const std::vector<ProfileRecord> &records);
+
+#endif // PILLAR_SCATTER_PROFILE_H
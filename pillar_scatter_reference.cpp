@@ -0,0 +1,409 @@
+/**
+ * @file pillar_scatter_reference.cpp
+ *
+ * PillarScatter参考实现和稀疏校验的实现。
+ * 各线程处理互不相交的cell区间，无需加锁；NHWC布局下整行特征由memcpy一次写入或比较。
+ */
+#include "pillar_scatter_reference.h"
+#include "pillar_scatter_host_utils.h"
+#include "pillar_scatter_tiling.h"
+#include <cmath>
+
+namespace {
+constexpr size_t MAX_MESSAGES = 20;          // 报告中保留的错误描述数
+constexpr double REDUCE_ABS_TOL = 1e-3;      // 归约模式的绝对容差
+constexpr double REDUCE_REL_TOL = 1e-3;      // 归约模式每次累加引入的相对容差（half逐次累加）
+} // namespace
+
+PillarScatterReference::PillarScatterReference(const ReferenceConfig &config,
+                                               const std::vector<ReferenceFrame> &frames)
+    : config(config), frames(frames)
+{
+    for (uint32_t f = 0; f < frames.size(); f++) {
+        for (uint32_t i = 0; i < frames[f].numPillars; i++) {
+            uint32_t y = frames[f].coords[i * PILLAR_SCATTER_COORD_DIM + 1];
+            uint32_t x = frames[f].coords[i * PILLAR_SCATTER_COORD_DIM + 2];
+            if (y >= config.ny || x >= config.nx) {
+                skippedPillars++;
+                continue;
+            }
+            entries.push_back({(static_cast<uint64_t>(f) * config.ny + y) * config.nx + x, f, i});
+        }
+    }
+    // 稳定排序保持同一cell内的原始顺序，覆盖模式下最后一个生效
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.cell < b.cell; });
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i == 0 || entries[i].cell != entries[i - 1].cell) {
+            runStart.push_back(i);
+        }
+    }
+    runStart.push_back(entries.size());
+}
+
+size_t PillarScatterReference::OutputElemSize() const
+{
+    if (config.inputDtype == SCATTER_DTYPE_FP32) {
+        return sizeof(float);
+    }
+    return sizeof(uint16_t);
+}
+
+size_t PillarScatterReference::OutputSize() const
+{
+    return frames.size() * config.ny * config.nx * config.featureSize * OutputElemSize();
+}
+
+uint32_t PillarScatterReference::ThreadNum() const
+{
+    return ResolveThreadNum(config.threadNum);
+}
+
+/**
+ * @brief 把一个pillar的输入特征转换为一行输出：同类型直接拷贝，int8按 half(int8) * scale 反量化
+ */
+void PillarScatterReference::ConvertRow(const uint8_t *input, uint8_t *row) const
+{
+    if (config.inputDtype != SCATTER_DTYPE_INT8) {
+        memcpy(row, input, config.featureSize * OutputElemSize());
+        return;
+    }
+    for (uint32_t c = 0; c < config.featureSize; c++) {
+        float scale = config.dequantScale.empty() ? 1.0f : HalfBitsToFloat(config.dequantScale[c]);
+        // int8和half scale均可被float精确表示，乘积只舍入一次，与half乘法结果一致
+        uint16_t half = FloatToHalfBits(static_cast<float>(static_cast<int8_t>(input[c])) * scale);
+        memcpy(row + c * sizeof(uint16_t), &half, sizeof(half));
+    }
+}
+
+float PillarScatterReference::LoadValue(const uint8_t *row, uint32_t c) const
+{
+    if (config.inputDtype == SCATTER_DTYPE_FP32) {
+        float value;
+        memcpy(&value, row + c * sizeof(float), sizeof(value));
+        return value;
+    }
+    uint16_t bits;
+    memcpy(&bits, row + c * sizeof(uint16_t), sizeof(bits));
+    return config.inputDtype == SCATTER_DTYPE_BF16 ? Bf16BitsToFloat(bits) : HalfBitsToFloat(bits);
+}
+
+/**
+ * @brief 计算entries[begin, end)（同一cell）归约后的输出行
+ *
+ * 归约模式下accum前C个为归约值，后C个为各pillar绝对值之和（MEAN模式已除以pillar数），用于估计累加误差。
+ */
+void PillarScatterReference::ComputeCell(size_t begin, size_t end, std::vector<float> &accum, uint8_t *row) const
+{
+    size_t inputRowSize = config.featureSize * (config.inputDtype == SCATTER_DTYPE_FP32 ? 4 :
+                                                (config.inputDtype == SCATTER_DTYPE_INT8 ? 1 : 2));
+    if (config.reduceMode == SCATTER_REDUCE_OVERWRITE) {
+        const Entry &last = entries[end - 1];
+        ConvertRow(frames[last.frame].features + last.pillar * inputRowSize, row);
+        return;
+    }
+    accum.assign(config.featureSize * 2, 0.0f);
+    for (size_t i = begin; i < end; i++) {
+        ConvertRow(frames[entries[i].frame].features + entries[i].pillar * inputRowSize, row);
+        for (uint32_t c = 0; c < config.featureSize; c++) {
+            float value = LoadValue(row, c);
+            if (config.reduceMode == SCATTER_REDUCE_MAX) {
+                accum[c] = (i == begin) ? value : std::max(accum[c], value);
+            } else {
+                accum[c] += value;
+            }
+            accum[config.featureSize + c] += std::fabs(value);
+        }
+    }
+    for (uint32_t c = 0; c < config.featureSize; c++) {
+        float value = accum[c];
+        if (config.reduceMode == SCATTER_REDUCE_MEAN) {
+            value /= static_cast<float>(end - begin);
+            accum[config.featureSize + c] /= static_cast<float>(end - begin);
+        }
+        if (config.inputDtype == SCATTER_DTYPE_FP32) {
+            memcpy(row + c * sizeof(float), &value, sizeof(value));
+        } else {
+            uint16_t bits = config.inputDtype == SCATTER_DTYPE_BF16 ? FloatToBf16Bits(value) : FloatToHalfBits(value);
+            memcpy(row + c * sizeof(uint16_t), &bits, sizeof(bits));
+        }
+    }
+}
+
+void PillarScatterReference::StoreRow(uint8_t *output, uint64_t cell, const uint8_t *row) const
+{
+    size_t elemSize = OutputElemSize();
+    if (config.layout == REFERENCE_LAYOUT_NHWC) {
+        memcpy(output + cell * config.featureSize * elemSize, row, config.featureSize * elemSize);
+        return;
+    }
+    uint64_t planeSize = static_cast<uint64_t>(config.ny) * config.nx;
+    uint64_t b = cell / planeSize;
+    uint64_t hw = cell % planeSize;
+    for (uint32_t c = 0; c < config.featureSize; c++) {
+        memcpy(output + ((b * config.featureSize + c) * planeSize + hw) * elemSize, row + c * elemSize, elemSize);
+    }
+}
+
+void PillarScatterReference::LoadRow(const uint8_t *output, uint64_t cell, uint8_t *row) const
+{
+    size_t elemSize = OutputElemSize();
+    if (config.layout == REFERENCE_LAYOUT_NHWC) {
+        memcpy(row, output + cell * config.featureSize * elemSize, config.featureSize * elemSize);
+        return;
+    }
+    uint64_t planeSize = static_cast<uint64_t>(config.ny) * config.nx;
+    uint64_t b = cell / planeSize;
+    uint64_t hw = cell % planeSize;
+    for (uint32_t c = 0; c < config.featureSize; c++) {
+        memcpy(row + c * elemSize, output + ((b * config.featureSize + c) * planeSize + hw) * elemSize, elemSize);
+    }
+}
+
+void PillarScatterReference::Generate(uint8_t *output) const
+{
+    uint32_t threadNum = ThreadNum();
+    size_t outputSize = OutputSize();
+    ParallelFor(threadNum, outputSize, [output](uint32_t, size_t begin, size_t end) {
+        memset(output + begin, 0, end - begin);
+    });
+    size_t rowBytes = config.featureSize * OutputElemSize();
+    ParallelFor(threadNum, runStart.size() - 1, [this, output, rowBytes](uint32_t, size_t begin, size_t end) {
+        std::vector<uint8_t> row(rowBytes);
+        std::vector<float> accum;
+        for (size_t r = begin; r < end; r++) {
+            ComputeCell(runStart[r], runStart[r + 1], accum, row.data());
+            StoreRow(output, entries[runStart[r]].cell, row.data());
+        }
+    });
+}
+
+size_t PillarScatterReference::GradientSize() const
+{
+    size_t numPillars = 0;
+    for (const ReferenceFrame &frame : frames) {
+        numPillars += frame.numPillars;
+    }
+    return numPillars * config.featureSize * OutputElemSize();
+}
+
+void PillarScatterReference::GenerateGradient(const uint8_t *outputGrad, uint8_t *pillarGrad) const
+{
+    size_t elemSize = OutputElemSize();
+    size_t rowBytes = config.featureSize * elemSize;
+    std::vector<size_t> frameBase(frames.size(), 0);
+    for (size_t f = 1; f < frames.size(); f++) {
+        frameBase[f] = frameBase[f - 1] + frames[f - 1].numPillars;
+    }
+    memset(pillarGrad, 0, GradientSize());
+    // 各cell的pillar互不相交，按cell并行写出
+    ParallelFor(ThreadNum(), runStart.size() - 1, [&](uint32_t, size_t begin, size_t end) {
+        std::vector<uint8_t> row(rowBytes);
+        for (size_t r = begin; r < end; r++) {
+            size_t first = runStart[r];
+            size_t last = runStart[r + 1];
+            LoadRow(outputGrad, entries[first].cell, row.data());
+            if (config.reduceMode == SCATTER_REDUCE_OVERWRITE) {
+                first = last - 1;
+            } else if (config.reduceMode == SCATTER_REDUCE_MEAN && last - first > 1) {
+                float scale = 1.0f / static_cast<float>(last - first);
+                scale = config.inputDtype == SCATTER_DTYPE_FP32 ? scale : HalfBitsToFloat(FloatToHalfBits(scale));
+                for (uint32_t c = 0; c < config.featureSize; c++) {
+                    float value = LoadValue(row.data(), c) * scale;
+                    if (config.inputDtype == SCATTER_DTYPE_FP32) {
+                        memcpy(row.data() + c * sizeof(float), &value, sizeof(value));
+                    } else {
+                        uint16_t bits = FloatToHalfBits(value);
+                        memcpy(row.data() + c * sizeof(uint16_t), &bits, sizeof(bits));
+                    }
+                }
+            }
+            for (size_t i = first; i < last; i++) {
+                memcpy(pillarGrad + (frameBase[entries[i].frame] + entries[i].pillar) * rowBytes, row.data(),
+                       rowBytes);
+            }
+        }
+    });
+}
+
+size_t PillarScatterReference::PooledSize(uint32_t shift) const
+{
+    return frames.size() * (config.ny >> shift) * (config.nx >> shift) * config.featureSize * OutputElemSize();
+}
+
+void PillarScatterReference::GeneratePooled(const uint8_t *output, uint32_t shift, uint32_t poolMode,
+                                            uint8_t *pooled, std::vector<float> &tolerance) const
+{
+    uint32_t stride = 1u << shift;
+    uint32_t poolNx = config.nx >> shift;
+    uint64_t poolRows = frames.size() * static_cast<uint64_t>(config.ny >> shift);
+    size_t elemSize = OutputElemSize();
+    size_t rowBytes = config.featureSize * elemSize;
+    tolerance.assign(poolRows * poolNx * config.featureSize, 0.0f);
+    // 各线程处理互不相交的池化行 (b, py)
+    ParallelFor(ThreadNum(), poolRows, [&](uint32_t, size_t begin, size_t end) {
+        std::vector<float> accum(config.featureSize * 2);
+        for (size_t r = begin; r < end; r++) {
+            uint64_t b = r / (config.ny >> shift);
+            uint64_t py = r % (config.ny >> shift);
+            for (uint32_t px = 0; px < poolNx; px++) {
+                std::fill(accum.begin(), accum.end(), 0.0f);
+                for (uint32_t dy = 0; dy < stride; dy++) {
+                    for (uint32_t dx = 0; dx < stride; dx++) {
+                        uint64_t cell = (b * config.ny + py * stride + dy) * config.nx + px * stride + dx;
+                        const uint8_t *row = output + cell * rowBytes;
+                        for (uint32_t c = 0; c < config.featureSize; c++) {
+                            float value = LoadValue(row, c);
+                            bool first = dy == 0 && dx == 0;
+                            accum[c] = poolMode == SCATTER_REDUCE_MAX ? (first ? value : std::max(accum[c], value))
+                                                                      : accum[c] + value;
+                            accum[config.featureSize + c] += std::fabs(value);
+                        }
+                    }
+                }
+                uint64_t index = r * poolNx + px;
+                uint8_t *dst = pooled + index * rowBytes;
+                for (uint32_t c = 0; c < config.featureSize; c++) {
+                    float value = accum[c];
+                    if (poolMode == SCATTER_REDUCE_MEAN) {
+                        value /= static_cast<float>(stride * stride);
+                        tolerance[index * config.featureSize + c] = static_cast<float>(
+                            REDUCE_ABS_TOL + REDUCE_REL_TOL * accum[config.featureSize + c]);
+                    }
+                    if (config.inputDtype == SCATTER_DTYPE_FP32) {
+                        memcpy(dst + c * sizeof(float), &value, sizeof(value));
+                    } else {
+                        uint16_t bits = config.inputDtype == SCATTER_DTYPE_BF16 ? FloatToBf16Bits(value) :
+                                                                                  FloatToHalfBits(value);
+                        memcpy(dst + c * sizeof(uint16_t), &bits, sizeof(bits));
+                    }
+                }
+            }
+        }
+    });
+}
+
+bool PillarScatterReference::Verify(const uint8_t *output, bool strictDuplicates, VerifyReport &report) const
+{
+    uint32_t threadNum = ThreadNum();
+    std::vector<VerifyReport> partial(threadNum, VerifyReport{});
+    size_t elemSize = OutputElemSize();
+    size_t rowBytes = config.featureSize * elemSize;
+    size_t inputRowSize = config.featureSize * (config.inputDtype == SCATTER_DTYPE_FP32 ? 4 :
+                                                (config.inputDtype == SCATTER_DTYPE_INT8 ? 1 : 2));
+
+    // ==================== 1. 逐个比较坐标中出现过的cell ====================
+    ParallelFor(threadNum, runStart.size() - 1, [&](uint32_t t, size_t begin, size_t end) {
+        VerifyReport &local = partial[t];
+        std::vector<uint8_t> expected(rowBytes);
+        std::vector<uint8_t> actual(rowBytes);
+        std::vector<uint8_t> candidate(rowBytes);
+        std::vector<float> accum;
+        for (size_t r = begin; r < end; r++) {
+            size_t first = runStart[r];
+            size_t last = runStart[r + 1];
+            uint64_t cell = entries[first].cell;
+            ComputeCell(first, last, accum, expected.data());
+            LoadRow(output, cell, actual.data());
+            local.checkedCells++;
+            bool match = memcmp(expected.data(), actual.data(), rowBytes) == 0;
+            if (!match && config.reduceMode == SCATTER_REDUCE_OVERWRITE && !strictDuplicates) {
+                // 重复cell等于任一pillar即接受
+                for (size_t i = first; i + 1 < last && !match; i++) {
+                    ConvertRow(frames[entries[i].frame].features + entries[i].pillar * inputRowSize,
+                               candidate.data());
+                    match = memcmp(candidate.data(), actual.data(), rowBytes) == 0;
+                }
+                local.ambiguousCells += match ? 1 : 0;
+            } else if (!match && config.reduceMode != SCATTER_REDUCE_OVERWRITE) {
+                // 归约模式按逐次累加的误差上界比较：每次累加的舍入误差不超过绝对值之和的相对精度
+                match = true;
+                for (uint32_t c = 0; c < config.featureSize; c++) {
+                    float want = LoadValue(expected.data(), c);
+                    float got = LoadValue(actual.data(), c);
+                    if (std::isnan(want) && std::isnan(got)) {
+                        continue;
+                    }
+                    double error = std::fabs(static_cast<double>(got) - want);
+                    double magnitude = accum[config.featureSize + c];
+                    double tolerance = REDUCE_ABS_TOL + REDUCE_REL_TOL * (last - first) * magnitude;
+                    local.maxAbsError = std::max(local.maxAbsError, error);
+                    match = match && error <= tolerance;
+                }
+            }
+            if (!match) {
+                local.mismatchCells++;
+                if (local.messages.size() < MAX_MESSAGES) {
+                    char message[160];
+                    snprintf(message, sizeof(message), "cell %llu (pillar数 %zu): 首通道期望 %f，实际 %f",
+                             static_cast<unsigned long long>(cell), last - first,
+                             LoadValue(expected.data(), 0), LoadValue(actual.data(), 0));
+                    local.messages.push_back(message);
+                }
+            }
+        }
+    });
+
+    // ==================== 2. 其余cell检查全零 ====================
+    uint64_t planeSize = static_cast<uint64_t>(config.ny) * config.nx;
+    uint64_t cellNum = frames.size() * planeSize;
+    // 空cell区间 [begin, end) 是否全零；NCHW布局下按batch拆分，每个通道平面上各是一段连续内存
+    auto rangeZero = [&](uint64_t begin, uint64_t end) {
+        if (config.layout == REFERENCE_LAYOUT_NHWC) {
+            return AllZero(output + begin * rowBytes, (end - begin) * rowBytes);
+        }
+        for (uint64_t s = begin; s < end;) {
+            uint64_t b = s / planeSize;
+            uint64_t t = std::min(end, (b + 1) * planeSize);
+            for (uint32_t c = 0; c < config.featureSize; c++) {
+                if (!AllZero(output + ((b * config.featureSize + c) * planeSize + s % planeSize) * elemSize,
+                             (t - s) * elemSize)) {
+                    return false;
+                }
+            }
+            s = t;
+        }
+        return true;
+    };
+    ParallelFor(threadNum, cellNum, [&](uint32_t t, size_t begin, size_t end) {
+        VerifyReport &local = partial[t];
+        // 定位本区间内第一个被写入的cell
+        auto next = std::lower_bound(runStart.begin(), runStart.end() - 1, static_cast<uint64_t>(begin),
+                                     [this](size_t start, uint64_t cell) { return entries[start].cell < cell; });
+        uint64_t cursor = begin;
+        while (cursor < end) {
+            uint64_t occupied = (next != runStart.end() - 1) ? std::min<uint64_t>(entries[*next].cell, end) : end;
+            if (cursor < occupied && !rangeZero(cursor, occupied)) {
+                // 慢路径：逐cell定位非零cell
+                for (uint64_t cell = cursor; cell < occupied; cell++) {
+                    if (!rangeZero(cell, cell + 1)) {
+                        local.nonZeroCells++;
+                        if (local.messages.size() < MAX_MESSAGES) {
+                            local.messages.push_back("cell " + std::to_string(cell) + " 不在坐标中但非零");
+                        }
+                    }
+                }
+            }
+            cursor = occupied + 1;
+            if (next != runStart.end() - 1) {
+                ++next;
+            }
+        }
+    });
+
+    report = VerifyReport{};
+    report.skippedPillars = skippedPillars;
+    for (const VerifyReport &local : partial) {
+        report.checkedCells += local.checkedCells;
+        report.mismatchCells += local.mismatchCells;
+        report.ambiguousCells += local.ambiguousCells;
+        report.nonZeroCells += local.nonZeroCells;
+        report.maxAbsError = std::max(report.maxAbsError, local.maxAbsError);
+        for (const std::string &message : local.messages) {
+            if (report.messages.size() < MAX_MESSAGES) {
+                report.messages.push_back(message);
+            }
+        }
+    }
+    return report.mismatchCells == 0 && report.nonZeroCells == 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file pillar_scatter_reference.h
+ *
+ * PillarScatter算子的host侧参考实现和稀疏校验，不依赖ACL，可在只有CPU的机器上运行。
+ * 参考实现按cell对全部有效pillar做一次稳定排序，再多线程生成NHWC或NCHW的稠密真值；
+ * 稀疏校验只比较坐标中出现过的cell，其余部分按64字节块多线程检查是否全零，无需生成稠密真值。
+ * 反向（PillarGather）的参考实现按同样的cell分组把输出梯度分给各pillar。
+ * 多分辨率（MULTIRES）模式的池化输出由稠密真值按 s x s 窗口做max/mean池化得到。
+ */
+#ifndef PILLAR_SCATTER_REFERENCE_H
+#define PILLAR_SCATTER_REFERENCE_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 参考输出的内存布局
+enum ReferenceLayout : uint32_t {
+    REFERENCE_LAYOUT_NHWC = 0,  // [B, ny, nx, C]，与kernel输出一致
+    REFERENCE_LAYOUT_NCHW = 1,  // [B, C, ny, nx]
+};
+
+struct ReferenceConfig {
+    uint32_t nx;                        // BEV特征图宽度 W
+    uint32_t ny;                        // BEV特征图高度 H
+    uint32_t featureSize;               // 每个pillar的特征维度 C
+    uint32_t inputDtype;                // PillarScatterDtype
+    uint32_t reduceMode;                // PillarScatterReduce
+    uint32_t layout;                    // ReferenceLayout
+    uint32_t threadNum;                 // 工作线程数，0表示使用全部硬件线程
+    std::vector<uint16_t> dequantScale; // int8输入的逐通道scale [C] half，空表示全为1
+};
+
+// 一帧输入，第b帧写入输出的第b个batch（coords[:, 0]被忽略，与ascendc_kernels_bbit一致）
+struct ReferenceFrame {
+    const uint8_t *features;  // [numPillars, C]，类型由inputDtype决定
+    const uint32_t *coords;   // [numPillars, 4] uint32 (batch, y, x, reserved)
+    uint32_t numPillars;
+};
+
+// 稀疏校验结果
+struct VerifyReport {
+    uint64_t checkedCells;       // 坐标中出现过的cell数
+    uint64_t mismatchCells;      // 与参考值不一致的cell数
+    uint64_t ambiguousCells;     // 覆盖模式下等于某个非最后写入pillar的重复cell（多核写入顺序不确定）
+    uint64_t nonZeroCells;       // 不应被写入却非零的cell数
+    uint64_t skippedPillars;     // 坐标越界或填充、未参与校验的pillar数
+    double maxAbsError;          // 归约模式下的最大绝对误差
+    std::vector<std::string> messages;  // 前若干个错误的描述
+};
+
+/**
+ * @brief PillarScatter的参考实现
+ *
+ * 构造时按cell稳定排序全部有效pillar，之后可多次生成稠密真值或校验输出。
+ * 覆盖模式下同一cell按原始顺序最后一个生效；SUM/MAX/MEAN在float中归约后转换为输出类型。
+ */
+class PillarScatterReference {
+public:
+    PillarScatterReference(const ReferenceConfig &config, const std::vector<ReferenceFrame> &frames);
+
+    // 输出元素字节数：int8输入反量化为half，其余与输入相同
+    size_t OutputElemSize() const;
+    // 稠密输出的字节数
+    size_t OutputSize() const;
+
+    /**
+     * @brief 生成稠密真值：多线程清零后按cell并行写入，output需有OutputSize()字节
+     */
+    void Generate(uint8_t *output) const;
+
+    /**
+     * @brief 稀疏校验：逐个比较坐标中出现过的cell，其余cell检查全零
+     *
+     * @param strictDuplicates 覆盖模式下重复cell必须等于最后写入的pillar；
+     *        为false时等于任一重复pillar也接受（PILLAR模式多核写入顺序不确定），计入ambiguousCells
+     * @return 没有不一致和多余的非零cell时返回true
+     */
+    bool Verify(const uint8_t *output, bool strictDuplicates, VerifyReport &report) const;
+
+    // 全部帧拼接后的pillar梯度 [sum(numPillars), C] 的字节数
+    size_t GradientSize() const;
+
+    /**
+     * @brief 反向参考：按config.layout读取输出梯度，按前向的归约语义写出各帧拼接的pillar梯度
+     *
+     * 覆盖模式下同一cell只有按原始顺序最后一个pillar得到梯度；SUM每个pillar都得到该cell的梯度；
+     * MEAN为梯度乘以输出类型的1/n后舍入一次（与kernel的Muls一致）。越界、填充的pillar梯度为0，不支持MAX和bf16的MEAN。
+     */
+    void GenerateGradient(const uint8_t *outputGrad, uint8_t *pillarGrad) const;
+
+    // 步长 2^shift 的池化输出 [B, ny>>shift, nx>>shift, C] 的字节数
+    size_t PooledSize(uint32_t shift) const;
+
+    /**
+     * @brief 池化参考：对NHWC稠密输出按 2^shift x 2^shift 窗口在float中做max或mean池化，pooled需有PooledSize(shift)字节
+     *
+     * tolerance为每个元素的允许误差：MAX为0；MEAN按kernel在输出类型中逐级累加估计，
+     * 为绝对容差加上每次累加的相对容差乘以窗口内绝对值之和。
+     */
+    void GeneratePooled(const uint8_t *output, uint32_t shift, uint32_t poolMode, uint8_t *pooled,
+                        std::vector<float> &tolerance) const;
+
+private:
+    // 一个有效pillar，按 (cell, 原始顺序) 排序
+    struct Entry {
+        uint64_t cell;      // (b * ny + y) * nx + x
+        uint32_t frame;
+        uint32_t pillar;
+    };
+
+    uint32_t ThreadNum() const;
+    void ComputeCell(size_t begin, size_t end, std::vector<float> &accum, uint8_t *row) const;
+    void ConvertRow(const uint8_t *input, uint8_t *row) const;
+    void StoreRow(uint8_t *output, uint64_t cell, const uint8_t *row) const;
+    void LoadRow(const uint8_t *output, uint64_t cell, uint8_t *row) const;
+    float LoadValue(const uint8_t *row, uint32_t c) const;
+
+    ReferenceConfig config;
+    std::vector<ReferenceFrame> frames;
+    std::vector<Entry> entries;       // 全部有效pillar，按cell稳定排序
+    std::vector<size_t> runStart;     // 每个不同cell在entries中的起始位置，末尾为entries.size()
+    uint64_t skippedPillars = 0;
+};
+
+#endif // PILLAR_SCATTER_REFERENCE_H
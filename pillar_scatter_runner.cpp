@@ -0,0 +1,1444 @@
+/**
+ * @file pillar_scatter_runner.cpp
+ *
+ * PillarScatterRunner实现：tiling计算、host侧预处理（排序/分桶/调度表）以及缓冲区和launch管理。
+ */
+#include "pillar_scatter_runner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include "acl/acl.h"
+#ifndef ASCENDC_CPU_DEBUG
+#include "aclrtlaunch_pillar_scatter_custom.h"
+#include "aclrtlaunch_pillar_scatter_pfn_custom.h"
+#include "aclrtlaunch_pillar_scatter_transpose_custom.h"
+#include "aclrtlaunch_pillar_gather_custom.h"
+#else
+#include "tikicpulib.h"
+extern "C" __global__ __aicore__ void pillar_scatter_custom(GM_ADDR pillar_features, 
+                                                            GM_ADDR coords, 
+                                                            GM_ADDR params, 
+                                                            GM_ADDR tiling,
+                                                            GM_ADDR workspace,
+                                                            GM_ADDR spatial_features);
+extern "C" __global__ __aicore__ void pillar_scatter_pfn_custom(GM_ADDR point_features,
+                                                                GM_ADDR point_counts,
+                                                                GM_ADDR coords,
+                                                                GM_ADDR params,
+                                                                GM_ADDR tiling,
+                                                                GM_ADDR workspace,
+                                                                GM_ADDR spatial_features);
+extern "C" __global__ __aicore__ void pillar_scatter_transpose_custom(GM_ADDR nhwc_features,
+                                                                      GM_ADDR tiling,
+                                                                      GM_ADDR nchw_features);
+extern "C" __global__ __aicore__ void pillar_gather_custom(GM_ADDR spatial_grad,
+                                                           GM_ADDR coords,
+                                                           GM_ADDR params,
+                                                           GM_ADDR tiling,
+                                                           GM_ADDR workspace,
+                                                           GM_ADDR pillar_grad);
+#endif
+
+// ACL调用失败时打印错误码并返回false
+#define RUNNER_CHECK_ACL(x)                                                              \
+    do {                                                                                 \
+        aclError __ret = x;                                                              \
+        if (__ret != ACL_ERROR_NONE) {                                                   \
+            printf("%s:%d aclError:%d\n", __FILE__, __LINE__, static_cast<int>(__ret)); \
+            return false;                                                                \
+        }                                                                                \
+    } while (0)
+
+// 输入特征的元素字节数
+size_t InputElemSize(uint32_t dtype)
+{
+    return dtype == SCATTER_DTYPE_FP32 ? 4 : (dtype == SCATTER_DTYPE_INT8 ? 1 : 2);
+}
+
+// 输出特征的元素字节数：int8输入反量化为half，其余与输入相同
+size_t OutputElemSize(uint32_t dtype)
+{
+    return dtype == SCATTER_DTYPE_INT8 ? 2 : InputElemSize(dtype);
+}
+
+// 紧凑坐标中越界条目的编码：均不小于kernel的合法上界（B*ny*nx，或ny、nx）
+constexpr uint32_t LINEAR_INVALID_CELL = 0xFFFFFFFE;
+constexpr uint32_t YX16_INVALID = 0xFFFEFFFE;
+
+uint32_t CoordWords(uint32_t format)
+{
+    return format == SCATTER_COORD_BYXR ? PILLAR_SCATTER_COORD_DIM : 1;
+}
+
+bool CoordFormatSupported(uint32_t format, uint32_t nx, uint32_t ny, uint32_t batchSize)
+{
+    if (format == SCATTER_COORD_LINEAR) {
+        return (uint64_t)batchSize * ny * nx <= LINEAR_INVALID_CELL;
+    }
+    if (format == SCATTER_COORD_YX16) {
+        return batchSize == 1 && nx <= 0xFFFE && ny <= 0xFFFE;
+    }
+    return format == SCATTER_COORD_BYXR;
+}
+
+void PackCoords(const uint32_t *coords, uint32_t numPillars, uint32_t format, uint32_t nx, uint32_t ny,
+                uint32_t batchSize, uint32_t *packed)
+{
+    if (format == SCATTER_COORD_BYXR) {
+        memmove(packed, coords, (size_t)numPillars * PILLAR_SCATTER_COORD_DIM * sizeof(uint32_t));
+        return;
+    }
+    // 第i项写入packed[i]之前已读完coords[4i..4i+3]，原地编码时不会覆盖尚未读取的条目
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t b = coords[(size_t)i * PILLAR_SCATTER_COORD_DIM + 0];
+        uint32_t y = coords[(size_t)i * PILLAR_SCATTER_COORD_DIM + 1];
+        uint32_t x = coords[(size_t)i * PILLAR_SCATTER_COORD_DIM + 2];
+        bool padding = y == PILLAR_PADDING_COORD && x == PILLAR_PADDING_COORD;
+        bool valid = b < batchSize && y < ny && x < nx;
+        if (format == SCATTER_COORD_LINEAR) {
+            packed[i] = valid ? (b * ny + y) * nx + x : (padding ? PILLAR_PADDING_COORD : LINEAR_INVALID_CELL);
+        } else {
+            packed[i] = valid && b == 0 ? (x << 16) | y : (padding ? PILLAR_PADDING_COORD : YX16_INVALID);
+        }
+    }
+}
+
+void UnpackCoords(const uint32_t *packed, uint32_t numPillars, uint32_t format, uint32_t nx, uint32_t ny,
+                  uint32_t *coords)
+{
+    if (format == SCATTER_COORD_BYXR) {
+        memcpy(coords, packed, (size_t)numPillars * PILLAR_SCATTER_COORD_DIM * sizeof(uint32_t));
+        return;
+    }
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t *coord = coords + (size_t)i * PILLAR_SCATTER_COORD_DIM;
+        uint32_t value = packed[i];
+        if (value == PILLAR_PADDING_COORD) {
+            std::fill(coord, coord + PILLAR_SCATTER_COORD_DIM, PILLAR_PADDING_COORD);
+            continue;
+        }
+        // 线性下标不小于B*ny*nx时解码出的batch不小于B，仍判为越界
+        bool linear = format == SCATTER_COORD_LINEAR;
+        coord[0] = linear ? value / (ny * nx) : 0;
+        coord[1] = linear ? value / nx % ny : value & 0xFFFF;
+        coord[2] = linear ? value % nx : value >> 16;
+        coord[3] = 0;
+    }
+}
+
+/**
+ * @brief 各模式自身数据占用的workspace长度（uint32个数），不含性能剖析区
+ *
+ * BAND模式至少容纳PILLAR模式的诊断区，反向（按PILLAR模式生成tiling）可复用同一块workspace。
+ */
+size_t GetModeWorkspaceWords(const PillarScatterTilingData &tiling)
+{
+    if (tiling.scatterMode == SCATTER_MODE_CSR) {
+        return (size_t)tiling.runStartOffset + tiling.totalPillars + 1 + 8;
+    }
+    if (tiling.scatterMode == SCATTER_MODE_INCREMENTAL) {
+        return (size_t)tiling.cellListOffset + 2 * (size_t)tiling.coreNum * tiling.cellListStride;
+    }
+    size_t diagWords = (size_t)tiling.diagOffset + (size_t)tiling.coreNum * PILLAR_SCATTER_DIAG_DIM;
+    if (tiling.scatterMode != SCATTER_MODE_BAND) {
+        return diagWords;
+    }
+    size_t binWords = (size_t)tiling.binOffset + (size_t)tiling.totalPillars * PILLAR_SCATTER_BIN_ENTRY_DIM + 8;
+    return std::max(diagWords, binWords);
+}
+
+// G份通道切分是否满足对齐和整除约束
+bool ChannelSplitFits(uint32_t split, uint32_t featureSize, uint32_t blockDim, const ScatterOptions &options)
+{
+    // int8输入时UB中的原始行和反量化后的行都需32字节对齐，按较窄的输入类型计算
+    size_t elemSize = std::min(InputElemSize(options.inputDtype), OutputElemSize(options.inputDtype));
+    if (blockDim % split != 0 || featureSize % split != 0) {
+        return false;
+    }
+    size_t sliceBytes = featureSize / split * elemSize;
+    return sliceBytes % 32 == 0 && sliceBytes >= PILLAR_SCATTER_SPLIT_MIN_BYTES;
+}
+
+uint32_t ChooseChannelSplit(uint32_t featureSize, uint32_t blockDim, uint32_t numPillars,
+                            const ScatterOptions &options)
+{
+    if ((options.scatterMode != SCATTER_MODE_PILLAR && options.scatterMode != SCATTER_MODE_SORTED) ||
+        options.scheduleMode != SCATTER_SCHEDULE_STATIC || options.maxPoints > 0 || options.channelSplit == 1) {
+        return 1;
+    }
+    if (options.channelSplit > 1) {
+        return ChannelSplitFits(options.channelSplit, featureSize, blockDim, options) ? options.channelSplit : 1;
+    }
+    uint32_t split = 1;
+    while ((uint64_t)numPillars * split < (uint64_t)blockDim * PILLAR_SCATTER_SPLIT_MIN_PILLARS &&
+           ChannelSplitFits(split * 2, featureSize, blockDim, options)) {
+        split *= 2;
+    }
+    return split;
+}
+
+// MULTIRES模式的最大池化步长的log2，没有池化输出时为0
+uint32_t MaxPoolShift(uint32_t strideMask)
+{
+    uint32_t shift = 0;
+    for (uint32_t k = 1; k <= PILLAR_SCATTER_MAX_POOL_SHIFT; k++) {
+        if ((strideMask >> k) & 1) {
+            shift = k;
+        }
+    }
+    return shift;
+}
+
+bool ValidateConfig(const PillarScatterConfig &config)
+{
+    const ScatterOptions &options = config.options;
+    uint32_t mode = options.scatterMode;
+    uint32_t featureSize = config.featureSize;
+    if (config.nx == 0 || config.ny == 0 || featureSize == 0 || config.batchSize == 0 || config.blockDim == 0 ||
+        featureSize % PILLAR_SCATTER_CHANNEL_ALIGN != 0) {
+        printf("错误：非法配置 nx=%u ny=%u C=%u B=%u blockDim=%u (C需为%u的倍数)\n", config.nx, config.ny,
+               featureSize, config.batchSize, config.blockDim, PILLAR_SCATTER_CHANNEL_ALIGN);
+        return false;
+    }
+    if (mode > SCATTER_MODE_MULTIRES || options.inputDtype > SCATTER_DTYPE_INT8 ||
+        options.outputLayout > SCATTER_LAYOUT_NCHW_TRANSPOSE || options.coordFormat > SCATTER_COORD_YX16 ||
+        options.reduceMode > SCATTER_REDUCE_MEAN || options.scheduleMode > SCATTER_SCHEDULE_REGION) {
+        printf("错误：非法的模式/特征类型/输出布局/坐标格式/归约方式/调度方式\n");
+        return false;
+    }
+    // 非覆盖归约要求同一cell的pillar由同一个核按原始顺序处理，只有band和csr模式读取reduceMode，
+    // 其余kernel会静默按覆盖写出
+    if (options.reduceMode != SCATTER_REDUCE_OVERWRITE && mode != SCATTER_MODE_BAND && mode != SCATTER_MODE_CSR) {
+        printf("错误：sum/max/mean归约只能使用band/csr模式\n");
+        return false;
+    }
+    // REGION调度依赖按cell排序后的pillar顺序和host生成的分核表，只在sorted模式下准备
+    if (options.scheduleMode == SCATTER_SCHEDULE_REGION && mode != SCATTER_MODE_SORTED) {
+        printf("错误：region调度只能使用sorted模式\n");
+        return false;
+    }
+    // band/incremental/csr模式（含非覆盖归约）只实现了fp16
+    if (options.inputDtype != SCATTER_DTYPE_FP16 &&
+        (mode == SCATTER_MODE_BAND || mode == SCATTER_MODE_INCREMENTAL || mode == SCATTER_MODE_CSR)) {
+        printf("错误：band/incremental/csr模式只支持fp16特征\n");
+        return false;
+    }
+    // int8整块搬运要求每个pillar的特征为32字节的倍数
+    if (options.inputDtype == SCATTER_DTYPE_INT8 && featureSize % 32 != 0) {
+        printf("错误：int8特征要求C为32的倍数，当前C=%u\n", featureSize);
+        return false;
+    }
+    if (options.inputDtype == SCATTER_DTYPE_INT8 && !config.dequantScale.empty() &&
+        config.dequantScale.size() != featureSize) {
+        printf("错误：int8反量化scale长度 %zu 与C=%u不符\n", config.dequantScale.size(), featureSize);
+        return false;
+    }
+    if (options.maxPoints > 0) {
+        if (mode != SCATTER_MODE_PILLAR || options.scheduleMode != SCATTER_SCHEDULE_STATIC ||
+            options.inputDtype != SCATTER_DTYPE_FP16) {
+            printf("错误：PFN融合入口只支持pillar模式、static调度和fp16特征\n");
+            return false;
+        }
+        if ((size_t)options.maxPoints * featureSize * sizeof(uint16_t) > PILLAR_SCATTER_TILE_BYTES) {
+            printf("错误：单个pillar的逐点特征 %u x %u 超出UB预算 %u 字节\n", options.maxPoints, featureSize,
+                   PILLAR_SCATTER_TILE_BYTES);
+            return false;
+        }
+    }
+    // NCHW输出以16x16的half块转置：要求fp16、nx为16的倍数，且16个cell的段能放入UB；UB内转置只在band模式实现
+    if (options.outputLayout != SCATTER_LAYOUT_NHWC) {
+        if (mode == SCATTER_MODE_INCREMENTAL || mode == SCATTER_MODE_CSR || options.maxPoints > 0 ||
+            (options.outputLayout == SCATTER_LAYOUT_NCHW && mode != SCATTER_MODE_BAND)) {
+            printf("错误：nchw布局只能使用band模式，transpose布局不支持incremental/csr模式和PFN融合入口\n");
+            return false;
+        }
+        if (options.inputDtype != SCATTER_DTYPE_FP16 || config.nx % 16 != 0 ||
+            featureSize * sizeof(uint16_t) * 16 > PILLAR_SCATTER_TILE_BYTES) {
+            printf("错误：NCHW输出要求fp16特征、nx为16的倍数且C不超过%zu，当前nx=%u C=%u\n",
+                   PILLAR_SCATTER_TILE_BYTES / (16 * sizeof(uint16_t)), config.nx, featureSize);
+            return false;
+        }
+    }
+    // 指定的通道切分份数需整除blockDim，且每核通道片为32字节的倍数、不少于PILLAR_SCATTER_SPLIT_MIN_BYTES
+    if (options.channelSplit > 1 &&
+        ChooseChannelSplit(featureSize, config.blockDim, 0, options) != options.channelSplit) {
+        printf("错误：通道切分 %u 只用于pillar/sorted模式的static调度，需整除blockDim=%u，"
+               "且每核%u个通道不少于%u字节并32字节对齐\n", options.channelSplit, config.blockDim,
+               featureSize / options.channelSplit, PILLAR_SCATTER_SPLIT_MIN_BYTES);
+        return false;
+    }
+    // multires模式：粗网格块按最大步长S划分，nx、ny不是S的倍数时最后的块会越过池化输出的末尾
+    if (mode == SCATTER_MODE_MULTIRES) {
+        uint32_t validMask = ((1u << (PILLAR_SCATTER_MAX_POOL_SHIFT + 1)) - 1) & ~1u;
+        if (options.poolStrideMask == 0 || (options.poolStrideMask & ~validMask) != 0 ||
+            (options.poolMode != SCATTER_REDUCE_MAX && options.poolMode != SCATTER_REDUCE_MEAN)) {
+            printf("错误：multires模式需要至少一个池化步长（2~%u），池化方式为max或mean\n",
+                   1u << PILLAR_SCATTER_MAX_POOL_SHIFT);
+            return false;
+        }
+        if (options.scheduleMode != SCATTER_SCHEDULE_STATIC || options.inputDtype != SCATTER_DTYPE_FP16 ||
+            options.outputLayout != SCATTER_LAYOUT_NHWC || options.maxPoints > 0) {
+            printf("错误：multires模式只支持static调度、fp16特征和NHWC输出，不支持PFN融合输入\n");
+            return false;
+        }
+        uint32_t maxStride = 1u << MaxPoolShift(options.poolStrideMask);
+        if (config.nx % maxStride != 0 || config.ny % maxStride != 0) {
+            printf("错误：multires模式要求nx、ny为最大池化步长%u的倍数，当前nx=%u ny=%u\n", maxStride, config.nx,
+                   config.ny);
+            return false;
+        }
+    }
+    if (!CoordFormatSupported(options.coordFormat, config.nx, config.ny, config.batchSize)) {
+        printf("错误：坐标格式无法表示 batch %u、%ux%u 的输出（yx16要求单帧且nx、ny不超过65534，"
+               "linear要求B*ny*nx小于2^32-1）\n", config.batchSize, config.nx, config.ny);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 反向只覆盖前向按cell直接写出特征的情形，其余配置打印原因
+ */
+bool BackwardSupported(const PillarScatterConfig &config)
+{
+    const ScatterOptions &options = config.options;
+    if (options.scatterMode == SCATTER_MODE_INCREMENTAL || options.scatterMode == SCATTER_MODE_CSR ||
+        options.scatterMode == SCATTER_MODE_MULTIRES) {
+        printf("错误：反向不支持incremental/csr/multires模式（持久输出、紧凑输出或池化输出）\n");
+        return false;
+    }
+    if (options.maxPoints > 0 || options.inputDtype == SCATTER_DTYPE_INT8) {
+        printf("错误：反向不支持PFN融合输入和int8反量化输入\n");
+        return false;
+    }
+    if (options.outputLayout != SCATTER_LAYOUT_NHWC) {
+        printf("错误：反向只支持NHWC输出梯度\n");
+        return false;
+    }
+    if (options.reduceMode == SCATTER_REDUCE_MAX) {
+        printf("错误：max归约的反向需要前向的逐通道argmax，暂不支持\n");
+        return false;
+    }
+    if (options.reduceMode == SCATTER_REDUCE_MEAN && options.inputDtype == SCATTER_DTYPE_BF16) {
+        // bf16按half原样搬运，无法做缩放
+        printf("错误：mean归约的反向不支持bf16\n");
+        return false;
+    }
+    // 多核pillar模式及static/dynamic调度的sorted模式中，重复cell生效的pillar由核间竞争决定
+    bool deterministic = options.scatterMode == SCATTER_MODE_BAND || config.blockDim == 1 ||
+                         (options.scatterMode == SCATTER_MODE_SORTED &&
+                          options.scheduleMode == SCATTER_SCHEDULE_REGION);
+    if (options.reduceMode == SCATTER_REDUCE_OVERWRITE && !deterministic) {
+        printf("错误：覆盖模式的反向把梯度给最后一个pillar，前向须为band模式、region调度的sorted模式或单核\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 计算PillarScatter的tiling数据
+ * 
+ * 按blockDim均分pillar：前formerNum个核各多处理1个pillar，保证各核负载相差不超过1。
+ * 通道切分时按 blockDim/G 个pillar组均分，每组的G个核各处理C/G个通道。
+ * tileLength只在通道数不是32/64/128的通用路径下使用；PFN融合入口的tileLength为每块pillar数，
+ * 每块逐点特征不超过单个特征缓冲区的UB预算。
+ * workspace布局：
+ *   - BAND模式：[行起始表 B*ny+1] [行分桶条目 N*2]，每段末尾预留8个uint32_t防止对齐搬运越界
+ *   - INCREMENTAL模式：[8] [各核pillar起始表 blockDim+1] [2组 x blockDim个cell列表]，每个列表容纳maxPillars个cell，
+ *     起始表每帧由host写入，cell列表跨帧保留；每个核归属连续的ownerRows行输出
+ *   - PILLAR/SORTED模式：[块计数器 8] [各核pillar起始表 blockDim+1] [int8反量化scale C个half] [诊断字 blockDim*8]
+ *   - PILLAR/SORTED模式之后有blockDim x 8个字的坐标校验诊断字（diagOffset）
+ *   - 各模式的数据之后为性能剖析区 blockDim x 16个字（profileOffset），只在PILLAR_SCATTER_PROFILE编译选项下分配
+ *   - CSR模式：[各cell的pillar起始表 M+1]；输出依次为行偏移表 [B*ny+1]、列下标 [M] 和紧凑特征 [M, C]，
+ *     列下标和特征按maxPillars预留，各段起点32字节对齐
+ *   - MULTIRES模式：与PILLAR模式相同，各核起始表总是有效；输出之后依次为各步长的池化输出
+ */
+PillarScatterTilingData GenerateTiling(uint32_t nx, uint32_t ny, uint32_t featureSize, uint32_t batchSize,
+                                       uint32_t blockDim, uint32_t numPillars, uint32_t maxPillars,
+                                       const ScatterOptions &options)
+{
+    PillarScatterTilingData tiling = {};
+    tiling.nx = nx;
+    tiling.ny = ny;
+    tiling.featureSize = featureSize;
+    tiling.batchSize = batchSize;
+    tiling.coreNum = blockDim;
+    tiling.totalPillars = numPillars;
+    tiling.channelSplit = ChooseChannelSplit(featureSize, blockDim, numPillars, options);
+    tiling.channelSlice = featureSize / tiling.channelSplit;
+    uint32_t partNum = blockDim / tiling.channelSplit;
+    tiling.tailLength = numPillars / partNum;
+    tiling.formerNum = numPillars % partNum;
+    tiling.formerLength = tiling.tailLength + 1;
+    tiling.tileLength = std::max<uint32_t>(1, PILLAR_SCATTER_TILE_BYTES /
+                                                  (featureSize * OutputElemSize(options.inputDtype)));
+    tiling.scatterMode = options.scatterMode;
+    tiling.rowStartOffset = 0;
+    tiling.binOffset = (batchSize * ny + 1 + 8 + 7) / 8 * 8;
+    tiling.cellListStride = (8 + maxPillars + 8 + 7) / 8 * 8;
+    tiling.reduceMode = options.reduceMode;
+    // DYNAMIC调度每核约领取8块，块长取tileLength的整数倍
+    tiling.scheduleMode = options.scheduleMode;
+    uint32_t chunkTarget = (numPillars + blockDim * 8 - 1) / (blockDim * 8);
+    tiling.chunkLength = std::max<uint32_t>(1, (chunkTarget + tiling.tileLength - 1) / tiling.tileLength) *
+                         tiling.tileLength;
+    tiling.counterOffset = 0;
+    tiling.regionOffset = 8;
+    tiling.inputDtype = options.inputDtype;
+    tiling.scaleOffset = (tiling.regionOffset + blockDim + 1 + 7) / 8 * 8;
+    tiling.cellListOffset = tiling.scaleOffset;
+    tiling.ownerRows = (batchSize * ny + blockDim - 1) / blockDim;
+    tiling.maxPoints = options.maxPoints;
+    if (options.maxPoints > 0) {
+        tiling.tileLength = std::max<uint32_t>(1, PILLAR_SCATTER_TILE_BYTES /
+                                                      (options.maxPoints * featureSize * sizeof(uint16_t)));
+    }
+    tiling.cellCount = 0;
+    tiling.runStartOffset = 0;
+    tiling.csrColumnOffset = (batchSize * ny + 1 + 7) / 8 * 8;
+    tiling.csrFeatureOffset = tiling.csrColumnOffset + (maxPillars + 7) / 8 * 8;
+    tiling.outputLayout = options.outputLayout;
+    tiling.poolMode = options.poolMode;
+    tiling.poolStrideMask = options.poolStrideMask;
+    // 只有PILLAR/SORTED模式的kernel直接读取紧凑坐标，其余由host解码
+    bool compactCoords = (options.scatterMode == SCATTER_MODE_PILLAR || options.scatterMode == SCATTER_MODE_SORTED) &&
+                         options.maxPoints == 0;
+    tiling.coordFormat = compactCoords ? options.coordFormat : SCATTER_COORD_BYXR;
+    // INCREMENTAL模式由host按归属核分桶后只上传输出cell下标
+    if (options.scatterMode == SCATTER_MODE_INCREMENTAL) {
+        tiling.coordFormat = SCATTER_COORD_LINEAR;
+    }
+    tiling.diagOffset = (tiling.scaleOffset + featureSize / 2 + 8 + 7) / 8 * 8;
+    tiling.profileOffset = (uint32_t)((GetModeWorkspaceWords(tiling) + 7) / 8 * 8);
+    return tiling;
+}
+
+/**
+ * @brief 计算workspace字节数；开启性能剖析时末尾追加各核的剖析字
+ */
+size_t GetWorkspaceSize(const PillarScatterTilingData &tiling)
+{
+#ifdef PILLAR_SCATTER_PROFILE
+    return ((size_t)tiling.profileOffset + (size_t)tiling.coreNum * PILLAR_SCATTER_PROFILE_DIM) * sizeof(uint32_t);
+#else
+    return GetModeWorkspaceWords(tiling) * sizeof(uint32_t);
+#endif
+}
+
+/**
+ * @brief 按BEV行对pillar分桶（计数排序），生成BAND模式所需的行起始表和分桶条目
+ * 
+ * 行编号为 b*ny+y；同一行内保持pillar原始顺序，重复坐标时最后一个生效。
+ * 坐标越界的pillar不进入任何分桶，不会被写出。
+ */
+void BuildRowBins(const uint32_t *coords, const PillarScatterTilingData &tiling, uint32_t *workspace)
+{
+    uint32_t rowNum = tiling.batchSize * tiling.ny;
+    uint32_t *rowStart = workspace + tiling.rowStartOffset;
+    uint32_t *bins = workspace + tiling.binOffset;
+    std::vector<uint32_t> rowOf(tiling.totalPillars);
+    memset(rowStart, 0, (rowNum + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < tiling.totalPillars; i++) {
+        uint32_t b = coords[i * 4 + 0];
+        uint32_t y = coords[i * 4 + 1];
+        uint32_t x = coords[i * 4 + 2];
+        rowOf[i] = (b < tiling.batchSize && y < tiling.ny && x < tiling.nx) ? b * tiling.ny + y : rowNum;
+        if (rowOf[i] < rowNum) {
+            rowStart[rowOf[i] + 1]++;
+        }
+    }
+    for (uint32_t r = 0; r < rowNum; r++) {
+        rowStart[r + 1] += rowStart[r];
+    }
+    std::vector<uint32_t> cursor(rowStart, rowStart + rowNum);
+    for (uint32_t i = 0; i < tiling.totalPillars; i++) {
+        if (rowOf[i] < rowNum) {
+            uint32_t pos = cursor[rowOf[i]]++;
+            bins[pos * PILLAR_SCATTER_BIN_ENTRY_DIM + 0] = i;
+            bins[pos * PILLAR_SCATTER_BIN_ENTRY_DIM + 1] = coords[i * 4 + 2];
+        }
+    }
+}
+
+/**
+ * @brief INCREMENTAL模式：按归属核对pillar分桶（计数排序），生成各核pillar起始表
+ * 
+ * 第k核归属输出行 [k*ownerRows, (k+1)*ownerRows)，各核只读取自己的一段连续pillar，特征可整块搬运。
+ * 同一核内保持pillar原始顺序，重复坐标时最后一个生效。原地重排特征和坐标，坐标越界的pillar被丢弃。
+ * 
+ * @return 分桶后的有效pillar数
+ */
+uint32_t BinPillarsByOwner(uint8_t *features, uint32_t *coords, uint32_t numPillars,
+                           const PillarScatterTilingData &tiling, size_t elemSize, uint32_t *workspace)
+{
+    uint32_t coreNum = tiling.coreNum;
+    uint32_t *start = workspace + tiling.regionOffset;
+    std::vector<uint32_t> ownerOf(numPillars);
+    memset(start, 0, (coreNum + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t b = coords[i * 4 + 0];
+        uint32_t y = coords[i * 4 + 1];
+        uint32_t x = coords[i * 4 + 2];
+        ownerOf[i] = (b < tiling.batchSize && y < tiling.ny && x < tiling.nx) ?
+                     (b * tiling.ny + y) / tiling.ownerRows : coreNum;
+        if (ownerOf[i] < coreNum) {
+            start[ownerOf[i] + 1]++;
+        }
+    }
+    for (uint32_t k = 0; k < coreNum; k++) {
+        start[k + 1] += start[k];
+    }
+    uint32_t validNum = start[coreNum];
+    std::vector<uint32_t> cursor(start, start + coreNum);
+    size_t rowBytes = tiling.featureSize * elemSize;
+    std::vector<uint8_t> binnedFeatures((size_t)validNum * rowBytes);
+    std::vector<uint32_t> binnedCoords((size_t)validNum * 4);
+    for (uint32_t i = 0; i < numPillars; i++) {
+        if (ownerOf[i] < coreNum) {
+            uint32_t pos = cursor[ownerOf[i]]++;
+            memcpy(&binnedFeatures[pos * rowBytes], features + (size_t)i * rowBytes, rowBytes);
+            memcpy(&binnedCoords[pos * 4], coords + (size_t)i * 4, 4 * sizeof(uint32_t));
+        }
+    }
+    memcpy(features, binnedFeatures.data(), binnedFeatures.size());
+    memcpy(coords, binnedCoords.data(), binnedCoords.size() * sizeof(uint32_t));
+    return validNum;
+}
+
+/**
+ * @brief 按输出cell（b*ny+y)*nx+x 对pillar排序，供SORTED模式使用
+ * 
+ * 两趟LSD计数排序：先按x、再按行 b*ny+y 稳定排序，同一cell的重复pillar保持原始顺序。
+ * 排序后原地重排特征和坐标，坐标越界的pillar被丢弃。
+ * 
+ * @return 排序后的有效pillar数
+ */
+uint32_t SortPillarsByCell(uint8_t *features, uint32_t *coords, uint32_t numPillars,
+                           const PillarScatterTilingData &tiling, size_t elemSize)
+{
+    uint32_t rowNum = tiling.batchSize * tiling.ny;
+    std::vector<uint32_t> rowOf(numPillars);
+    std::vector<uint32_t> byX;
+    byX.reserve(numPillars);
+    std::vector<uint32_t> count(std::max(rowNum, tiling.nx) + 1, 0);
+    // 第一趟：按x计数排序，同时丢弃越界pillar
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t b = coords[i * 4 + 0];
+        uint32_t y = coords[i * 4 + 1];
+        uint32_t x = coords[i * 4 + 2];
+        rowOf[i] = (b < tiling.batchSize && y < tiling.ny && x < tiling.nx) ? b * tiling.ny + y : rowNum;
+        if (rowOf[i] < rowNum) {
+            count[x + 1]++;
+        }
+    }
+    for (uint32_t x = 0; x < tiling.nx; x++) {
+        count[x + 1] += count[x];
+    }
+    uint32_t validNum = count[tiling.nx];
+    byX.resize(validNum);
+    for (uint32_t i = 0; i < numPillars; i++) {
+        if (rowOf[i] < rowNum) {
+            byX[count[coords[i * 4 + 2]]++] = i;
+        }
+    }
+    // 第二趟：按行稳定计数排序
+    std::fill(count.begin(), count.end(), 0);
+    for (uint32_t i : byX) {
+        count[rowOf[i] + 1]++;
+    }
+    for (uint32_t r = 0; r < rowNum; r++) {
+        count[r + 1] += count[r];
+    }
+    std::vector<uint32_t> order(validNum);
+    for (uint32_t i : byX) {
+        order[count[rowOf[i]]++] = i;
+    }
+    // 按排序结果重排特征和坐标
+    size_t rowBytes = tiling.featureSize * elemSize;
+    std::vector<uint8_t> sortedFeatures((size_t)validNum * rowBytes);
+    std::vector<uint32_t> sortedCoords((size_t)validNum * 4);
+    for (uint32_t k = 0; k < validNum; k++) {
+        memcpy(&sortedFeatures[k * rowBytes], features + (size_t)order[k] * rowBytes, rowBytes);
+        memcpy(&sortedCoords[k * 4], coords + (size_t)order[k] * 4, 4 * sizeof(uint32_t));
+    }
+    memcpy(features, sortedFeatures.data(), sortedFeatures.size());
+    memcpy(coords, sortedCoords.data(), sortedCoords.size() * sizeof(uint32_t));
+    return validNum;
+}
+
+/**
+ * @brief MULTIRES模式：按最大步长S的粗网格块对pillar排序并去重
+ * 
+ * 排序键为块编号 (b*(ny/S)+y/S)*(nx/S)+x/S 拼接块内 (y%S, x%S) 的Morton码，
+ * 块内按四叉树顺序排列，任一步长 2^k<=S 的粗cell在结果中都是连续的一段。
+ * 同一cell只保留原始顺序最后一个pillar（覆盖语义），坐标越界的pillar被丢弃；要求nx、ny能被S整除。
+ * 
+ * @return 去重后的cell数 M
+ */
+uint32_t SortPillarsByPoolBlock(uint8_t *features, uint32_t *coords, uint32_t numPillars,
+                                const PillarScatterTilingData &tiling, size_t elemSize)
+{
+    uint32_t shift = MaxPoolShift(tiling.poolStrideMask);
+    uint32_t mask = (1u << shift) - 1;
+    std::vector<std::pair<uint64_t, uint32_t>> keys;
+    keys.reserve(numPillars);
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t b = coords[i * 4 + 0];
+        uint32_t y = coords[i * 4 + 1];
+        uint32_t x = coords[i * 4 + 2];
+        if (b >= tiling.batchSize || y >= tiling.ny || x >= tiling.nx) {
+            continue;
+        }
+        uint64_t block = ((uint64_t)b * (tiling.ny >> shift) + (y >> shift)) * (tiling.nx >> shift) + (x >> shift);
+        uint64_t morton = 0;
+        for (uint32_t bit = 0; bit < shift; bit++) {
+            morton |= (uint64_t)((x & mask) >> bit & 1) << (2 * bit);
+            morton |= (uint64_t)((y & mask) >> bit & 1) << (2 * bit + 1);
+        }
+        keys.emplace_back(block << (2 * shift) | morton, i);
+    }
+    std::sort(keys.begin(), keys.end());
+    // 同一cell的pillar按原始下标升序相邻，保留每段最后一个
+    size_t rowBytes = tiling.featureSize * elemSize;
+    std::vector<uint8_t> sortedFeatures;
+    std::vector<uint32_t> sortedCoords;
+    sortedFeatures.reserve(keys.size() * rowBytes);
+    sortedCoords.reserve(keys.size() * 4);
+    for (size_t k = 0; k < keys.size(); k++) {
+        if (k + 1 < keys.size() && keys[k + 1].first == keys[k].first) {
+            continue;
+        }
+        const uint8_t *row = features + (size_t)keys[k].second * rowBytes;
+        sortedFeatures.insert(sortedFeatures.end(), row, row + rowBytes);
+        sortedCoords.insert(sortedCoords.end(), coords + (size_t)keys[k].second * 4,
+                            coords + (size_t)keys[k].second * 4 + 4);
+    }
+    memcpy(features, sortedFeatures.data(), sortedFeatures.size());
+    memcpy(coords, sortedCoords.data(), sortedCoords.size() * sizeof(uint32_t));
+    return (uint32_t)(sortedCoords.size() / 4);
+}
+
+/**
+ * @brief MULTIRES模式：生成各核cell起始表
+ * 
+ * 按cell数均分后把每个边界推到下一个最大步长粗网格块的起点，任一步长的粗cell都不跨核。
+ */
+void BuildPoolRegions(const uint32_t *coords, const PillarScatterTilingData &tiling, uint32_t *workspace)
+{
+    uint32_t shift = MaxPoolShift(tiling.poolStrideMask);
+    uint32_t *region = workspace + tiling.regionOffset;
+    uint32_t numCells = tiling.totalPillars;
+    auto sameBlock = [&](uint32_t a, uint32_t b) {
+        return coords[a * 4 + 0] == coords[b * 4 + 0] &&
+               (coords[a * 4 + 1] >> shift) == (coords[b * 4 + 1] >> shift) &&
+               (coords[a * 4 + 2] >> shift) == (coords[b * 4 + 2] >> shift);
+    };
+    region[0] = 0;
+    for (uint32_t k = 1; k < tiling.coreNum; k++) {
+        uint32_t pos = std::max(region[k - 1], (uint32_t)((uint64_t)numCells * k / tiling.coreNum));
+        while (pos > 0 && pos < numCells && sameBlock(pos, pos - 1)) {
+            pos++;
+        }
+        region[k] = pos;
+    }
+    region[tiling.coreNum] = numCells;
+}
+
+/**
+ * @brief 由按cell排序后的坐标生成CSR模式的索引
+ * 
+ * 同一cell的连续pillar合并为一个cell：workspace中记录其在排序后pillar中的起始位置（末尾为numPillars），
+ * 输出中写入各BEV行（b*ny+y）的cell起始表和各cell的列下标x。
+ * 
+ * @return 去重后的cell数 M
+ */
+uint32_t BuildCsrIndex(const uint32_t *coords, uint32_t numPillars, const PillarScatterTilingData &tiling,
+                       uint32_t *workspace, uint32_t *output)
+{
+    uint32_t rowNum = tiling.batchSize * tiling.ny;
+    uint32_t *runStart = workspace + tiling.runStartOffset;
+    uint32_t *rowOffset = output;
+    uint32_t *columns = output + tiling.csrColumnOffset;
+    memset(rowOffset, 0, (rowNum + 1) * sizeof(uint32_t));
+    uint32_t cellCount = 0;
+    for (uint32_t i = 0; i < numPillars; i++) {
+        const uint32_t *coord = coords + i * 4;
+        if (i > 0 && coord[0] == coord[-4] && coord[1] == coord[-3] && coord[2] == coord[-2]) {
+            continue;
+        }
+        runStart[cellCount] = i;
+        columns[cellCount] = coord[2];
+        rowOffset[coord[0] * tiling.ny + coord[1] + 1]++;
+        cellCount++;
+    }
+    runStart[cellCount] = numPillars;
+    for (uint32_t r = 0; r < rowNum; r++) {
+        rowOffset[r + 1] += rowOffset[r];
+    }
+    return cellCount;
+}
+
+/**
+ * @brief format格式坐标中第i个条目的输出cell (b*ny+y)*nx+x，填充或越界时返回UINT64_MAX
+ */
+uint64_t EntryCell(const uint32_t *coords, uint32_t i, uint32_t format, const PillarScatterTilingData &tiling)
+{
+    uint64_t cellNum = (uint64_t)tiling.batchSize * tiling.ny * tiling.nx;
+    if (format == SCATTER_COORD_LINEAR) {
+        return coords[i] < cellNum ? coords[i] : UINT64_MAX;
+    }
+    uint32_t b = 0;
+    uint32_t y = coords[i] & 0xFFFF;
+    uint32_t x = coords[i] >> 16;
+    if (format == SCATTER_COORD_BYXR) {
+        b = coords[(size_t)i * PILLAR_SCATTER_COORD_DIM + 0];
+        y = coords[(size_t)i * PILLAR_SCATTER_COORD_DIM + 1];
+        x = coords[(size_t)i * PILLAR_SCATTER_COORD_DIM + 2];
+    }
+    return (b < tiling.batchSize && y < tiling.ny && x < tiling.nx) ? ((uint64_t)b * tiling.ny + y) * tiling.nx + x
+                                                                     : UINT64_MAX;
+}
+
+/**
+ * @brief 是否有两个合法pillar落在同一cell，用于决定能否通道切分
+ * 
+ * 通道切分时同一cell的重复pillar若分属不同pillar组，各通道片的写出顺序互相独立，
+ * 输出行可能由不同pillar的通道片拼成。coords为format格式；已按cell排序时只比较相邻条目，否则排序后比较。
+ */
+bool HasDuplicateCells(const uint32_t *coords, uint32_t numPillars, uint32_t format,
+                       const PillarScatterTilingData &tiling, bool sorted)
+{
+    std::vector<uint64_t> cells;
+    cells.reserve(numPillars);
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint64_t cell = EntryCell(coords, i, format, tiling);
+        if (cell != UINT64_MAX) {
+            cells.push_back(cell);
+        }
+    }
+    if (!sorted) {
+        std::sort(cells.begin(), cells.end());
+    }
+    return std::adjacent_find(cells.begin(), cells.end()) != cells.end();
+}
+
+/**
+ * @brief host侧坐标校验统计，分类与kernel的CoordValidator一致
+ */
+ScatterDiagnostics CountCoordDiagnostics(const uint32_t *coords, uint32_t numPillars,
+                                         const PillarScatterTilingData &tiling)
+{
+    ScatterDiagnostics diag = {};
+    for (uint32_t i = 0; i < numPillars; i++) {
+        const uint32_t *coord = coords + (size_t)i * PILLAR_SCATTER_COORD_DIM;
+        if (coord[0] < tiling.batchSize && coord[1] < tiling.ny && coord[2] < tiling.nx) {
+            diag.validPillars++;
+        } else if (coord[1] == PILLAR_PADDING_COORD && coord[2] == PILLAR_PADDING_COORD) {
+            diag.padding++;
+            diag.status |= SCATTER_STATUS_PADDING;
+        } else {
+            diag.outOfRange++;
+            diag.status |= SCATTER_STATUS_OUT_OF_RANGE;
+        }
+    }
+    return diag;
+}
+
+/**
+ * @brief 反向：按前向的重复坐标语义，把每个pillar分得的梯度份数写入坐标的保留字段
+ * 
+ * 按 (cell, 原始下标) 排序后逐cell处理：覆盖模式下最后一个pillar为1、其余为0，MEAN为该cell的pillar数，
+ * SUM均为1。非法坐标的条目由kernel跳过，其份数不被读取。
+ */
+void BuildGatherShares(uint32_t *coords, uint32_t numPillars, const PillarScatterTilingData &tiling)
+{
+    std::vector<uint64_t> keys;
+    keys.reserve(numPillars);
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t *coord = coords + (size_t)i * PILLAR_SCATTER_COORD_DIM;
+        coord[PILLAR_GATHER_SHARE_FIELD] = 1;
+        if (tiling.reduceMode != SCATTER_REDUCE_SUM && coord[0] < tiling.batchSize && coord[1] < tiling.ny &&
+            coord[2] < tiling.nx) {
+            uint64_t cell = ((uint64_t)coord[0] * tiling.ny + coord[1]) * tiling.nx + coord[2];
+            keys.push_back(cell << 32 | i);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    for (size_t begin = 0; begin < keys.size();) {
+        size_t end = begin + 1;
+        while (end < keys.size() && (keys[end] >> 32) == (keys[begin] >> 32)) {
+            end++;
+        }
+        for (size_t k = begin; k < end; k++) {
+            uint32_t share = tiling.reduceMode == SCATTER_REDUCE_MEAN ? (uint32_t)(end - begin) : (k + 1 == end);
+            coords[(keys[k] & 0xFFFFFFFF) * PILLAR_SCATTER_COORD_DIM + PILLAR_GATHER_SHARE_FIELD] = share;
+        }
+        begin = end;
+    }
+}
+
+/**
+ * @brief 准备PILLAR/SORTED模式的调度数据：清零DYNAMIC块计数器，REGION调度时生成各核pillar起始表
+ * 
+ * REGION调度要求coords已按cell排序：按pillar数均分后把每个边界推到下一行的起点，
+ * 每个核写整行构成的一段连续输出，同一cell的重复pillar不会跨核。
+ */
+void PrepareSchedule(const uint32_t *coords, const PillarScatterTilingData &tiling, uint32_t *workspace)
+{
+    workspace[tiling.counterOffset] = 0;
+    if (tiling.scheduleMode != SCATTER_SCHEDULE_REGION) {
+        return;
+    }
+    uint32_t *region = workspace + tiling.regionOffset;
+    uint32_t numPillars = tiling.totalPillars;
+    region[0] = 0;
+    for (uint32_t k = 1; k < tiling.coreNum; k++) {
+        uint32_t pos = std::max(region[k - 1], (uint32_t)((uint64_t)numPillars * k / tiling.coreNum));
+        while (pos > 0 && pos < numPillars && coords[pos * 4 + 0] == coords[(pos - 1) * 4 + 0] &&
+               coords[pos * 4 + 1] == coords[(pos - 1) * 4 + 1]) {
+            pos++;
+        }
+        region[k] = pos;
+    }
+    region[tiling.coreNum] = numPillars;
+}
+
+// ==================== PillarScatterRunner ====================
+
+// 进程内存活的Runner数，ACL在第一个Runner初始化时aclInit，最后一个析构时aclFinalize
+static std::mutex g_aclMutex;
+static uint32_t g_aclRefCount = 0;
+
+PillarScatterRunner::PillarScatterRunner(const PillarScatterConfig &config) : config(config)
+{
+    inputRowSize = config.featureSize * std::max<uint32_t>(1, config.options.maxPoints);
+    // CSR模式的输出大小取决于pillar容量，在Reserve中分配
+    outputSize = config.options.scatterMode == SCATTER_MODE_CSR ? 0 : (size_t)config.batchSize * config.ny * config.nx * config.featureSize *
+                 OutputElemSize(config.options.inputDtype);
+    if (config.options.scatterMode == SCATTER_MODE_MULTIRES) {
+        outputSize = PoolOutputOffset(PILLAR_SCATTER_MAX_POOL_SHIFT + 1);
+    }
+}
+
+/**
+ * @brief 全分辨率输出之后按步长升序排列池化输出；shift超过最大步长时返回全部输出的大小
+ */
+size_t PillarScatterRunner::PoolOutputOffset(uint32_t shift) const
+{
+    size_t cellBytes = (size_t)config.featureSize * OutputElemSize(config.options.inputDtype);
+    size_t offset = 0;
+    for (uint32_t k = 0; k < shift && k <= PILLAR_SCATTER_MAX_POOL_SHIFT; k++) {
+        if (k == 0 || ((config.options.poolStrideMask >> k) & 1)) {
+            offset += (size_t)config.batchSize * (config.ny >> k) * (config.nx >> k) * cellBytes;
+        }
+    }
+    return offset;
+}
+
+PillarScatterRunner::~PillarScatterRunner()
+{
+    if (!initialized) {
+        return;
+    }
+    Wait();
+    FreeInputs(host, false);
+    FreeOutput();
+#ifndef ASCENDC_CPU_DEBUG
+    FreeInputs(device, true);
+    if (stream != nullptr) {
+        aclrtDestroyEvent((aclrtEvent)startEvent);
+        aclrtDestroyEvent((aclrtEvent)endEvent);
+        aclrtDestroyEvent((aclrtEvent)kernelStartEvent);
+        aclrtDestroyEvent((aclrtEvent)kernelEndEvent);
+        aclrtDestroyStream((aclrtStream)stream);
+    }
+    aclrtResetDevice(config.deviceId);
+    std::lock_guard<std::mutex> lock(g_aclMutex);
+    if (--g_aclRefCount == 0) {
+        aclFinalize();
+    }
+#endif
+}
+
+bool PillarScatterRunner::Init()
+{
+    if (!ValidateConfig(config)) {
+        return false;
+    }
+#ifdef ASCENDC_CPU_DEBUG
+    // 设置内核模式为AIV_MODE，适配昇腾C算子；CPU模式下输出即host可见内存
+    AscendC::SetKernelMode(KernelMode::AIV_MODE);
+#else
+    {
+        std::lock_guard<std::mutex> lock(g_aclMutex);
+        if (g_aclRefCount == 0) {
+            RUNNER_CHECK_ACL(aclInit(nullptr));
+        }
+        g_aclRefCount++;
+    }
+    initialized = true;
+    RUNNER_CHECK_ACL(aclrtSetDevice(config.deviceId));
+    RUNNER_CHECK_ACL(aclrtCreateStream((aclrtStream *)&stream));
+    RUNNER_CHECK_ACL(aclrtCreateEvent((aclrtEvent *)&startEvent));
+    RUNNER_CHECK_ACL(aclrtCreateEvent((aclrtEvent *)&endEvent));
+    RUNNER_CHECK_ACL(aclrtCreateEvent((aclrtEvent *)&kernelStartEvent));
+    RUNNER_CHECK_ACL(aclrtCreateEvent((aclrtEvent *)&kernelEndEvent));
+#endif
+    initialized = true;
+    if (config.options.scatterMode != SCATTER_MODE_CSR && !AllocOutput()) {
+        return false;
+    }
+    return config.maxPillars == 0 || Reserve(config.maxPillars);
+}
+
+/**
+ * @brief 分配outputSize字节的输出（NCHW_TRANSPOSE布局另有同样大小的NHWC中间结果）；CPU模式下输出即host可见内存
+ */
+bool PillarScatterRunner::AllocOutput()
+{
+    bool transpose = config.options.outputLayout == SCATTER_LAYOUT_NCHW_TRANSPOSE;
+#ifdef ASCENDC_CPU_DEBUG
+    outputDevice = (uint8_t *)AscendC::GmAlloc(outputSize);
+    outputHost = outputDevice;
+    if (transpose) {
+        nhwcDevice = (uint8_t *)AscendC::GmAlloc(outputSize);
+    }
+#else
+    RUNNER_CHECK_ACL(aclrtMalloc((void **)&outputDevice, outputSize, ACL_MEM_MALLOC_HUGE_FIRST));
+    if (transpose) {
+        RUNNER_CHECK_ACL(aclrtMalloc((void **)&nhwcDevice, outputSize, ACL_MEM_MALLOC_HUGE_FIRST));
+    }
+    // CSR模式的行偏移表和列下标在host生成后经outputHost上传，总是需要host缓冲区
+    if (config.downloadOutput || config.options.scatterMode == SCATTER_MODE_CSR) {
+        RUNNER_CHECK_ACL(aclrtMallocHost((void **)&outputHost, outputSize));
+    }
+#endif
+    return true;
+}
+
+void PillarScatterRunner::FreeOutput()
+{
+#ifdef ASCENDC_CPU_DEBUG
+    if (outputDevice != nullptr) {
+        AscendC::GmFree((void *)outputDevice);
+    }
+    if (nhwcDevice != nullptr) {
+        AscendC::GmFree((void *)nhwcDevice);
+    }
+#else
+    if (outputDevice != nullptr) {
+        aclrtFree(outputDevice);
+    }
+    if (nhwcDevice != nullptr) {
+        aclrtFree(nhwcDevice);
+    }
+    if (outputHost != nullptr) {
+        aclrtFreeHost(outputHost);
+    }
+#endif
+    outputDevice = nullptr;
+    outputHost = nullptr;
+    nhwcDevice = nullptr;
+}
+
+/**
+ * @brief 保证输入缓冲区至少容纳numPillars个pillar，只在超出当前容量时重新分配
+ */
+bool PillarScatterRunner::Reserve(uint32_t numPillars)
+{
+    if (capacity > 0 && numPillars <= capacity) {
+        return true;
+    }
+    FreeInputs(host, false);
+#ifndef ASCENDC_CPU_DEBUG
+    FreeInputs(device, true);
+#endif
+    capacity = std::max<uint32_t>(numPillars, 1);
+    tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                capacity, capacity, config.options);
+    workspaceSize = GetWorkspaceSize(tilingData);
+    if (!AllocInputs(host, false)) {
+        return false;
+    }
+#ifndef ASCENDC_CPU_DEBUG
+    if (!AllocInputs(device, true)) {
+        return false;
+    }
+#endif
+    // int8反量化scale在各次launch间保持不变，随workspace一起上传
+    if (config.options.inputDtype == SCATTER_DTYPE_INT8) {
+        std::vector<uint16_t> scale = config.dequantScale;
+        scale.resize(config.featureSize, 0x3C00);  // 缺省为half(1.0)
+        memcpy((uint32_t *)host.workspace + tilingData.scaleOffset, scale.data(), scale.size() * sizeof(uint16_t));
+    }
+    // CSR模式的列下标和紧凑特征按容量预留，输出随输入一起扩容
+    if (config.options.scatterMode == SCATTER_MODE_CSR) {
+        FreeOutput();
+        outputSize = (size_t)tilingData.csrFeatureOffset * sizeof(uint32_t) +
+                     (size_t)capacity * config.featureSize * OutputElemSize(config.options.inputDtype);
+        if (!AllocOutput()) {
+            return false;
+        }
+    }
+    return config.options.scatterMode != SCATTER_MODE_INCREMENTAL || ClearPersistentState();
+}
+
+/**
+ * @brief 分配一组输入缓冲区：坐标和有效点数末尾各预留8个uint32_t，防止kernel按32字节对齐搬运时越界
+ */
+bool PillarScatterRunner::AllocInputs(InputBuffers &buffers, bool onDevice)
+{
+    size_t sizes[] = {(size_t)capacity * inputRowSize * InputElemSize(config.options.inputDtype),
+                      ((size_t)capacity + 8) * sizeof(uint32_t),
+                      (size_t)capacity * PILLAR_SCATTER_COORD_DIM * sizeof(uint32_t) + 8 * sizeof(uint32_t),
+                      2 * sizeof(uint32_t), sizeof(PillarScatterTilingData), workspaceSize};
+    uint8_t **ptrs[] = {&buffers.features, &buffers.pointCounts, &buffers.coords,
+                        &buffers.params, &buffers.tiling, &buffers.workspace};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+#ifdef ASCENDC_CPU_DEBUG
+        (void)onDevice;
+        *ptrs[i] = (uint8_t *)AscendC::GmAlloc(sizes[i]);
+#else
+        if (onDevice) {
+            RUNNER_CHECK_ACL(aclrtMalloc((void **)ptrs[i], sizes[i], ACL_MEM_MALLOC_HUGE_FIRST));
+        } else {
+            RUNNER_CHECK_ACL(aclrtMallocHost((void **)ptrs[i], sizes[i]));
+        }
+#endif
+    }
+    if (!onDevice) {
+        memset(buffers.workspace, 0, workspaceSize);
+    }
+    return true;
+}
+
+void PillarScatterRunner::FreeInputs(InputBuffers &buffers, bool onDevice)
+{
+    uint8_t *ptrs[] = {buffers.features, buffers.pointCounts, buffers.coords,
+                       buffers.params, buffers.tiling, buffers.workspace};
+    for (uint8_t *ptr : ptrs) {
+        if (ptr == nullptr) {
+            continue;
+        }
+#ifdef ASCENDC_CPU_DEBUG
+        (void)onDevice;
+        AscendC::GmFree((void *)ptr);
+#else
+        if (onDevice) {
+            aclrtFree(ptr);
+        } else {
+            aclrtFreeHost(ptr);
+        }
+#endif
+    }
+    buffers = {};
+}
+
+/**
+ * @brief INCREMENTAL模式：清零输出和cell列表，下一帧从全零输出开始
+ * 
+ * 首次分配或扩容后调用；扩容后cell列表长度改变，上一帧写过的cell无法再增量清零，只能整体清零。
+ */
+bool PillarScatterRunner::ClearPersistentState()
+{
+#ifdef ASCENDC_CPU_DEBUG
+    memset(ScatterOutput(), 0, outputSize);
+    memset(host.workspace, 0, workspaceSize);
+#else
+    RUNNER_CHECK_ACL(aclrtMemset(ScatterOutput(), outputSize, 0, outputSize));
+    RUNNER_CHECK_ACL(aclrtMemset(device.workspace, workspaceSize, 0, workspaceSize));
+#endif
+    return true;
+}
+
+/**
+ * @brief 将输入拷入host缓冲区并生成params、tiling和workspace
+ * 
+ * SORTED/CSR模式先按cell排序、INCREMENTAL模式按归属核分桶，越界pillar被丢弃后按有效数量重新计算tiling，
+ * 丢弃前统计坐标校验结果；
+ * CSR模式再把行偏移表和列下标直接写入outputHost。MULTIRES模式按粗网格块排序去重，处理的是去重后的cell。
+ * 选中通道切分而帧中有重复cell时退回不切分，保证每个输出行来自同一个pillar。
+ * 紧凑坐标在PILLAR模式下原样上传；SORTED模式解码为BYXR排序后重新编码，INCREMENTAL模式分桶后编码为LINEAR，
+ * 其余模式解码后上传BYXR。
+ * @return 本次launch实际处理的pillar数
+ */
+uint32_t PillarScatterRunner::PrepareInputs(const void *features, const uint32_t *coords, uint32_t numPillars,
+                                            const uint32_t *pointCounts)
+{
+    size_t inElemSize = InputElemSize(config.options.inputDtype);
+    memcpy(host.features, features, (size_t)numPillars * inputRowSize * inElemSize);
+    if (pointCounts != nullptr) {
+        memcpy(host.pointCounts, pointCounts, (size_t)numPillars * sizeof(uint32_t));
+    }
+    tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                numPillars, capacity, config.options);
+    // kernel直接读取的紧凑坐标原样拷入；SORTED/INCREMENTAL模式要在host上重排、其余模式的kernel只读BYXR，先解码
+    uint32_t inputFormat = config.options.coordFormat;
+    bool decoded = inputFormat != SCATTER_COORD_BYXR &&
+                   (tilingData.coordFormat == SCATTER_COORD_BYXR || config.options.scatterMode == SCATTER_MODE_SORTED ||
+                    config.options.scatterMode == SCATTER_MODE_INCREMENTAL);
+    if (decoded) {
+        UnpackCoords(coords, numPillars, inputFormat, config.nx, config.ny, (uint32_t *)host.coords);
+    } else {
+        memcpy(host.coords, coords, (size_t)numPillars * CoordWords(inputFormat) * sizeof(uint32_t));
+    }
+    uint32_t hostFormat = decoded ? SCATTER_COORD_BYXR : inputFormat;
+    if (!DeviceDiagnostics()) {
+        lastDiagnostics = CountCoordDiagnostics((const uint32_t *)host.coords, numPillars, tilingData);
+    }
+    if (config.options.scatterMode == SCATTER_MODE_SORTED || config.options.scatterMode == SCATTER_MODE_CSR) {
+        numPillars = SortPillarsByCell(host.features, (uint32_t *)host.coords, numPillars, tilingData, inElemSize);
+        tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                    numPillars, capacity, config.options);
+    } else if (config.options.scatterMode == SCATTER_MODE_INCREMENTAL) {
+        numPillars = BinPillarsByOwner(host.features, (uint32_t *)host.coords, numPillars, tilingData, inElemSize,
+                                       (uint32_t *)host.workspace);
+        tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                    numPillars, capacity, config.options);
+    } else if (config.options.scatterMode == SCATTER_MODE_MULTIRES) {
+        numPillars = SortPillarsByPoolBlock(host.features, (uint32_t *)host.coords, numPillars, tilingData,
+                                            inElemSize);
+        tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                    numPillars, capacity, config.options);
+    }
+    if (tilingData.channelSplit > 1 &&
+        HasDuplicateCells((const uint32_t *)host.coords, numPillars, hostFormat, tilingData,
+                          config.options.scatterMode == SCATTER_MODE_SORTED)) {
+        ScatterOptions options = config.options;
+        options.channelSplit = 1;
+        tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                    numPillars, capacity, options);
+    }
+    if (config.options.scatterMode == SCATTER_MODE_CSR) {
+        tilingData.cellCount = BuildCsrIndex((uint32_t *)host.coords, numPillars, tilingData,
+                                             (uint32_t *)host.workspace, (uint32_t *)outputHost);
+    }
+    lastCells = tilingData.cellCount;
+#ifdef PILLAR_SCATTER_PROFILE
+    // 清除上一次拷回的剖析字，未写出剖析字的kernel（PFN融合入口）不会被误认为有效
+    memset((uint32_t *)host.workspace + tilingData.profileOffset, 0,
+           (size_t)tilingData.coreNum * PILLAR_SCATTER_PROFILE_DIM * sizeof(uint32_t));
+#endif
+    
+    // 设置params参数（pillar数量、帧序号）
+    ((uint32_t *)host.params)[0] = numPillars;
+    ((uint32_t *)host.params)[1] = launchIndex;
+    memcpy(host.tiling, &tilingData, sizeof(PillarScatterTilingData));
+    if (config.options.scatterMode == SCATTER_MODE_BAND) {
+        BuildRowBins((uint32_t *)host.coords, tilingData, (uint32_t *)host.workspace);
+    } else if (config.options.scatterMode == SCATTER_MODE_MULTIRES) {
+        BuildPoolRegions((uint32_t *)host.coords, tilingData, (uint32_t *)host.workspace);
+    } else if (config.options.scatterMode != SCATTER_MODE_INCREMENTAL &&
+               config.options.scatterMode != SCATTER_MODE_CSR) {
+        PrepareSchedule((uint32_t *)host.coords, tilingData, (uint32_t *)host.workspace);
+    }
+    // SORTED模式排序后重新编码为kernel读取的紧凑格式，INCREMENTAL模式编码为cell下标
+    if (hostFormat != tilingData.coordFormat) {
+        PackCoords((const uint32_t *)host.coords, numPillars, tilingData.coordFormat, config.nx, config.ny,
+                   config.batchSize, (uint32_t *)host.coords);
+    }
+    return numPillars;
+}
+
+/**
+ * @brief SORTED/BAND/CSR/MULTIRES/INCREMENTAL模式在host上丢弃非法坐标，其余模式由kernel校验并写出诊断字
+ */
+bool PillarScatterRunner::DeviceDiagnostics() const
+{
+    return backward || config.options.scatterMode == SCATTER_MODE_PILLAR;
+}
+
+/**
+ * @brief 汇总各核写入host.workspace诊断区的计数
+ */
+void PillarScatterRunner::CollectDiagnostics()
+{
+    if (!DeviceDiagnostics()) {
+        return;
+    }
+    const uint32_t *diag = (const uint32_t *)host.workspace + tilingData.diagOffset;
+    lastDiagnostics = {};
+    for (uint32_t core = 0; core < tilingData.coreNum; core++) {
+        const uint32_t *words = diag + (size_t)core * PILLAR_SCATTER_DIAG_DIM;
+        lastDiagnostics.status |= words[SCATTER_DIAG_STATUS];
+        lastDiagnostics.validPillars += words[SCATTER_DIAG_VALID];
+        lastDiagnostics.outOfRange += words[SCATTER_DIAG_OUT_OF_RANGE];
+        lastDiagnostics.padding += words[SCATTER_DIAG_PADDING];
+    }
+}
+
+/**
+ * @brief 解码各核写入host.workspace剖析区的剖析字；任一核未写出有效标记时结果为空
+ */
+void PillarScatterRunner::CollectProfile()
+{
+    lastProfile.clear();
+#ifdef PILLAR_SCATTER_PROFILE
+    const uint32_t *profile = (const uint32_t *)host.workspace + tilingData.profileOffset;
+    for (uint32_t core = 0; core < tilingData.coreNum; core++) {
+        const uint32_t *words = profile + (size_t)core * PILLAR_SCATTER_PROFILE_DIM;
+        if (words[SCATTER_PROFILE_MAGIC] != PILLAR_SCATTER_PROFILE_MAGIC) {
+            lastProfile.clear();
+            return;
+        }
+        lastProfile.push_back({words[SCATTER_PROFILE_INIT], words[SCATTER_PROFILE_COPY_IN],
+                               words[SCATTER_PROFILE_SCATTER], words[SCATTER_PROFILE_TAIL],
+                               words[SCATTER_PROFILE_TILES], words[SCATTER_PROFILE_ENTRIES],
+                               words[SCATTER_PROFILE_WRITTEN], words[SCATTER_PROFILE_SKIPPED],
+                               words[SCATTER_PROFILE_BYTES_IN], words[SCATTER_PROFILE_BYTES_OUT]});
+    }
+#endif
+}
+
+bool PillarScatterRunner::Run(const void *features, const uint32_t *coords, uint32_t numPillars,
+                              const uint32_t *pointCounts)
+{
+    return Submit(features, coords, numPillars, pointCounts) && Wait();
+}
+
+bool PillarScatterRunner::Submit(const void *features, const uint32_t *coords, uint32_t numPillars,
+                                 const uint32_t *pointCounts)
+{
+    if (!initialized) {
+        printf("错误：PillarScatterRunner未初始化\n");
+        return false;
+    }
+    if ((config.options.maxPoints > 0) != (pointCounts != nullptr)) {
+        printf("错误：PFN融合输入需要且只需要提供每个pillar的有效点数\n");
+        return false;
+    }
+    // 上一次提交的输入缓冲区可能仍在拷贝，先等待完成
+    if (!Wait() || !Reserve(numPillars)) {
+        return false;
+    }
+    backward = false;
+    bool usePfn = config.options.maxPoints > 0;
+    bool transpose = config.options.outputLayout == SCATTER_LAYOUT_NCHW_TRANSPOSE;
+    uint8_t *scatterOutput = ScatterOutput();
+    // BAND模式由kernel写满整个输出；INCREMENTAL模式复用上一帧输出；CSR模式只写有效部分；其余模式需预先清零
+    bool csr = config.options.scatterMode == SCATTER_MODE_CSR;
+    bool clearOutput = config.options.scatterMode != SCATTER_MODE_BAND &&
+                       config.options.scatterMode != SCATTER_MODE_INCREMENTAL && !csr;
+    
+#ifdef ASCENDC_CPU_DEBUG
+    auto start_time = std::chrono::high_resolution_clock::now();
+    lastPillars = PrepareInputs(features, coords, numPillars, pointCounts);
+    if (clearOutput) {
+        memset(scatterOutput, 0, outputSize);
+    }
+    auto kernel_start_time = std::chrono::high_resolution_clock::now();
+    if (usePfn) {
+        ICPU_RUN_KF(pillar_scatter_pfn_custom, config.blockDim, host.features, host.pointCounts, host.coords,
+                    host.params, host.tiling, host.workspace, scatterOutput);
+    } else {
+        ICPU_RUN_KF(pillar_scatter_custom, config.blockDim, host.features, host.coords, host.params, host.tiling,
+                    host.workspace, scatterOutput);
+    }
+    if (transpose) {
+        ICPU_RUN_KF(pillar_scatter_transpose_custom, config.blockDim, scatterOutput, host.tiling, outputDevice);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    lastKernelMs = std::chrono::duration<float, std::milli>(end_time - kernel_start_time).count();
+    lastLaunchMs = std::chrono::duration<float, std::milli>(end_time - start_time).count();
+    CollectDiagnostics();
+    CollectProfile();
+#else
+    lastPillars = PrepareInputs(features, coords, numPillars, pointCounts);
+    aclrtStream launchStream = (aclrtStream)stream;
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)startEvent, launchStream));
+    size_t featureBytes = (size_t)lastPillars * inputRowSize * InputElemSize(config.options.inputDtype);
+    size_t coordsBytes = (size_t)lastPillars * CoordWords(tilingData.coordFormat) * sizeof(uint32_t) +
+                         8 * sizeof(uint32_t);
+    if (featureBytes > 0) {
+        RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.features, featureBytes, host.features, featureBytes,
+                                          ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    }
+    if (usePfn) {
+        size_t countsBytes = ((size_t)lastPillars + 8) * sizeof(uint32_t);
+        RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.pointCounts, countsBytes, host.pointCounts, countsBytes,
+                                          ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    }
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.coords, coordsBytes, host.coords, coordsBytes,
+                                      ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.params, 2 * sizeof(uint32_t), host.params, 2 * sizeof(uint32_t),
+                                      ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.tiling, sizeof(PillarScatterTilingData), host.tiling,
+                                      sizeof(PillarScatterTilingData), ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    // INCREMENTAL模式的cell列表跨帧保留在设备上，只上传之前的各核pillar起始表
+    size_t uploadBytes = config.options.scatterMode == SCATTER_MODE_INCREMENTAL ?
+                         (size_t)tilingData.cellListOffset * sizeof(uint32_t) : workspaceSize;
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.workspace, uploadBytes, host.workspace, uploadBytes,
+                                      ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    // CSR模式只上传行偏移表和本帧M个列下标
+    if (csr) {
+        size_t indexBytes = ((size_t)tilingData.csrColumnOffset + lastCells) * sizeof(uint32_t);
+        RUNNER_CHECK_ACL(aclrtMemcpyAsync(outputDevice, indexBytes, outputHost, indexBytes,
+                                          ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    }
+    // 输出直接在设备上清零，不经host拷贝整张特征图
+    if (clearOutput) {
+        RUNNER_CHECK_ACL(aclrtMemsetAsync(scatterOutput, outputSize, 0, outputSize, launchStream));
+    }
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)kernelStartEvent, launchStream));
+    if (usePfn) {
+        ACLRT_LAUNCH_KERNEL(pillar_scatter_pfn_custom)(config.blockDim, launchStream, device.features,
+                                                       device.pointCounts, device.coords, device.params,
+                                                       device.tiling, device.workspace, scatterOutput);
+    } else {
+        ACLRT_LAUNCH_KERNEL(pillar_scatter_custom)(config.blockDim, launchStream, device.features, device.coords,
+                                                   device.params, device.tiling, device.workspace, scatterOutput);
+    }
+    // 对比基线：单独的转置kernel，计入kernel耗时
+    if (transpose) {
+        ACLRT_LAUNCH_KERNEL(pillar_scatter_transpose_custom)(config.blockDim, launchStream, scatterOutput,
+                                                             device.tiling, outputDevice);
+    }
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)kernelEndEvent, launchStream));
+    // 各核的诊断字只有blockDim*32字节，每次都拷回，Wait时汇总
+    if (DeviceDiagnostics()) {
+        size_t diagOffset = (size_t)tilingData.diagOffset * sizeof(uint32_t);
+        size_t diagBytes = (size_t)tilingData.coreNum * PILLAR_SCATTER_DIAG_DIM * sizeof(uint32_t);
+        RUNNER_CHECK_ACL(aclrtMemcpyAsync(host.workspace + diagOffset, diagBytes, device.workspace + diagOffset,
+                                          diagBytes, ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+    }
+#ifdef PILLAR_SCATTER_PROFILE
+    size_t profileOffset = (size_t)tilingData.profileOffset * sizeof(uint32_t);
+    size_t profileBytes = (size_t)tilingData.coreNum * PILLAR_SCATTER_PROFILE_DIM * sizeof(uint32_t);
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(host.workspace + profileOffset, profileBytes, device.workspace + profileOffset,
+                                      profileBytes, ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+#endif
+    if (config.downloadOutput && csr) {
+        // 索引本就在host上，只拷回M个cell的紧凑特征
+        size_t featureOffset = (size_t)tilingData.csrFeatureOffset * sizeof(uint32_t);
+        size_t cellBytes = (size_t)lastCells * config.featureSize * OutputElemSize(config.options.inputDtype);
+        if (cellBytes > 0) {
+            RUNNER_CHECK_ACL(aclrtMemcpyAsync(outputHost + featureOffset, cellBytes, outputDevice + featureOffset,
+                                              cellBytes, ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+        }
+    } else if (config.downloadOutput) {
+        RUNNER_CHECK_ACL(aclrtMemcpyAsync(outputHost, outputSize, outputDevice, outputSize,
+                                          ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+    }
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)endEvent, launchStream));
+    pending = true;
+#endif
+    launchIndex++;
+    return true;
+}
+
+bool PillarScatterRunner::Wait()
+{
+    if (!pending) {
+        return true;
+    }
+    pending = false;
+#ifndef ASCENDC_CPU_DEBUG
+    RUNNER_CHECK_ACL(aclrtSynchronizeEvent((aclrtEvent)endEvent));
+    RUNNER_CHECK_ACL(aclrtEventElapsedTime(&lastLaunchMs, (aclrtEvent)startEvent, (aclrtEvent)endEvent));
+    RUNNER_CHECK_ACL(aclrtEventElapsedTime(&lastKernelMs, (aclrtEvent)kernelStartEvent,
+                                           (aclrtEvent)kernelEndEvent));
+    CollectDiagnostics();
+    CollectProfile();
+#endif
+    return true;
+}
+
+/**
+ * @brief 反向的host侧准备：拷入（解码）坐标并写入梯度份数，按PILLAR模式、STATIC调度生成tiling
+ * @return 本次反向的pillar数
+ */
+uint32_t PillarScatterRunner::PrepareBackward(const uint32_t *coords, uint32_t numPillars)
+{
+    // 梯度份数写入BYXR坐标的保留字段，紧凑坐标先解码
+    UnpackCoords(coords, numPillars, config.options.coordFormat, config.nx, config.ny, (uint32_t *)host.coords);
+    ScatterOptions options = config.options;
+    options.scatterMode = SCATTER_MODE_PILLAR;
+    options.scheduleMode = SCATTER_SCHEDULE_STATIC;
+    options.channelSplit = 1;
+    options.coordFormat = SCATTER_COORD_BYXR;
+    tilingData = GenerateTiling(config.nx, config.ny, config.featureSize, config.batchSize, config.blockDim,
+                                numPillars, capacity, options);
+    BuildGatherShares((uint32_t *)host.coords, numPillars, tilingData);
+#ifdef PILLAR_SCATTER_PROFILE
+    memset((uint32_t *)host.workspace + tilingData.profileOffset, 0,
+           (size_t)tilingData.coreNum * PILLAR_SCATTER_PROFILE_DIM * sizeof(uint32_t));
+#endif
+    ((uint32_t *)host.params)[0] = numPillars;
+    ((uint32_t *)host.params)[1] = launchIndex;
+    memcpy(host.tiling, &tilingData, sizeof(PillarScatterTilingData));
+    return numPillars;
+}
+
+bool PillarScatterRunner::RunBackward(const void *outputGrad, const uint32_t *coords, uint32_t numPillars)
+{
+    return SubmitBackward(outputGrad, coords, numPillars) && Wait();
+}
+
+bool PillarScatterRunner::SubmitBackward(const void *outputGrad, const uint32_t *coords, uint32_t numPillars)
+{
+    if (!initialized) {
+        printf("错误：PillarScatterRunner未初始化\n");
+        return false;
+    }
+    if (!BackwardSupported() || !Wait() || !Reserve(numPillars)) {
+        return false;
+    }
+    backward = true;
+    
+#ifdef ASCENDC_CPU_DEBUG
+    auto start_time = std::chrono::high_resolution_clock::now();
+    lastPillars = PrepareBackward(coords, numPillars);
+    memcpy(outputDevice, outputGrad, outputSize);
+    auto kernel_start_time = std::chrono::high_resolution_clock::now();
+    ICPU_RUN_KF(pillar_gather_custom, config.blockDim, outputDevice, host.coords, host.params, host.tiling,
+                host.workspace, host.features);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    lastKernelMs = std::chrono::duration<float, std::milli>(end_time - kernel_start_time).count();
+    lastLaunchMs = std::chrono::duration<float, std::milli>(end_time - start_time).count();
+    CollectDiagnostics();
+    CollectProfile();
+#else
+    lastPillars = PrepareBackward(coords, numPillars);
+    // 输出梯度经锁页内存异步上传；downloadOutput为false时outputHost在首次反向时分配
+    if (outputHost == nullptr) {
+        RUNNER_CHECK_ACL(aclrtMallocHost((void **)&outputHost, outputSize));
+    }
+    memcpy(outputHost, outputGrad, outputSize);
+    aclrtStream launchStream = (aclrtStream)stream;
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)startEvent, launchStream));
+    size_t coordsBytes = (size_t)lastPillars * PILLAR_SCATTER_COORD_DIM * sizeof(uint32_t) + 8 * sizeof(uint32_t);
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(outputDevice, outputSize, outputHost, outputSize, ACL_MEMCPY_HOST_TO_DEVICE,
+                                      launchStream));
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.coords, coordsBytes, host.coords, coordsBytes,
+                                      ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.params, 2 * sizeof(uint32_t), host.params, 2 * sizeof(uint32_t),
+                                      ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(device.tiling, sizeof(PillarScatterTilingData), host.tiling,
+                                      sizeof(PillarScatterTilingData), ACL_MEMCPY_HOST_TO_DEVICE, launchStream));
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)kernelStartEvent, launchStream));
+    ACLRT_LAUNCH_KERNEL(pillar_gather_custom)(config.blockDim, launchStream, outputDevice, device.coords,
+                                              device.params, device.tiling, device.workspace, device.features);
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)kernelEndEvent, launchStream));
+    size_t diagOffset = (size_t)tilingData.diagOffset * sizeof(uint32_t);
+    size_t diagBytes = (size_t)tilingData.coreNum * PILLAR_SCATTER_DIAG_DIM * sizeof(uint32_t);
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(host.workspace + diagOffset, diagBytes, device.workspace + diagOffset,
+                                      diagBytes, ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+#ifdef PILLAR_SCATTER_PROFILE
+    size_t profileOffset = (size_t)tilingData.profileOffset * sizeof(uint32_t);
+    size_t profileBytes = (size_t)tilingData.coreNum * PILLAR_SCATTER_PROFILE_DIM * sizeof(uint32_t);
+    RUNNER_CHECK_ACL(aclrtMemcpyAsync(host.workspace + profileOffset, profileBytes, device.workspace + profileOffset,
+                                      profileBytes, ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+#endif
+    size_t gradBytes = (size_t)lastPillars * config.featureSize * OutputElemSize(config.options.inputDtype);
+    if (gradBytes > 0) {
+        RUNNER_CHECK_ACL(aclrtMemcpyAsync(host.features, gradBytes, device.features, gradBytes,
+                                          ACL_MEMCPY_DEVICE_TO_HOST, launchStream));
+    }
+    RUNNER_CHECK_ACL(aclrtRecordEvent((aclrtEvent)endEvent, launchStream));
+    pending = true;
+#endif
+    launchIndex++;
+    return true;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file pillar_scatter_runner.h
+ *
+ * PillarScatter算子的host侧封装，供推理服务等嵌入使用。
+ * PillarScatterRunner持有ACL设备、流和全部设备缓冲区/锁页内存，缓冲区按出现过的最大帧分配并跨调用复用，
+ * 每次Run只做输入拷贝、host侧预处理（排序/分桶/调度表）和launch，不再申请释放内存。
+ * CPU调试模式(ASCENDC_CPU_DEBUG)下以GmAlloc缓冲区代替设备内存，通过ICPU_RUN_KF同步执行。
+ */
+#ifndef PILLAR_SCATTER_RUNNER_H
+#define PILLAR_SCATTER_RUNNER_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pillar_scatter_tiling.h"
+
+// scatter模式、重复坐标归约、多核调度、特征类型和输出布局，原样写入tiling
+struct ScatterOptions {
+    uint32_t scatterMode;   // PillarScatterMode
+    uint32_t reduceMode;    // PillarScatterReduce
+    uint32_t scheduleMode;  // PillarScatterSchedule
+    uint32_t inputDtype;    // PillarScatterDtype
+    uint32_t maxPoints;     // PFN融合入口每个pillar的最大点数，0表示输入已是 [P, C] 的pillar特征
+    uint32_t outputLayout;  // PillarScatterLayout，缺省为NHWC
+    uint32_t poolMode;      // MULTIRES模式的池化方式：SCATTER_REDUCE_MAX或SCATTER_REDUCE_MEAN
+    uint32_t poolStrideMask;  // MULTIRES模式的池化步长：第k位表示步长2^k（1<=k<=PILLAR_SCATTER_MAX_POOL_SHIFT）
+    uint32_t channelSplit;  // PILLAR/SORTED模式STATIC调度的通道切分份数：0按pillar数和C自动选择，1不切分，其余为指定份数
+    uint32_t coordFormat;   // PillarScatterCoordFormat，Run/RunBackward传入的坐标格式，缺省为BYXR
+};
+
+// Runner的固定配置，输出 [batchSize, ny, nx, featureSize] 在Init时一次分配（CSR模式按pillar容量分配，
+// MULTIRES模式之后依次为各步长的池化输出）
+struct PillarScatterConfig {
+    uint32_t nx;                        // BEV特征图宽度 W
+    uint32_t ny;                        // BEV特征图高度 H
+    uint32_t featureSize;               // 每个pillar的特征维度 C
+    uint32_t batchSize;                 // 每次launch的batch数 B，coords[:, 0]需小于B
+    uint32_t blockDim;                  // launch的核数
+    ScatterOptions options;
+    uint32_t maxPillars;                // 初始pillar容量，0表示首帧时分配；之后只在出现更大的帧时扩容
+    bool downloadOutput;                // 每次launch后把输出拷回host锁页内存（HostOutput）
+    int32_t deviceId;                   // NPU设备号
+    std::vector<uint16_t> dequantScale; // int8输入的逐通道scale [C] half，空表示全为1
+};
+
+// 一次launch的坐标校验结果：PILLAR模式和PFN融合入口由kernel汇报，其余模式由host在丢弃前统计
+struct ScatterDiagnostics {
+    uint32_t status;        // PillarScatterStatus位掩码，0表示全部条目合法
+    uint32_t validPillars;  // 坐标合法、被写出的条目数
+    uint32_t outOfRange;    // batch/y/x越界的条目数
+    uint32_t padding;       // 填充条目数（y、x均为PILLAR_PADDING_COORD）
+};
+
+// 性能剖析（PILLAR_SCATTER_PROFILE编译选项）下一个核的结果，各阶段为GetSystemCycle()计数
+struct CoreProfile {
+    uint32_t initCycles;     // 初始化
+    uint32_t copyInCycles;   // 搬入，含等待MTE2完成
+    uint32_t scatterCycles;  // 计算输出位置并写出
+    uint32_t tailCycles;     // 收尾：INCREMENTAL模式的清零、诊断字写出
+    uint32_t tiles;          // 处理的块数
+    uint32_t entries;        // 扫描的输入条目数
+    uint32_t written;        // 写出的pillar/cell数
+    uint32_t skipped;        // 坐标非法被跳过的条目数
+    uint32_t bytesIn;        // 从GM读入的字节数
+    uint32_t bytesOut;       // 写入输出的字节数
+};
+
+// 输入特征的元素字节数
+size_t InputElemSize(uint32_t dtype);
+
+// 输出特征的元素字节数：int8输入反量化为half，其余与输入相同
+size_t OutputElemSize(uint32_t dtype);
+
+// 坐标格式下每个pillar的uint32个数：BYXR为4，紧凑格式为1
+uint32_t CoordWords(uint32_t format);
+
+/**
+ * @brief 坐标格式能否表示该输出形状：LINEAR要求B*ny*nx小于PILLAR_PADDING_COORD，
+ *        YX16要求batch为1且nx、ny不超过0xFFFE（0xFFFF留给填充条目）
+ */
+bool CoordFormatSupported(uint32_t format, uint32_t nx, uint32_t ny, uint32_t batchSize);
+
+/**
+ * @brief 把 [numPillars, 4] 坐标编码为format格式，packed可与coords相同（原地编码）
+ *
+ * 供测试和不能直接输出紧凑坐标的上游使用。填充条目编码为PILLAR_PADDING_COORD（YX16为两半均为0xFFFF），
+ * 越界或该格式不能表示的条目（YX16下batch不为0）编码为kernel判为越界的值，诊断计数与BYXR输入一致。
+ */
+void PackCoords(const uint32_t *coords, uint32_t numPillars, uint32_t format, uint32_t nx, uint32_t ny,
+                uint32_t batchSize, uint32_t *packed);
+
+/**
+ * @brief 把format格式的坐标解码为 [numPillars, 4]（保留字段为0），packed与coords不能重叠
+ *
+ * 填充条目解码为四个字段均为PILLAR_PADDING_COORD，越界条目解码后仍越界。
+ */
+void UnpackCoords(const uint32_t *packed, uint32_t numPillars, uint32_t format, uint32_t nx, uint32_t ny,
+                  uint32_t *coords);
+
+/**
+ * @brief 选择通道切分份数 G（2的幂），不适用或指定值不满足约束时返回1
+ *
+ * 只用于PILLAR/SORTED模式的STATIC调度（不含PFN融合入口）：G需整除blockDim，每核通道片为C/G个通道，
+ * 长度为32字节的倍数且不少于PILLAR_SCATTER_SPLIT_MIN_BYTES。自动选择时从1开始加倍，
+ * 直到每核pillar数不少于PILLAR_SCATTER_SPLIT_MIN_PILLARS或不能再切。
+ */
+uint32_t ChooseChannelSplit(uint32_t featureSize, uint32_t blockDim, uint32_t numPillars,
+                            const ScatterOptions &options);
+
+/**
+ * @brief 检查配置是否在各kernel支持的范围内，不满足时打印原因并返回false；Init先调用本函数
+ *
+ * 覆盖会导致未对齐搬运、越界写出或被kernel静默忽略的组合：非band/csr模式的非覆盖归约、
+ * 非sorted模式的region调度、非fp16的band/incremental/csr模式、C不是32倍数的int8、
+ * PFN融合入口和NCHW输出的限制、不满足约束的指定通道切分、nx/ny不是最大池化步长倍数的multires模式，
+ * 以及坐标格式不能表示的输出形状。
+ */
+bool ValidateConfig(const PillarScatterConfig &config);
+
+/**
+ * @brief 检查配置是否支持反向，不满足时打印原因并返回false
+ *
+ * 覆盖模式的反向把同一cell的梯度只给按原始顺序最后一个pillar，要求前向也确定地由它生效：
+ * band模式、region调度的sorted模式或单核。多核的pillar模式和static/dynamic调度的sorted模式中，
+ * 同一cell的重复pillar可能由不同核写出，生效的pillar取决于核间竞争。
+ */
+bool BackwardSupported(const PillarScatterConfig &config);
+
+/**
+ * @brief 计算PillarScatter的tiling数据
+ *
+ * numPillars为本次launch的pillar数，maxPillars为缓冲区容量（INCREMENTAL模式的cell列表按其分配）。
+ */
+PillarScatterTilingData GenerateTiling(uint32_t nx, uint32_t ny, uint32_t featureSize, uint32_t batchSize,
+                                       uint32_t blockDim, uint32_t numPillars, uint32_t maxPillars,
+                                       const ScatterOptions &options);
+
+/**
+ * @brief PillarScatter算子的可复用执行器
+ *
+ * 典型用法：构造 -> Init -> 多次Run（或Submit/Wait）-> 析构。
+ * 同一进程内可以同时存在多个Runner（例如每个流一个），ACL在第一个Runner Init时初始化、
+ * 最后一个Runner析构时去初始化。单个Runner不是线程安全的。
+ * INCREMENTAL模式下输出和cell列表跨Run保留，Run的顺序即帧顺序。
+ * RunBackward执行前向的反向（PillarGather），复用同一组缓冲区，执行后输出缓冲区中为上传的输出梯度。
+ */
+class PillarScatterRunner {
+public:
+    explicit PillarScatterRunner(const PillarScatterConfig &config);
+    ~PillarScatterRunner();
+    PillarScatterRunner(const PillarScatterRunner &) = delete;
+    PillarScatterRunner &operator=(const PillarScatterRunner &) = delete;
+
+    /**
+     * @brief 初始化ACL设备和流，分配输出及初始容量的输入缓冲区
+     * @return 配置不合法（ValidateConfig）或任一ACL调用失败时返回false
+     */
+    bool Init();
+
+    /**
+     * @brief 同步执行一次scatter：Submit后等待完成
+     *
+     * @param features pillar特征 [numPillars, C]（PFN融合输入为 [numPillars, maxPoints, C]），类型由inputDtype决定
+     * @param coords 坐标，格式由options.coordFormat决定：[numPillars, 4] uint32 (batch, y, x, reserved)，
+     *               或紧凑格式的 [numPillars] uint32（线性cell下标 / 打包的int16 (y, x)）
+     * @param pointCounts PFN融合输入的每个pillar有效点数 [numPillars]，其余情况传nullptr
+     */
+    bool Run(const void *features, const uint32_t *coords, uint32_t numPillars,
+             const uint32_t *pointCounts = nullptr);
+
+    /**
+     * @brief 异步提交一次scatter：输入拷入锁页内存并完成host侧预处理后，在本Runner的流上依次下发
+     *        H2D拷贝、输出清零、kernel和（downloadOutput时）D2H拷贝，不等待完成
+     *
+     * 上一次提交尚未Wait时先等待其完成。CPU调试模式下同步执行。
+     */
+    bool Submit(const void *features, const uint32_t *coords, uint32_t numPillars,
+                const uint32_t *pointCounts = nullptr);
+
+    /**
+     * @brief 等待最近一次Submit完成并记录其设备侧耗时
+     */
+    bool Wait();
+
+    /**
+     * @brief 同步执行一次反向：SubmitBackward后等待完成
+     *
+     * @param outputGrad 输出梯度 [batchSize, ny, nx, C]（NHWC），类型与前向输出相同
+     * @param coords 前向使用的坐标（格式与Run相同），pillar梯度与其顺序一致
+     */
+    bool RunBackward(const void *outputGrad, const uint32_t *coords, uint32_t numPillars);
+
+    /**
+     * @brief 异步提交一次反向：host按前向的归约方式计算每个pillar分得的梯度份数，
+     *        上传输出梯度和坐标后launch pillar_gather_custom，并把pillar梯度拷回HostFeatureGrad()
+     *
+     * 支持PILLAR/SORTED/BAND模式的NHWC输出，归约方式为覆盖、SUM或MEAN；
+     * 覆盖模式下同一cell的梯度只给按原始顺序最后一个pillar，其余为0，前向须为确定的配置（见BackwardSupported）。
+     */
+    bool SubmitBackward(const void *outputGrad, const uint32_t *coords, uint32_t numPillars);
+
+    // 当前配置是否支持反向，不支持时打印原因
+    bool BackwardSupported() const { return ::BackwardSupported(config); }
+
+    // 最近一次完成的反向的pillar梯度 [numPillars, C]，类型与输出相同；Wait之后有效
+    const uint8_t *HostFeatureGrad() const { return host.features; }
+
+    // 最近一次完成的launch的输出（downloadOutput为true时有效），大小为OutputSize()
+    const uint8_t *HostOutput() const { return outputHost; }
+    // 设备上的输出缓冲区，可直接交给后续算子使用；布局由outputLayout决定
+    uint8_t *DeviceOutput() const { return outputDevice; }
+    size_t OutputSize() const { return outputSize; }
+    // MULTIRES模式：步长 2^shift 的池化输出 [batchSize, ny>>shift, nx>>shift, C] 在输出中的字节偏移，
+    // shift为0时即全分辨率输出
+    size_t PoolOutputOffset(uint32_t shift) const;
+    // 最近一次launch实际处理的pillar数（SORTED/CSR模式下不含被丢弃的越界pillar，MULTIRES模式下为去重后的cell数）
+    uint32_t LastPillars() const { return lastPillars; }
+    // 最近一次完成的launch的坐标校验结果，Wait之后有效
+    const ScatterDiagnostics &LastDiagnostics() const { return lastDiagnostics; }
+    // 最近一次完成的launch的各核剖析结果，Wait之后有效；未开启PILLAR_SCATTER_PROFILE或kernel未写出时为空
+    const std::vector<CoreProfile> &LastProfile() const { return lastProfile; }
+    // CSR模式：最近一次launch去重后的cell数 M
+    uint32_t LastCells() const { return lastCells; }
+    // 最近一次launch的通道切分份数，1表示未切分（不适用、pillar足够多或帧中有重复cell）
+    uint32_t LastChannelSplit() const { return tilingData.channelSplit; }
+    // CSR模式的host输出：行偏移表 [B*ny+1]、列下标 [M] 和紧凑特征 [M, C]，第r行（b*ny+y）的cell为
+    // [rowOffsets[r], rowOffsets[r+1])；DeviceOutput中的布局相同（偏移见tiling的csrColumnOffset/csrFeatureOffset）
+    const uint32_t *CsrRowOffsets() const { return (const uint32_t *)outputHost; }
+    const uint32_t *CsrColumns() const { return (const uint32_t *)outputHost + tilingData.csrColumnOffset; }
+    const uint8_t *CsrFeatures() const
+    {
+        return outputHost + (size_t)tilingData.csrFeatureOffset * sizeof(uint32_t);
+    }
+    // 最近一次launch从开始上传到全部完成的耗时（ms），NPU模式由事件计时，CPU模式为墙钟时间
+    float LastLaunchMs() const { return lastLaunchMs; }
+    // 最近一次launch中kernel本身的耗时（ms），不含拷贝和输出清零
+    float LastKernelMs() const { return lastKernelMs; }
+    const PillarScatterConfig &Config() const { return config; }
+
+private:
+    // host侧或设备侧的一组输入缓冲区
+    struct InputBuffers {
+        uint8_t *features;
+        uint8_t *pointCounts;
+        uint8_t *coords;
+        uint8_t *params;
+        uint8_t *tiling;
+        uint8_t *workspace;
+    };
+
+    bool Reserve(uint32_t numPillars);
+    bool AllocOutput();
+    void FreeOutput();
+    // scatter kernel写入的缓冲区：NCHW_TRANSPOSE布局下为NHWC中间结果，否则即输出
+    uint8_t *ScatterOutput() const { return nhwcDevice != nullptr ? nhwcDevice : outputDevice; }
+    bool AllocInputs(InputBuffers &buffers, bool device);
+    void FreeInputs(InputBuffers &buffers, bool device);
+    bool ClearPersistentState();
+    uint32_t PrepareInputs(const void *features, const uint32_t *coords, uint32_t numPillars,
+                           const uint32_t *pointCounts);
+    // 坐标校验由kernel完成（否则由host在PrepareInputs中统计）
+    bool DeviceDiagnostics() const;
+    void CollectDiagnostics();
+    void CollectProfile();
+    uint32_t PrepareBackward(const uint32_t *coords, uint32_t numPillars);
+
+    PillarScatterConfig config;
+    uint32_t inputRowSize;        // 每个pillar的输入特征元素数：C 或 maxPoints*C
+    uint32_t capacity = 0;        // 当前输入缓冲区可容纳的pillar数
+    size_t workspaceSize = 0;
+    size_t outputSize = 0;
+    uint32_t launchIndex = 0;     // 已提交的launch数，作为params[1]帧序号
+    uint32_t lastPillars = 0;
+    uint32_t lastCells = 0;
+    float lastLaunchMs = 0;
+    float lastKernelMs = 0;
+    ScatterDiagnostics lastDiagnostics = {};
+    std::vector<CoreProfile> lastProfile;
+    bool initialized = false;
+    bool pending = false;         // 存在已Submit未Wait的launch
+    bool backward = false;        // 最近一次launch为反向
+    PillarScatterTilingData tilingData = {};
+    InputBuffers host = {};       // CPU模式下即kernel直接使用的GM缓冲区
+    InputBuffers device = {};     // CPU模式下不使用
+    uint8_t *outputHost = nullptr;
+    uint8_t *outputDevice = nullptr;
+    uint8_t *nhwcDevice = nullptr;     // NCHW_TRANSPOSE布局的NHWC中间结果
+    void *stream = nullptr;       // aclrtStream
+    void *startEvent = nullptr;   // aclrtEvent
+    void *endEvent = nullptr;     // aclrtEvent
+    void *kernelStartEvent = nullptr;  // aclrtEvent，紧接kernel之前
+    void *kernelEndEvent = nullptr;    // aclrtEvent，紧接kernel之后
+};
+
+#endif // PILLAR_SCATTER_RUNNER_H
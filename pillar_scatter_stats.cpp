@@ -0,0 +1,232 @@
+/**
+ * @file pillar_scatter_stats.cpp
+ *
+ * PillarScatter输出统计的实现。各线程处理互不相交的BEV行，行计数直接写入结果，其余计数在线程结束后合并。
+ */
+#include "pillar_scatter_stats.h"
+#include "pillar_scatter_host_utils.h"
+#include "pillar_scatter_tiling.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+// 单个线程的部分统计
+struct PartialStats {
+    uint64_t nonZeroElements = 0;
+    uint64_t occupiedCells = 0;
+    uint64_t firstNonZero = UINT64_MAX;
+    uint32_t firstNonZeroBits = 0;
+    uint64_t nanCount = 0;
+    uint64_t infCount = 0;
+    uint64_t finiteCount = 0;
+    float minValue = INFINITY;
+    float maxValue = -INFINITY;
+    double sum = 0;
+};
+
+size_t StatsElemSize(const StatsShape &shape)
+{
+    return shape.inputDtype == SCATTER_DTYPE_FP32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+/**
+ * @brief 统计一个被写入cell的全部元素，cellBase为该cell首元素的NHWC下标
+ */
+void AccumulateCell(const uint8_t *cell, uint64_t cellBase, const StatsShape &shape, PartialStats &partial)
+{
+    size_t elemSize = StatsElemSize(shape);
+    partial.occupiedCells++;
+    for (uint32_t c = 0; c < shape.featureSize; c++) {
+        uint32_t bits = 0;
+        memcpy(&bits, cell + c * elemSize, elemSize);
+        if (bits == 0) {
+            partial.finiteCount++;
+            continue;
+        }
+        if (partial.firstNonZero == UINT64_MAX) {
+            partial.firstNonZero = cellBase + c;
+            partial.firstNonZeroBits = bits;
+        }
+        partial.nonZeroElements++;
+        float value;
+        if (shape.inputDtype == SCATTER_DTYPE_FP32) {
+            memcpy(&value, &bits, sizeof(value));
+        } else if (shape.inputDtype == SCATTER_DTYPE_BF16) {
+            value = Bf16BitsToFloat(static_cast<uint16_t>(bits));
+        } else {
+            value = HalfBitsToFloat(static_cast<uint16_t>(bits));
+        }
+        if (std::isnan(value)) {
+            partial.nanCount++;
+        } else if (std::isinf(value)) {
+            partial.infCount++;
+        } else {
+            partial.finiteCount++;
+            partial.minValue = std::min(partial.minValue, value);
+            partial.maxValue = std::max(partial.maxValue, value);
+            partial.sum += value;
+        }
+    }
+}
+
+/**
+ * @brief 合并各线程的部分统计，并由行计数生成占用率直方图
+ */
+void FinishStats(const std::vector<PartialStats> &partials, const StatsShape &shape, OutputStats &stats)
+{
+    PartialStats merged;
+    for (const PartialStats &partial : partials) {
+        merged.nonZeroElements += partial.nonZeroElements;
+        merged.occupiedCells += partial.occupiedCells;
+        if (partial.firstNonZero < merged.firstNonZero) {
+            merged.firstNonZero = partial.firstNonZero;
+            merged.firstNonZeroBits = partial.firstNonZeroBits;
+        }
+        merged.nanCount += partial.nanCount;
+        merged.infCount += partial.infCount;
+        merged.finiteCount += partial.finiteCount;
+        merged.minValue = std::min(merged.minValue, partial.minValue);
+        merged.maxValue = std::max(merged.maxValue, partial.maxValue);
+        merged.sum += partial.sum;
+    }
+    stats.totalElements = static_cast<uint64_t>(shape.batchSize) * shape.ny * shape.nx * shape.featureSize;
+    stats.nonZeroElements = merged.nonZeroElements;
+    stats.occupiedCells = merged.occupiedCells;
+    stats.firstNonZero = merged.firstNonZero;
+    stats.firstNonZeroBits = merged.firstNonZeroBits;
+    stats.nanCount = merged.nanCount;
+    stats.infCount = merged.infCount;
+    stats.minValue = merged.finiteCount > 0 ? merged.minValue : 0.0f;
+    stats.maxValue = merged.finiteCount > 0 ? merged.maxValue : 0.0f;
+    stats.meanValue = merged.finiteCount > 0 ? merged.sum / merged.finiteCount : 0.0;
+    for (uint64_t &count : stats.occupancyHistogram) {
+        count = 0;
+    }
+    for (uint32_t occupancy : stats.rowOccupancy) {
+        uint64_t bin = static_cast<uint64_t>(occupancy) * OCCUPANCY_HISTOGRAM_BINS / shape.nx;
+        stats.occupancyHistogram[std::min<uint64_t>(bin, OCCUPANCY_HISTOGRAM_BINS - 1)]++;
+    }
+}
+} // namespace
+
+void ComputeOutputStats(const uint8_t *output, const StatsShape &shape, uint32_t threadNum, OutputStats &stats)
+{
+    stats = OutputStats{};
+    uint32_t rowNum = shape.batchSize * shape.ny;
+    stats.rowOccupancy.assign(rowNum, 0);
+    size_t cellBytes = shape.featureSize * StatsElemSize(shape);
+    size_t rowBytes = shape.nx * cellBytes;
+    threadNum = ResolveThreadNum(threadNum);
+    std::vector<PartialStats> partials(threadNum);
+    ParallelFor(threadNum, rowNum, [&](uint32_t t, size_t begin, size_t end) {
+        PartialStats &partial = partials[t];
+        for (size_t row = begin; row < end; row++) {
+            const uint8_t *rowData = output + row * rowBytes;
+            // 绝大多数行为空，整行一次全零检查
+            if (AllZero(rowData, rowBytes)) {
+                continue;
+            }
+            uint64_t occupiedBefore = partial.occupiedCells;
+            for (uint32_t x = 0; x < shape.nx; x++) {
+                if (!AllZero(rowData + x * cellBytes, cellBytes)) {
+                    AccumulateCell(rowData + x * cellBytes, (row * shape.nx + x) * shape.featureSize, shape,
+                                   partial);
+                }
+            }
+            stats.rowOccupancy[row] = static_cast<uint32_t>(partial.occupiedCells - occupiedBefore);
+        }
+    });
+    FinishStats(partials, shape, stats);
+}
+
+void ComputeCoordStats(const uint32_t *coords, const uint8_t *features, uint32_t numPillars,
+                       const StatsShape &shape, const std::vector<uint16_t> &dequantScale, OutputStats &stats)
+{
+    stats = OutputStats{};
+    stats.fromCoords = true;
+    uint32_t rowNum = shape.batchSize * shape.ny;
+    stats.rowOccupancy.assign(rowNum, 0);
+
+    // (cell, pillar下标) 排序后，每个cell取下标最大的pillar
+    std::vector<std::pair<uint64_t, uint32_t>> keys;
+    keys.reserve(numPillars);
+    for (uint32_t i = 0; i < numPillars; i++) {
+        uint32_t b = coords[i * PILLAR_SCATTER_COORD_DIM + 0];
+        uint32_t y = coords[i * PILLAR_SCATTER_COORD_DIM + 1];
+        uint32_t x = coords[i * PILLAR_SCATTER_COORD_DIM + 2];
+        if (b >= shape.batchSize || y >= shape.ny || x >= shape.nx) {
+            stats.skippedPillars++;
+            continue;
+        }
+        keys.push_back({(static_cast<uint64_t>(b) * shape.ny + y) * shape.nx + x, i});
+    }
+    std::sort(keys.begin(), keys.end());
+
+    bool dequant = shape.inputDtype == SCATTER_DTYPE_INT8;
+    size_t inputRowBytes = shape.featureSize * (dequant ? 1 : StatsElemSize(shape));
+    std::vector<uint8_t> row(shape.featureSize * StatsElemSize(shape));
+    std::vector<PartialStats> partials(1);
+    for (size_t k = 0; k < keys.size(); k++) {
+        if (k + 1 < keys.size() && keys[k + 1].first == keys[k].first) {
+            stats.duplicatePillars++;
+            continue;
+        }
+        uint64_t cell = keys[k].first;
+        const uint8_t *input = features + keys[k].second * inputRowBytes;
+        if (dequant) {
+            // 与kernel一致：half(int8) * scale，结果为half
+            for (uint32_t c = 0; c < shape.featureSize; c++) {
+                float scale = dequantScale.empty() ? 1.0f : HalfBitsToFloat(dequantScale[c]);
+                uint16_t half = FloatToHalfBits(static_cast<float>(static_cast<int8_t>(input[c])) * scale);
+                memcpy(&row[c * sizeof(uint16_t)], &half, sizeof(half));
+            }
+            input = row.data();
+        }
+        // 全零特征写出的cell与未写入的cell无法区分，与稠密模式一致不计入占用
+        if (AllZero(input, shape.featureSize * StatsElemSize(shape))) {
+            continue;
+        }
+        AccumulateCell(input, cell * shape.featureSize, shape, partials[0]);
+        stats.rowOccupancy[cell / shape.nx]++;
+    }
+    FinishStats(partials, shape, stats);
+}
+
+void PrintOutputStats(const OutputStats &stats, const StatsShape &shape)
+{
+    uint64_t cellNum = static_cast<uint64_t>(shape.batchSize) * shape.ny * shape.nx;
+    printf("\n输出数据统计 (NHWC格式%s):\n", stats.fromCoords ? "，由坐标推出" : "");
+    printf("  总元素数: %llu\n", static_cast<unsigned long long>(stats.totalElements));
+    printf("  非零元素数: %llu (%.2f%%)\n", static_cast<unsigned long long>(stats.nonZeroElements),
+           (double)stats.nonZeroElements / stats.totalElements * 100);
+    if (stats.firstNonZero == UINT64_MAX) {
+        printf("  警告：输出全是0！\n");
+        return;
+    }
+    int32_t bitsWidth = static_cast<int32_t>(StatsElemSize(shape) * 2);
+    printf("  第一个非零值: 0x%0*X (位置: %llu)\n", bitsWidth, stats.firstNonZeroBits,
+           static_cast<unsigned long long>(stats.firstNonZero));
+    // 将位置转换为NHWC坐标
+    uint64_t index = stats.firstNonZero;
+    printf("  对应坐标: N=%llu, H=%llu, W=%llu, C=%llu\n",
+           static_cast<unsigned long long>(index / ((uint64_t)shape.ny * shape.nx * shape.featureSize)),
+           static_cast<unsigned long long>(index / ((uint64_t)shape.nx * shape.featureSize) % shape.ny),
+           static_cast<unsigned long long>(index % ((uint64_t)shape.nx * shape.featureSize) / shape.featureSize),
+           static_cast<unsigned long long>(index % shape.featureSize));
+    printf("  被写入cell数: %llu (%.2f%%)\n", static_cast<unsigned long long>(stats.occupiedCells),
+           (double)stats.occupiedCells / cellNum * 100);
+    printf("  特征值: min=%g, max=%g, mean=%g, NaN=%llu, Inf=%llu\n", stats.minValue, stats.maxValue,
+           stats.meanValue, static_cast<unsigned long long>(stats.nanCount),
+           static_cast<unsigned long long>(stats.infCount));
+    if (stats.fromCoords) {
+        printf("  越界/填充pillar: %llu, 被覆盖的重复pillar: %llu\n",
+               static_cast<unsigned long long>(stats.skippedPillars),
+               static_cast<unsigned long long>(stats.duplicatePillars));
+    }
+    printf("  行占用率直方图 (行数):");
+    for (uint32_t bin = 0; bin < OCCUPANCY_HISTOGRAM_BINS; bin++) {
+        printf(" %u%%+:%llu", bin * 100 / OCCUPANCY_HISTOGRAM_BINS,
+               static_cast<unsigned long long>(stats.occupancyHistogram[bin]));
+    }
+    printf("\n");
+}
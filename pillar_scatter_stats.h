@@ -0,0 +1,70 @@
+/**
+ * @file pillar_scatter_stats.h
+ *
+ * PillarScatter输出特征图的统计，供ascendc_kernels_bbit在每帧之后打印。
+ * 稠密模式多线程按BEV行扫描输出：整行先按64字节块做全零检查，只有非零行才逐cell、逐元素统计；
+ * 坐标模式只根据坐标列表和pillar特征推出同样的统计（覆盖语义，同一cell最后一个pillar生效），不读取稠密输出。
+ */
+#ifndef PILLAR_SCATTER_STATS_H
+#define PILLAR_SCATTER_STATS_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr uint32_t OCCUPANCY_HISTOGRAM_BINS = 10;  // 行占用率直方图的分桶数，每桶10%
+
+// 输出统计方式
+enum OutputStatsMode : uint32_t {
+    OUTPUT_STATS_DENSE = 0,   // 扫描稠密输出
+    OUTPUT_STATS_COORDS = 1,  // 只由坐标和特征推出
+    OUTPUT_STATS_OFF = 2,     // 不统计
+};
+
+// 统计所需的输出形状
+struct StatsShape {
+    uint32_t nx;            // BEV特征图宽度 W
+    uint32_t ny;            // BEV特征图高度 H
+    uint32_t featureSize;   // 每个pillar的特征维度 C
+    uint32_t batchSize;     // 输出batch数 B
+    uint32_t inputDtype;    // PillarScatterDtype，输出类型由输入类型决定
+};
+
+struct OutputStats {
+    uint64_t totalElements;     // 输出元素总数 B*ny*nx*C
+    uint64_t nonZeroElements;   // 非零元素数
+    uint64_t occupiedCells;     // 被写入的cell数：稠密模式为至少一个通道非零，坐标模式为坐标中出现过
+    uint64_t firstNonZero;      // 第一个非零元素的NHWC下标，没有时为UINT64_MAX
+    uint32_t firstNonZeroBits;  // 第一个非零元素的位模式
+    uint64_t nanCount;          // 被写入cell中的NaN元素数
+    uint64_t infCount;          // 被写入cell中的Inf元素数
+    float minValue;             // 被写入cell中有限元素的最小值
+    float maxValue;             // 被写入cell中有限元素的最大值
+    double meanValue;           // 被写入cell中有限元素的均值
+    bool fromCoords;            // 由坐标模式得到
+    uint64_t skippedPillars;    // 坐标模式：越界或填充的pillar数
+    uint64_t duplicatePillars;  // 坐标模式：被同一cell后续pillar覆盖的pillar数
+    std::vector<uint32_t> rowOccupancy;  // 每个BEV行（b*ny+y）被写入的cell数
+    uint64_t occupancyHistogram[OCCUPANCY_HISTOGRAM_BINS];  // 按行占用率分桶的行数，最后一桶含100%
+};
+
+/**
+ * @brief 稠密模式：多线程扫描NHWC输出
+ * @param threadNum 线程数，0表示使用全部硬件线程
+ */
+void ComputeOutputStats(const uint8_t *output, const StatsShape &shape, uint32_t threadNum, OutputStats &stats);
+
+/**
+ * @brief 坐标模式：只根据坐标和特征统计，第b帧的坐标写入第b个batch由调用方保证（coords[:, 0]）
+ *
+ * 特征为 [numPillars, C] 输入类型，int8按dequantScale（空表示全为1）反量化后统计。
+ * 获胜pillar的特征（反量化后）全为0时不计入被写入cell和行占用，与稠密模式结果一致。
+ */
+void ComputeCoordStats(const uint32_t *coords, const uint8_t *features, uint32_t numPillars,
+                       const StatsShape &shape, const std::vector<uint16_t> &dequantScale, OutputStats &stats);
+
+/**
+ * @brief 打印统计结果
+ */
+void PrintOutputStats(const OutputStats &stats, const StatsShape &shape);
+
+#endif // PILLAR_SCATTER_STATS_H
@@ -0,0 +1,145 @@
+/**
+ * @file pillar_scatter_tiling.h
+ *
+ * PillarScatter算子的tiling数据定义，host与kernel共用。
+ * host侧根据网格大小、通道数和实际launch的blockDim计算tiling，
+ * 经GM传给kernel，kernel在Init中按字拷贝到标量寄存器使用。
+ */
+#ifndef PILLAR_SCATTER_TILING_H
+#define PILLAR_SCATTER_TILING_H
+#include <cstdint>
+
+constexpr uint32_t PILLAR_SCATTER_COORD_DIM = 4;            // 每个pillar的坐标字段数 [batch, y, x, reserved]
+constexpr uint32_t PILLAR_SCATTER_TILE_BYTES = 32 * 1024;    // 单个特征缓冲区的UB预算（字节）
+constexpr uint32_t PILLAR_SCATTER_CHANNEL_ALIGN = 16;       // half通道数需为16的倍数（32字节对齐）
+constexpr uint32_t PILLAR_SCATTER_BIN_ENTRY_DIM = 2;        // 行分桶条目 [pillar下标, x]
+constexpr uint32_t PILLAR_SCATTER_DIAG_DIM = 8;             // 每个核的诊断字个数（一个32字节块）
+constexpr uint32_t PILLAR_SCATTER_PROFILE_DIM = 16;         // 性能剖析模式下每个核的剖析字个数（两个32字节块）
+constexpr uint32_t PILLAR_SCATTER_PROFILE_MAGIC = 0x50524F46; // 剖析字的有效标记（"PROF"）
+// 反向（PillarGather）：host写入坐标保留字段 coords[:, 3] 的梯度份数，0表示该pillar不分得梯度
+constexpr uint32_t PILLAR_GATHER_SHARE_FIELD = 3;
+// MULTIRES模式池化输出的最大步长为 2^PILLAR_SCATTER_MAX_POOL_SHIFT
+constexpr uint32_t PILLAR_SCATTER_MAX_POOL_SHIFT = 3;
+// 通道切分：每核pillar数低于PILLAR_SCATTER_SPLIT_MIN_PILLARS时把通道也切给不同的核，每核通道片不少于该字节数
+constexpr uint32_t PILLAR_SCATTER_SPLIT_MIN_PILLARS = 64;
+constexpr uint32_t PILLAR_SCATTER_SPLIT_MIN_BYTES = 64;
+// 填充条目的坐标，四个字段均为-1（coords[:, 0]可能已被改写为帧序号，按y、x判断），对应体素化输出的固定长度张量
+constexpr uint32_t PILLAR_PADDING_COORD = 0xFFFFFFFF;
+
+// scatter模式
+enum PillarScatterMode : uint32_t {
+    SCATTER_MODE_PILLAR = 0,  // pillar驻留：按pillar分核，逐行写入预先清零的输出
+    SCATTER_MODE_BAND = 1,    // 输出驻留：按BEV行分核，UB内清零+填充后整段写出，输出无需预先清零
+    SCATTER_MODE_INCREMENTAL = 2,  // 持久输出：只清零上一帧写过、本帧不再覆盖的cell，再写入本帧pillar
+    SCATTER_MODE_SORTED = 3,  // pillar已由host按cell排序：按pillar分核，cell连续的pillar合并写出
+    SCATTER_MODE_CSR = 4,     // 稀疏输出：不写稠密特征图，输出按行排序、去重的cell的CSR行偏移、列下标和紧凑特征
+    SCATTER_MODE_MULTIRES = 5,  // 多分辨率：pillar已由host按粗网格块排序并去重，一次遍历写出全分辨率输出和各步长的池化输出
+};
+
+// 重复坐标（同一cell多个pillar）的归约方式，仅BAND/CSR模式支持非覆盖归约
+enum PillarScatterReduce : uint32_t {
+    SCATTER_REDUCE_OVERWRITE = 0,  // 覆盖：BAND模式下按pillar原始顺序最后一个生效，结果确定
+    SCATTER_REDUCE_SUM = 1,        // 求和
+    SCATTER_REDUCE_MAX = 2,        // 逐通道取最大值
+    SCATTER_REDUCE_MEAN = 3,       // 求和后除以该cell的pillar数
+};
+
+// PILLAR/SORTED模式下pillar在各核之间的分配方式
+enum PillarScatterSchedule : uint32_t {
+    SCATTER_SCHEDULE_STATIC = 0,   // 按下标均分（former/tail）
+    SCATTER_SCHEDULE_DYNAMIC = 1,  // 各核从GM计数器领取固定长度的pillar块，先做完的核继续领取
+    SCATTER_SCHEDULE_REGION = 2,   // 仅SORTED模式：按整行输出区域切分，每核写一段连续输出且pillar数均衡
+};
+
+// 特征数据类型；BAND/INCREMENTAL/CSR模式仅支持FP16
+enum PillarScatterDtype : uint32_t {
+    SCATTER_DTYPE_FP16 = 0,  // half输入，half输出
+    SCATTER_DTYPE_BF16 = 1,  // bfloat16输入，bfloat16输出
+    SCATTER_DTYPE_FP32 = 2,  // float输入，float输出
+    SCATTER_DTYPE_INT8 = 3,  // int8输入，UB内按逐通道scale反量化后输出half
+};
+
+// 输出特征图的内存布局；NCHW仅BAND模式支持，要求nx为16的倍数
+enum PillarScatterLayout : uint32_t {
+    SCATTER_LAYOUT_NHWC = 0,            // [B, ny, nx, C]
+    SCATTER_LAYOUT_NCHW = 1,            // [B, C, ny, nx]：BAND模式在UB内转置后按通道平面写出
+    SCATTER_LAYOUT_NCHW_TRANSPOSE = 2,  // [B, C, ny, nx]：先写NHWC中间结果，再由单独的转置kernel转为NCHW（对比基线）
+};
+
+// 每个核的诊断字 [PILLAR_SCATTER_DIAG_DIM] 中各字段的下标
+enum PillarScatterDiag : uint32_t {
+    SCATTER_DIAG_STATUS = 0,        // PillarScatterStatus位或
+    SCATTER_DIAG_VALID = 1,         // 通过校验、写入输出的pillar数
+    SCATTER_DIAG_OUT_OF_RANGE = 2,  // batch/y/x越界被跳过的条目数
+    SCATTER_DIAG_PADDING = 3,       // 填充被跳过的条目数
+};
+
+// 性能剖析（PILLAR_SCATTER_PROFILE编译选项）每个核的剖析字 [PILLAR_SCATTER_PROFILE_DIM] 中各字段的下标
+// 各阶段为GetSystemCycle()计数的差值；字节数只统计主数据（特征、坐标/索引、输出），按uint32截断
+enum PillarScatterProfile : uint32_t {
+    SCATTER_PROFILE_MAGIC = 0,         // PILLAR_SCATTER_PROFILE_MAGIC，未写入的核为0
+    SCATTER_PROFILE_INIT = 1,          // 初始化：解析tiling、分核、申请UB
+    SCATTER_PROFILE_COPY_IN = 2,       // 搬入：坐标/索引/特征读入UB，含等待MTE2完成的时间
+    SCATTER_PROFILE_SCATTER = 3,       // 写出：计算输出位置、归约/转置并写入输出
+    SCATTER_PROFILE_TAIL = 4,          // 收尾：INCREMENTAL模式清零上一帧的cell、写出诊断字
+    SCATTER_PROFILE_TILES = 5,         // 处理的块数（BAND模式为段数）
+    SCATTER_PROFILE_ENTRIES = 6,       // 扫描的输入条目数（pillar或cell）
+    SCATTER_PROFILE_WRITTEN = 7,       // 写出的pillar/cell数
+    SCATTER_PROFILE_SKIPPED = 8,       // 坐标非法被跳过的条目数
+    SCATTER_PROFILE_BYTES_IN = 9,      // 从GM读入的字节数
+    SCATTER_PROFILE_BYTES_OUT = 10,    // 写入输出的字节数
+};
+
+// PILLAR/SORTED模式kernel直接读取的坐标格式；其余模式、PFN融合入口和反向由host解码为 [N, 4] 后使用
+enum PillarScatterCoordFormat : uint32_t {
+    SCATTER_COORD_BYXR = 0,    // [N, 4] uint32 (batch, y, x, reserved)
+    SCATTER_COORD_LINEAR = 1,  // [N] uint32 线性cell下标 b*ny*nx + y*nx + x，填充条目为PILLAR_PADDING_COORD
+    SCATTER_COORD_YX16 = 2,    // [N] 打包的uint16 (y, x)（低16位为y），batch恒为0，填充条目两半均为0xFFFF
+};
+
+// 诊断状态位
+enum PillarScatterStatus : uint32_t {
+    SCATTER_STATUS_OUT_OF_RANGE = 1,  // 出现过越界坐标
+    SCATTER_STATUS_PADDING = 2,       // 出现过填充条目
+};
+
+struct PillarScatterTilingData {
+    uint32_t nx;            // BEV特征图宽度 W
+    uint32_t ny;            // BEV特征图高度 H
+    uint32_t featureSize;   // 每个pillar的特征维度 C
+    uint32_t batchSize;     // 输出batch数 B，输出为[B, ny, nx, C]
+    uint32_t coreNum;       // host侧launch时使用的blockDim
+    uint32_t totalPillars;  // 计算tiling时的pillar总数
+    uint32_t formerNum;     // 前formerNum个核（通道切分时为pillar组）各处理formerLength个pillar
+    uint32_t formerLength;  // 大块长度
+    uint32_t tailLength;    // 其余核各处理tailLength个pillar
+    uint32_t tileLength;    // 通用C路径下每次搬入UB的pillar数（BAND模式下为每段cell数）
+    uint32_t scatterMode;   // PillarScatterMode
+    uint32_t rowStartOffset;  // workspace中行起始表的偏移（uint32个数），长度 B*ny+1
+    uint32_t binOffset;       // workspace中行分桶条目的偏移（uint32个数），长度 N*2
+    uint32_t cellListOffset;  // INCREMENTAL模式：workspace中两组cell列表的起始偏移（uint32个数），之前为各核pillar起始表
+    uint32_t cellListStride;  // INCREMENTAL模式：每个核的cell列表区间长度（uint32个数，含8个字的计数头）
+    uint32_t reduceMode;      // PillarScatterReduce
+    uint32_t scheduleMode;    // PillarScatterSchedule
+    uint32_t chunkLength;     // DYNAMIC调度：每次领取的pillar数
+    uint32_t counterOffset;   // DYNAMIC调度：workspace中块计数器的偏移（uint32个数），launch前由host清零
+    uint32_t regionOffset;    // REGION调度、MULTIRES和INCREMENTAL模式：workspace中各核pillar起始表的偏移（uint32个数），长度 coreNum+1
+    uint32_t inputDtype;      // PillarScatterDtype，输出类型由输入类型决定
+    uint32_t scaleOffset;     // int8输入：workspace中逐通道scale [C] half的偏移（uint32个数）
+    uint32_t maxPoints;       // PFN融合入口：每个pillar的最大点数 N，逐点特征为 [P, N, C]
+    uint32_t cellCount;       // CSR模式：去重后的cell数 M
+    uint32_t runStartOffset;  // CSR模式：workspace中各cell在排序后pillar中的起始表的偏移（uint32个数），长度 M+1
+    uint32_t csrColumnOffset;   // CSR模式：输出中列下标 [M] 的偏移（uint32个数），之前为行偏移表 [B*ny+1]
+    uint32_t csrFeatureOffset;  // CSR模式：输出中紧凑特征 [M, C] 的偏移（uint32个数）
+    uint32_t outputLayout;    // PillarScatterLayout
+    uint32_t diagOffset;      // PILLAR模式和PFN融合入口：workspace中各核诊断字 [coreNum, 8] 的偏移（uint32个数）
+    uint32_t profileOffset;   // 性能剖析：workspace末尾各核剖析字 [coreNum, 16] 的偏移（uint32个数）
+    uint32_t poolMode;        // MULTIRES模式：池化方式，SCATTER_REDUCE_MAX或SCATTER_REDUCE_MEAN（与对稠密输出做池化一致）
+    uint32_t poolStrideMask;  // MULTIRES模式：第k位表示输出步长2^k的池化结果（1<=k<=3），按步长升序接在全分辨率输出之后
+    uint32_t channelSplit;    // PILLAR/SORTED模式STATIC调度：通道切分份数 G，coreNum/G个pillar组各由G个核分通道处理，1表示不切分
+    uint32_t channelSlice;    // 通道切分时每核的通道数 C/G（32字节对齐），第k核处理第 k%G 片
+    uint32_t coordFormat;     // PillarScatterCoordFormat，kernel读取的坐标格式；仅PILLAR/SORTED模式可为紧凑格式，INCREMENTAL模式总为LINEAR
+    uint32_t ownerRows;       // INCREMENTAL模式：每个核归属的连续输出行数（行为 b*ny+y），第k核负责 [k*ownerRows, (k+1)*ownerRows)
+};
+
+#endif // PILLAR_SCATTER_TILING_H
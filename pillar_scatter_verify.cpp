@@ -0,0 +1,330 @@
+/**
+ * @file pillar_scatter_verify.cpp
+ *
+ * PillarScatter算子输出的校验工具，替代原先基于numpy的check.py。
+ * 读入与ascendc_kernels_bbit相同的输入帧，用多线程参考实现稀疏校验算子输出：
+ * 只逐个比较坐标中出现过的cell，其余部分按64字节块检查全零；也可写出NHWC或NCHW的稠密真值。
+ * 给出输出梯度时改为校验反向（PillarGather）写出的pillar梯度。
+ */
+#include "pillar_scatter_host_utils.h"
+#include "pillar_scatter_io.h"
+#include "pillar_scatter_reference.h"
+#include "pillar_scatter_tiling.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 读取一行中的首元素，仅用于错误描述
+float LoadElement(const uint8_t *row, const ReferenceConfig &config)
+{
+    if (config.inputDtype == SCATTER_DTYPE_FP32) {
+        float value;
+        memcpy(&value, row, sizeof(value));
+        return value;
+    }
+    uint16_t bits;
+    memcpy(&bits, row, sizeof(bits));
+    return config.inputDtype == SCATTER_DTYPE_BF16 ? Bf16BitsToFloat(bits) : HalfBitsToFloat(bits);
+}
+
+/**
+ * @brief 反向校验：由输出梯度生成参考pillar梯度，逐pillar按位比较
+ */
+bool VerifyGradient(const PillarScatterReference &reference, const ReferenceConfig &config, const std::string &gradFile,
+                    const std::string &gradOutputFile)
+{
+    std::vector<uint8_t> outputGrad;
+    std::vector<uint8_t> actual;
+    if (!ReadWholeFile(gradFile, outputGrad) || !ReadWholeFile(gradOutputFile, actual)) {
+        return false;
+    }
+    if (outputGrad.size() != reference.OutputSize() || actual.size() != reference.GradientSize()) {
+        printf("错误：输出梯度 %zu 字节（期望 %zu），pillar梯度 %zu 字节（期望 %zu）\n", outputGrad.size(),
+               reference.OutputSize(), actual.size(), reference.GradientSize());
+        return false;
+    }
+    std::vector<uint8_t> expected(reference.GradientSize());
+    reference.GenerateGradient(outputGrad.data(), expected.data());
+    size_t elemSize = reference.OutputElemSize();
+    size_t rowBytes = config.featureSize * elemSize;
+    uint64_t mismatchPillars = 0;
+    for (size_t p = 0; p * rowBytes < expected.size(); p++) {
+        if (memcmp(expected.data() + p * rowBytes, actual.data() + p * rowBytes, rowBytes) == 0) {
+            continue;
+        }
+        if (mismatchPillars++ < 20) {
+            printf("  pillar %zu: 首通道期望 %f，实际 %f\n", p, LoadElement(expected.data() + p * rowBytes, config),
+                   LoadElement(actual.data() + p * rowBytes, config));
+        }
+    }
+    printf("反向校验pillar数: %zu, 不一致: %llu\n", rowBytes == 0 ? 0 : expected.size() / rowBytes,
+           static_cast<unsigned long long>(mismatchPillars));
+    printf("%s\n", mismatchPillars == 0 ? "gradient pass" : "[ERROR] gradient error");
+    return mismatchPillars == 0;
+}
+
+void PrintUsage(const char *program)
+{
+    printf("用法：%s [--nx W] [--ny H] [--c C] [--dtype fp16|bf16|fp32|int8] [--reduce overwrite|sum|max|mean]\n"
+           "          [--layout nhwc|nchw] [--threads N] [--scale 文件] [--strict]\n"
+           "          [--frame 特征 坐标]... [--output 算子输出] [--golden 真值输出]\n"
+           "          [--grad 输出梯度 --grad-output 算子pillar梯度] [--pool max|mean] [--pooled 步长 池化输出]...\n"
+           "第b个--frame对应输出的第b个batch；未指定--frame时使用input/下的默认输入。\n"
+           "给出--output时做稀疏校验（默认 ./output/OpTest_scatter_output_x.bin，可为稠密、稀疏文件或紧凑容器），\n"
+           "给出--golden时写出稠密真值；\n"
+           "--strict要求覆盖模式下重复cell等于最后一个pillar（band/csr模式、region调度的sorted模式或单核），\n"
+           "默认接受任一pillar（多核pillar模式）。\n"
+           "给出--grad时逐pillar比较反向写出的梯度（各帧pillar依次拼接，覆盖模式下梯度只给重复cell的最后一个pillar）。\n"
+           "给出--pooled时把multires模式的池化输出与稠密真值的 s x s 池化比较（默认max，mean允许累加误差）。\n",
+           program);
+}
+
+/**
+ * @brief 多分辨率校验：由稠密真值池化得到各步长的参考输出，逐元素比较（max精确相等，mean在容差内）
+ */
+bool VerifyPooled(const PillarScatterReference &reference, const ReferenceConfig &config, uint32_t poolMode,
+                  const std::vector<std::pair<uint32_t, std::string>> &pooledFiles)
+{
+    std::vector<uint8_t> golden(reference.OutputSize());
+    reference.Generate(golden.data());
+    size_t elemSize = reference.OutputElemSize();
+    bool allPass = true;
+    for (const auto &pooledFile : pooledFiles) {
+        uint32_t shift = 0;
+        while ((2u << shift) <= pooledFile.first) {
+            shift++;
+        }
+        std::vector<uint8_t> actual;
+        if (!ReadWholeFile(pooledFile.second, actual)) {
+            return false;
+        }
+        if (actual.size() != reference.PooledSize(shift)) {
+            printf("错误：步长%u的池化输出 %zu 字节，期望 %zu 字节\n", pooledFile.first, actual.size(),
+                   reference.PooledSize(shift));
+            return false;
+        }
+        std::vector<uint8_t> expected(actual.size());
+        std::vector<float> tolerance;
+        reference.GeneratePooled(golden.data(), shift, poolMode, expected.data(), tolerance);
+        uint64_t mismatch = 0;
+        for (size_t e = 0; e < tolerance.size(); e++) {
+            float want = LoadElement(expected.data() + e * elemSize, config);
+            float got = LoadElement(actual.data() + e * elemSize, config);
+            if (std::fabs(want - got) <= tolerance[e]) {
+                continue;
+            }
+            if (mismatch++ < 20) {
+                printf("  步长%u 元素 %zu (cell %zu, 通道 %zu): 期望 %f，实际 %f\n", pooledFile.first, e,
+                       e / config.featureSize, e % config.featureSize, want, got);
+            }
+        }
+        printf("步长%u池化校验元素数: %zu, 不一致: %llu\n", pooledFile.first, tolerance.size(),
+               static_cast<unsigned long long>(mismatch));
+        allPass = allPass && mismatch == 0;
+    }
+    printf("%s\n", allPass ? "pooled pass" : "[ERROR] pooled error");
+    return allPass;
+}
+
+int32_t main(int32_t argc, char *argv[])
+{
+    ReferenceConfig config = {1024, 1024, 64, SCATTER_DTYPE_FP16, SCATTER_REDUCE_OVERWRITE, REFERENCE_LAYOUT_NHWC,
+                              0, {}};
+    std::vector<std::pair<std::string, std::string>> frameFiles;
+    std::string outputFile;
+    std::string goldenFile;
+    std::string scaleFile;
+    std::string gradFile;
+    std::string gradOutputFile;
+    uint32_t poolMode = SCATTER_REDUCE_MAX;
+    std::vector<std::pair<uint32_t, std::string>> pooledFiles;
+    bool strictDuplicates = false;
+    for (int32_t i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--strict") == 0) {
+            strictDuplicates = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--frame") == 0 && i + 2 < argc) {
+            frameFiles.push_back({argv[i + 1], argv[i + 2]});
+            i += 2;
+            continue;
+        }
+        if (strcmp(argv[i], "--pooled") == 0 && i + 2 < argc) {
+            uint32_t stride = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+            if (stride < 2 || stride > (1u << PILLAR_SCATTER_MAX_POOL_SHIFT) || (stride & (stride - 1)) != 0) {
+                printf("错误：池化步长 %s 非法（2到%u的2的幂）\n", argv[i + 1], 1u << PILLAR_SCATTER_MAX_POOL_SHIFT);
+                return -1;
+            }
+            pooledFiles.push_back({stride, argv[i + 2]});
+            i += 2;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printf("错误：参数 %s 缺少取值\n", argv[i]);
+            PrintUsage(argv[0]);
+            return -1;
+        }
+        const char *value = argv[++i];
+        bool ok = true;
+        if (strcmp(argv[i - 1], "--nx") == 0) {
+            config.nx = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = config.nx > 0;
+        } else if (strcmp(argv[i - 1], "--ny") == 0) {
+            config.ny = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = config.ny > 0;
+        } else if (strcmp(argv[i - 1], "--c") == 0) {
+            config.featureSize = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            ok = config.featureSize > 0;
+        } else if (strcmp(argv[i - 1], "--threads") == 0) {
+            config.threadNum = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (strcmp(argv[i - 1], "--dtype") == 0) {
+            const char *names[] = {"fp16", "bf16", "fp32", "int8"};
+            ok = false;
+            for (uint32_t d = 0; d < 4; d++) {
+                if (strcmp(value, names[d]) == 0) {
+                    config.inputDtype = d;
+                    ok = true;
+                }
+            }
+        } else if (strcmp(argv[i - 1], "--reduce") == 0) {
+            const char *names[] = {"overwrite", "sum", "max", "mean"};
+            ok = false;
+            for (uint32_t r = 0; r < 4; r++) {
+                if (strcmp(value, names[r]) == 0) {
+                    config.reduceMode = r;
+                    ok = true;
+                }
+            }
+        } else if (strcmp(argv[i - 1], "--layout") == 0) {
+            ok = strcmp(value, "nhwc") == 0 || strcmp(value, "nchw") == 0;
+            config.layout = strcmp(value, "nchw") == 0 ? REFERENCE_LAYOUT_NCHW : REFERENCE_LAYOUT_NHWC;
+        } else if (strcmp(argv[i - 1], "--scale") == 0) {
+            scaleFile = value;
+        } else if (strcmp(argv[i - 1], "--output") == 0) {
+            outputFile = value;
+        } else if (strcmp(argv[i - 1], "--golden") == 0) {
+            goldenFile = value;
+        } else if (strcmp(argv[i - 1], "--grad") == 0) {
+            gradFile = value;
+        } else if (strcmp(argv[i - 1], "--grad-output") == 0) {
+            gradOutputFile = value;
+        } else if (strcmp(argv[i - 1], "--pool") == 0) {
+            ok = strcmp(value, "max") == 0 || strcmp(value, "mean") == 0;
+            poolMode = strcmp(value, "mean") == 0 ? SCATTER_REDUCE_MEAN : SCATTER_REDUCE_MAX;
+        } else {
+            printf("错误：未知参数 %s\n", argv[i - 1]);
+            PrintUsage(argv[0]);
+            return -1;
+        }
+        if (!ok) {
+            printf("错误：参数 %s 的取值 %s 非法\n", argv[i - 1], value);
+            return -1;
+        }
+    }
+    if (frameFiles.empty()) {
+        frameFiles.push_back({"./input/OpTest_scatter_input_x.bin", "./input/OpTest_scatter_input_coords.bin"});
+    }
+    if (gradFile.empty() != gradOutputFile.empty()) {
+        printf("错误：--grad 和 --grad-output 需同时给出\n");
+        return -1;
+    }
+    if (!gradFile.empty() && (config.reduceMode == SCATTER_REDUCE_MAX || config.inputDtype == SCATTER_DTYPE_INT8 ||
+                              (config.reduceMode == SCATTER_REDUCE_MEAN && config.inputDtype == SCATTER_DTYPE_BF16))) {
+        printf("错误：反向校验不支持max归约、int8输入和bf16的mean归约\n");
+        return -1;
+    }
+    if (!pooledFiles.empty() && (config.layout != REFERENCE_LAYOUT_NHWC || config.inputDtype == SCATTER_DTYPE_INT8 ||
+                                 config.reduceMode != SCATTER_REDUCE_OVERWRITE)) {
+        printf("错误：池化校验只支持覆盖写的NHWC输出，不支持int8输入\n");
+        return -1;
+    }
+    if (outputFile.empty() && goldenFile.empty() && gradFile.empty() && pooledFiles.empty()) {
+        outputFile = "./output/OpTest_scatter_output_x.bin";
+    }
+
+    // ==================== 1. 读入输入帧 ====================
+    auto start = std::chrono::steady_clock::now();
+    size_t inputElemSize = config.inputDtype == SCATTER_DTYPE_FP32 ? 4 :
+                           (config.inputDtype == SCATTER_DTYPE_INT8 ? 1 : 2);
+    std::vector<std::vector<uint8_t>> featureData(frameFiles.size());
+    std::vector<std::vector<uint8_t>> coordData(frameFiles.size());
+    std::vector<ReferenceFrame> frames;
+    for (size_t f = 0; f < frameFiles.size(); f++) {
+        if (!ReadWholeFile(frameFiles[f].first, featureData[f]) || !ReadWholeFile(frameFiles[f].second, coordData[f])) {
+            return -1;
+        }
+        // pillar数取坐标和特征中较小的一方
+        size_t numPillars = std::min(coordData[f].size() / (PILLAR_SCATTER_COORD_DIM * sizeof(uint32_t)),
+                                     featureData[f].size() / (config.featureSize * inputElemSize));
+        frames.push_back({featureData[f].data(), reinterpret_cast<const uint32_t *>(coordData[f].data()),
+                          static_cast<uint32_t>(numPillars)});
+    }
+    if (!scaleFile.empty()) {
+        std::vector<uint8_t> scale;
+        if (!ReadWholeFile(scaleFile, scale) || scale.size() < config.featureSize * sizeof(uint16_t)) {
+            printf("错误：scale文件需包含 %u 个half\n", config.featureSize);
+            return -1;
+        }
+        config.dequantScale.resize(config.featureSize);
+        memcpy(config.dequantScale.data(), scale.data(), config.featureSize * sizeof(uint16_t));
+    }
+    PillarScatterReference reference(config, frames);
+
+    // ==================== 2. 写出稠密真值 ====================
+    if (!goldenFile.empty()) {
+        std::vector<uint8_t> golden(reference.OutputSize());
+        reference.Generate(golden.data());
+        if (!WriteOutputBytes(goldenFile, golden.data(), golden.size(), false)) {
+            return -1;
+        }
+        printf("已写出%s真值: %s (%zu 字节)\n", config.layout == REFERENCE_LAYOUT_NCHW ? "NCHW" : "NHWC",
+               goldenFile.c_str(), golden.size());
+    }
+    if (!gradFile.empty() && !VerifyGradient(reference, config, gradFile, gradOutputFile)) {
+        return 1;
+    }
+    if (!pooledFiles.empty() && !VerifyPooled(reference, config, poolMode, pooledFiles)) {
+        return 1;
+    }
+    if (outputFile.empty()) {
+        return 0;
+    }
+
+    // ==================== 3. 稀疏校验 ====================
+    // 稀疏文件按普通文件读入，紧凑容器展开为稠密输出
+    std::vector<uint8_t> output;
+    bool compact = false;
+    if (!ReadOutputFile(outputFile, output, &compact)) {
+        return -1;
+    }
+    if (compact) {
+        printf("输出为紧凑容器，已展开为 %zu 字节\n", output.size());
+    }
+    if (output.size() != reference.OutputSize()) {
+        printf("错误：输出文件 %zu 字节，期望 %zu 字节（%zu帧）\n", output.size(), reference.OutputSize(),
+               frames.size());
+        return -1;
+    }
+    VerifyReport report;
+    bool pass = reference.Verify(output.data(), strictDuplicates, report);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const std::string &message : report.messages) {
+        printf("  %s\n", message.c_str());
+    }
+    printf("校验cell数: %llu, 不一致: %llu, 多余非零: %llu, 重复cell取非最后pillar: %llu, 跳过越界/填充pillar: %llu\n",
+           static_cast<unsigned long long>(report.checkedCells), static_cast<unsigned long long>(report.mismatchCells),
+           static_cast<unsigned long long>(report.nonZeroCells),
+           static_cast<unsigned long long>(report.ambiguousCells),
+           static_cast<unsigned long long>(report.skippedPillars));
+    if (config.reduceMode != SCATTER_REDUCE_OVERWRITE) {
+        printf("最大绝对误差: %g\n", report.maxAbsError);
+    }
+    printf("耗时: %.1f ms\n", elapsedMs);
+    printf("%s\n", pass ? "test pass" : "[ERROR] result error");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file pillar_scatter_workload.cpp
+ *
+ * 合成LiDAR pillar负载生成的实现。
+ * 随机数只使用std::mt19937的原始输出，均匀/正态变换在本文件内实现，不依赖标准库分布的具体实现。
+ */
+#include "pillar_scatter_workload.h"
+#include "pillar_scatter_host_utils.h"
+#include "pillar_scatter_tiling.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+constexpr uint32_t RING_BEAMS = 64;          // 扫描线数
+constexpr double RING_MIN_ELEVATION = 2.0;   // 最远扫描环对应的俯角（度）
+constexpr double RING_MAX_ELEVATION = 25.0;  // 最近扫描环对应的俯角（度）
+constexpr uint32_t SAMPLE_RETRIES = 64;      // 按分布采样新cell的最大尝试次数，之后退化为均匀采样
+
+// 可复现的随机数源
+class WorkloadRng {
+public:
+    explicit WorkloadRng(uint32_t seed) : engine(seed) {}
+
+    // [0, 1) 均匀分布，24位精度
+    double Uniform() { return (engine() >> 8) * (1.0 / 16777216.0); }
+
+    // [0, n) 均匀整数
+    uint32_t Below(uint32_t n) { return static_cast<uint32_t>((static_cast<uint64_t>(engine()) * n) >> 32); }
+
+    // 标准正态分布（Box-Muller）
+    double Normal()
+    {
+        double u = 1.0 - Uniform();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * PI * Uniform());
+    }
+
+private:
+    std::mt19937 engine;
+};
+
+// 城市场景中的一个物体
+struct SceneCluster {
+    bool building;   // true为矩形建筑轮廓（只在墙上有点），false为高斯团簇（车辆、植被）
+    double cx;
+    double cy;
+    double width;    // 建筑：x方向边长；团簇：标准差
+    double height;   // 建筑：y方向边长
+};
+
+// 一帧场景的固定参数，在采样pillar之前一次生成
+struct Scene {
+    double cx;                      // 传感器位置（网格中心）
+    double cy;
+    double maxRadius;               // 最远扫描环半径
+    std::vector<double> ringRadius; // 各扫描线落地环的半径
+    std::vector<SceneCluster> clusters;
+};
+
+Scene BuildScene(const WorkloadConfig &config, WorkloadRng &rng)
+{
+    Scene scene;
+    scene.cx = config.nx * 0.5;
+    scene.cy = config.ny * 0.5;
+    scene.maxRadius = 0.6 * (config.nx > config.ny ? config.nx : config.ny);
+    // 俯角线性分布时落地半径 r = h / tan(theta)，近处环密、远处环疏
+    double farTan = std::tan(RING_MIN_ELEVATION * PI / 180.0);
+    for (uint32_t k = 0; k < RING_BEAMS; k++) {
+        double elevation = RING_MIN_ELEVATION + (RING_MAX_ELEVATION - RING_MIN_ELEVATION) * k / (RING_BEAMS - 1);
+        scene.ringRadius.push_back(scene.maxRadius * farTan / std::tan(elevation * PI / 180.0));
+    }
+    if (config.distribution == PILLAR_DIST_URBAN) {
+        uint32_t clusterNum = 24 + rng.Below(40);
+        for (uint32_t i = 0; i < clusterNum; i++) {
+            SceneCluster cluster;
+            cluster.building = rng.Uniform() < 0.5;
+            cluster.cx = rng.Uniform() * config.nx;
+            cluster.cy = rng.Uniform() * config.ny;
+            if (cluster.building) {
+                cluster.width = 6.0 + rng.Uniform() * 34.0;
+                cluster.height = 6.0 + rng.Uniform() * 34.0;
+            } else {
+                cluster.width = 1.5 + rng.Uniform() * 4.5;
+                cluster.height = cluster.width;
+            }
+            scene.clusters.push_back(cluster);
+        }
+    }
+    return scene;
+}
+
+/**
+ * @brief 旋转式LiDAR：八成落在扫描环上（径向抖动随距离增大），两成为密度随距离衰减的近处物体
+ */
+void SampleRing(const Scene &scene, WorkloadRng &rng, double &x, double &y)
+{
+    double radius;
+    if (rng.Uniform() < 0.8) {
+        radius = scene.ringRadius[rng.Below(RING_BEAMS)];
+        radius += rng.Normal() * (0.3 + 0.01 * radius);
+    } else {
+        double u = rng.Uniform();
+        radius = scene.maxRadius * u * u;
+    }
+    double angle = 2.0 * PI * rng.Uniform();
+    x = scene.cx + radius * std::cos(angle);
+    y = scene.cy + radius * std::sin(angle);
+}
+
+/**
+ * @brief 城市场景：三成为地面扫描环，其余落在建筑墙体或团簇上
+ */
+void SampleUrban(const Scene &scene, WorkloadRng &rng, double &x, double &y)
+{
+    if (rng.Uniform() < 0.3) {
+        SampleRing(scene, rng, x, y);
+        return;
+    }
+    const SceneCluster &cluster = scene.clusters[rng.Below(static_cast<uint32_t>(scene.clusters.size()))];
+    if (!cluster.building) {
+        x = cluster.cx + rng.Normal() * cluster.width;
+        y = cluster.cy + rng.Normal() * cluster.width;
+        return;
+    }
+    // 沿矩形周长均匀取点，再加墙体厚度方向的抖动
+    double t = rng.Uniform() * 2.0 * (cluster.width + cluster.height);
+    double left = cluster.cx - cluster.width * 0.5;
+    double bottom = cluster.cy - cluster.height * 0.5;
+    if (t < cluster.width) {
+        x = left + t;
+        y = bottom;
+    } else if (t < cluster.width + cluster.height) {
+        x = left + cluster.width;
+        y = bottom + (t - cluster.width);
+    } else if (t < 2.0 * cluster.width + cluster.height) {
+        x = left + (t - cluster.width - cluster.height);
+        y = bottom + cluster.height;
+    } else {
+        x = left;
+        y = bottom + (t - 2.0 * cluster.width - cluster.height);
+    }
+    x += rng.Normal() * 0.7;
+    y += rng.Normal() * 0.7;
+}
+
+/**
+ * @brief 按分布采样一个尚未使用的cell；多次命中已用cell或网格外时退化为均匀采样
+ */
+uint64_t SampleNewCell(const WorkloadConfig &config, const Scene &scene, const std::vector<bool> &used,
+                       WorkloadRng &rng)
+{
+    if (config.distribution != PILLAR_DIST_UNIFORM) {
+        for (uint32_t retry = 0; retry < SAMPLE_RETRIES; retry++) {
+            double x;
+            double y;
+            if (config.distribution == PILLAR_DIST_RING) {
+                SampleRing(scene, rng, x, y);
+            } else {
+                SampleUrban(scene, rng, x, y);
+            }
+            if (x < 0 || y < 0 || x >= config.nx || y >= config.ny) {
+                continue;
+            }
+            uint64_t cell = static_cast<uint64_t>(y) * config.nx + static_cast<uint64_t>(x);
+            if (!used[cell]) {
+                return cell;
+            }
+        }
+    }
+    uint64_t cell;
+    do {
+        cell = static_cast<uint64_t>(rng.Below(config.ny)) * config.nx + rng.Below(config.nx);
+    } while (used[cell]);
+    return cell;
+}
+
+/**
+ * @brief 模拟PFN输出的单个特征值：约三成为0，其余服从均值0.8的指数分布并截断到8
+ */
+float SampleFeature(WorkloadRng &rng)
+{
+    if (rng.Uniform() < 0.3) {
+        return 0.0f;
+    }
+    double value = -0.8 * std::log(1.0 - rng.Uniform());
+    return static_cast<float>(value < 8.0 ? value : 8.0);
+}
+
+void WriteFeatureRow(const WorkloadConfig &config, WorkloadRng &rng, uint8_t *row)
+{
+    for (uint32_t c = 0; c < config.featureSize; c++) {
+        float value = SampleFeature(rng);
+        if (config.inputDtype == SCATTER_DTYPE_FP32) {
+            memcpy(row + c * sizeof(float), &value, sizeof(float));
+        } else if (config.inputDtype == SCATTER_DTYPE_INT8) {
+            row[c] = static_cast<uint8_t>(static_cast<int32_t>(value * 15.875f + 0.5f));
+        } else {
+            uint16_t half = config.inputDtype == SCATTER_DTYPE_BF16 ? FloatToBf16Bits(value) : FloatToHalfBits(value);
+            memcpy(row + c * sizeof(uint16_t), &half, sizeof(half));
+        }
+    }
+}
+} // namespace
+
+bool ParseDistribution(const char *name, uint32_t &distribution)
+{
+    for (uint32_t d = PILLAR_DIST_UNIFORM; d <= PILLAR_DIST_URBAN; d++) {
+        if (strcmp(name, DistributionName(d)) == 0) {
+            distribution = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *DistributionName(uint32_t distribution)
+{
+    const char *names[] = {"uniform", "ring", "urban"};
+    return distribution <= PILLAR_DIST_URBAN ? names[distribution] : "unknown";
+}
+
+bool GenerateWorkload(const WorkloadConfig &config, std::vector<uint8_t> &features, std::vector<uint32_t> &coords,
+                      WorkloadStats *stats)
+{
+    if (config.nx == 0 || config.ny == 0 || config.inputDtype > SCATTER_DTYPE_INT8 ||
+        config.distribution > PILLAR_DIST_URBAN) {
+        return false;
+    }
+    WorkloadRng rng(config.seed);
+    Scene scene = BuildScene(config, rng);
+    size_t elemSize = config.inputDtype == SCATTER_DTYPE_FP32 ? 4 : (config.inputDtype == SCATTER_DTYPE_INT8 ? 1 : 2);
+    size_t rowBytes = config.featureSize * elemSize;
+    features.assign(config.numPillars * rowBytes, 0);
+    coords.assign(static_cast<size_t>(config.numPillars) * PILLAR_SCATTER_COORD_DIM, 0);
+
+    uint64_t cellNum = static_cast<uint64_t>(config.nx) * config.ny;
+    std::vector<bool> used(cellNum, false);
+    std::vector<uint64_t> usedCells;
+    WorkloadStats result = {};
+    result.padding = static_cast<uint32_t>(config.numPillars * config.paddingRatio + 0.5);
+    result.padding = result.padding < config.numPillars ? result.padding : config.numPillars;
+    uint32_t entryNum = config.numPillars - result.padding;
+
+    for (uint32_t i = 0; i < entryNum; i++) {
+        uint32_t *coord = &coords[static_cast<size_t>(i) * PILLAR_SCATTER_COORD_DIM];
+        WriteFeatureRow(config, rng, &features[i * rowBytes]);
+        if (rng.Uniform() < config.invalidRatio) {
+            // x或y之一落在 [n, 2n)，另一维在网格内
+            bool xOut = rng.Uniform() < 0.5;
+            coord[1] = xOut ? rng.Below(config.ny) : config.ny + rng.Below(config.ny);
+            coord[2] = xOut ? config.nx + rng.Below(config.nx) : rng.Below(config.nx);
+            result.invalid++;
+            continue;
+        }
+        uint64_t cell;
+        bool reuse = !usedCells.empty() && (usedCells.size() >= cellNum || rng.Uniform() < config.dupRatio);
+        if (reuse) {
+            cell = usedCells[rng.Below(static_cast<uint32_t>(usedCells.size()))];
+            result.duplicates++;
+        } else {
+            cell = SampleNewCell(config, scene, used, rng);
+            used[cell] = true;
+            usedCells.push_back(cell);
+        }
+        coord[1] = static_cast<uint32_t>(cell / config.nx);
+        coord[2] = static_cast<uint32_t>(cell % config.nx);
+    }
+    // 填充条目：坐标全为-1，特征保持为0
+    for (uint32_t i = entryNum; i < config.numPillars; i++) {
+        for (uint32_t d = 0; d < PILLAR_SCATTER_COORD_DIM; d++) {
+            coords[static_cast<size_t>(i) * PILLAR_SCATTER_COORD_DIM + d] = PILLAR_PADDING_COORD;
+        }
+    }
+    result.uniqueCells = static_cast<uint32_t>(usedCells.size());
+    if (stats != nullptr) {
+        *stats = result;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file pillar_scatter_workload.h
+ *
+ * 合成LiDAR pillar负载生成，供数据生成工具pillar_scatter_gen和基准测试pillar_scatter_bench共用。
+ * 生成的特征 [P, C] 和坐标 [P, 4] uint32 (batch, y, x, reserved) 与ascendc_kernels_bbit读入的布局一致，
+ * 相同的配置和种子总是生成相同的场景，便于在不同kernel版本之间复现对比。
+ */
+#ifndef PILLAR_SCATTER_WORKLOAD_H
+#define PILLAR_SCATTER_WORKLOAD_H
+#include <cstdint>
+#include <vector>
+#include "pillar_scatter_tiling.h"
+
+// pillar在BEV网格上的空间分布
+enum PillarDistribution : uint32_t {
+    PILLAR_DIST_UNIFORM = 0,  // 均匀分布
+    PILLAR_DIST_RING = 1,     // 旋转式LiDAR：以网格中心为传感器的同心扫描环，密度随距离下降
+    PILLAR_DIST_URBAN = 2,    // 城市场景：建筑轮廓和车辆/植被团簇叠加地面扫描环
+};
+
+struct WorkloadConfig {
+    uint32_t numPillars;    // 条目总数 P，含越界和填充条目
+    uint32_t nx;            // BEV特征图宽度 W
+    uint32_t ny;            // BEV特征图高度 H
+    uint32_t featureSize;   // 每个pillar的特征维度 C
+    uint32_t inputDtype;    // PillarScatterDtype
+    uint32_t distribution;  // PillarDistribution
+    uint32_t seed;          // 随机种子
+    double dupRatio;        // 有效条目落在已使用cell上的比例
+    double invalidRatio;    // 有效位置中x或y越界的条目比例
+    double paddingRatio;    // 末尾填充条目占P的比例：坐标全为-1，特征全为0
+};
+
+// 生成结果的组成
+struct WorkloadStats {
+    uint32_t uniqueCells;   // 占用的不同cell数
+    uint32_t duplicates;    // 落在已使用cell上的条目数
+    uint32_t invalid;       // 坐标越界的条目数
+    uint32_t padding;       // 末尾填充条目数
+};
+
+/**
+ * @brief 解析分布名称 uniform/ring/urban
+ * @return 名称非法时返回false
+ */
+bool ParseDistribution(const char *name, uint32_t &distribution);
+
+// 分布名称
+const char *DistributionName(uint32_t distribution);
+
+/**
+ * @brief 按配置生成特征和坐标
+ *
+ * 有效条目按分布依次采样新cell，以dupRatio的概率改为重复已使用的cell（新cell用完后也只能重复），
+ * 以invalidRatio的概率生成x或y越界的坐标；填充条目统一放在末尾。
+ * 特征模拟PFN输出（ReLU之后约三成为0），int8为已量化的 [0, 127]。
+ *
+ * @return 配置非法（网格为空或dtype未知）时返回false
+ */
+bool GenerateWorkload(const WorkloadConfig &config, std::vector<uint8_t> &features, std::vector<uint32_t> &coords,
+                      WorkloadStats *stats = nullptr);
+
+#endif // PILLAR_SCATTER_WORKLOAD_H
@@ -0,0 +1,46 @@
+#!/bin/bash
+# 重复坐标归约模式吞吐量对比
+# 用法：bash scripts/bench_reduce.sh [重复次数] [透传给ascendc_kernels_bbit的参数...]
+# 例如：bash scripts/bench_reduce.sh 20 --nx 432 --ny 496 --frame f0_x.bin f0_coords.bin
+# 需先执行run.sh生成ascendc_kernels_bbit，输入中应包含重复坐标（如多帧叠加的点云）
+CURRENT_DIR=$(
+    cd $(dirname ${BASH_SOURCE:-$0})/..
+    pwd
+)
+cd $CURRENT_DIR
+
+REPEAT=${1:-10}
+shift
+export LD_LIBRARY_PATH=$(pwd)/out/lib:$(pwd)/out/lib64:$LD_LIBRARY_PATH
+
+if [ ! -x ./ascendc_kernels_bbit ]; then
+    echo "错误：未找到ascendc_kernels_bbit，请先执行run.sh"
+    exit 1
+fi
+
+# 基线为pillar模式的普通覆盖写，其余归约均在band模式下完成
+CASES="pillar:overwrite band:overwrite band:sum band:max band:mean"
+
+printf "%-10s %-10s %12s %12s %16s\n" "mode" "reduce" "median(ms)" "min(ms)" "Kpillars/s"
+for CASE in $CASES; do
+    MODE=${CASE%%:*}
+    REDUCE=${CASE##*:}
+    TIMES=""
+    PILLARS=0
+    for ((i = 0; i < REPEAT; i++)); do
+        LOG=$(./ascendc_kernels_bbit --mode $MODE --reduce $REDUCE "$@")
+        if [ $? -ne 0 ]; then
+            echo "错误：$MODE/$REDUCE 运行失败"
+            echo "$LOG" | tail -5
+            exit 1
+        fi
+        TIMES="$TIMES $(echo "$LOG" | grep "^执行时间:" | awk '{print $2}')"
+        PILLARS=$(echo "$LOG" | grep "^处理pillar数量:" | awk '{print $2}')
+    done
+    echo $TIMES | tr ' ' '\n' | sort -g | awk -v mode=$MODE -v reduce=$REDUCE -v pillars=$PILLARS '
+        { t[NR] = $1 }
+        END {
+            median = (NR % 2) ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2
+            printf "%-10s %-10s %12.3f %12.3f %16.2f\n", mode, reduce, median, t[1], pillars / median
+        }'
+done